@@ -0,0 +1,234 @@
+#include <fmt/core.h>
+#include <cstdlib>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "benchmark/helper/helper.hpp"
+#include "fx/argparse/argparse.hpp"
+#include "fx/argparse/table/table.hpp"
+#include "fx/descriptor/v1beta/descriptor.pb.h"
+
+// Option lookup: every token names one of `option_count` string list options,
+// so the cost of a parse is dominated by resolving option names.
+
+static fx::argparse::v1beta::ParseTable create_table(std::size_t option_count) {
+  fx::descriptor::v1beta::FxCommandDescriptor descriptor;
+  for (std::size_t index = 0; index < option_count; index++) {
+    auto& option = *descriptor.add_options();
+    option.set_name(fmt::format("option-{0}", index));
+    option.set_short_name(fmt::format("o{0}", index));
+    option.mutable_string_value()->set_list(true);
+  }
+  return fx::argparse::table::compile(descriptor);
+}
+
+static std::vector<std::string> create_arguments(std::size_t option_count,
+                                                 std::size_t token_count) {
+  std::vector<std::string> arguments;
+  for (std::size_t index = 0; index < token_count; index++) {
+    arguments.emplace_back(
+        fmt::format("--option-{0}=value", (index * 7919) % option_count));
+  }
+  return arguments;
+}
+
+static fx::benchmark::helper::measurement_t measure_parse(
+    const std::string& name, const fx::argparse::v1beta::ParseTable& table,
+    const std::vector<std::string>& arguments) {
+  const std::vector<std::string_view> views(arguments.begin(),
+                                            arguments.end());
+  return fx::benchmark::helper::measure(name, 20, [&]() {
+    const auto result = fx::argparse::parse(views, table);
+    if (result.failed()) {
+      std::abort();
+    }
+  });
+}
+
+// Choices: a single option with thousands of string choices, like the service
+// selectors found in large workspaces.
+
+static fx::descriptor::v1beta::FxCommandDescriptor create_choice_descriptor(
+    std::size_t choice_count) {
+  fx::descriptor::v1beta::FxCommandDescriptor descriptor;
+  auto& option = *descriptor.add_options();
+  option.set_name("service");
+  for (std::size_t index = 0; index < choice_count; index++) {
+    option.mutable_string_value()->add_choices(
+        fmt::format("service-{0}", index));
+  }
+  return descriptor;
+}
+
+static void measure_choices(
+    std::vector<fx::benchmark::helper::measurement_t>& measurements,
+    std::size_t choice_count) {
+  const auto descriptor = create_choice_descriptor(choice_count);
+  const auto& choices = descriptor.options(0).string_value().choices();
+  const auto table = fx::argparse::table::compile(descriptor);
+  auto unindexed = table.options(0);
+  unindexed.clear_string_choice_index();
+
+  std::vector<std::string> values;
+  for (std::size_t index = 0; index < 1000; index++) {
+    values.emplace_back(
+        fmt::format("service-{0}", (index * 7919) % (choice_count * 2)));
+  }
+
+  // What building a std::set of choices for every invocation used to cost.
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("choices/{0}/setup/std::set", choice_count), 20, [&]() {
+        const std::set<std::string> set(choices.begin(), choices.end());
+        if (set.size() != choice_count) {
+          std::abort();
+        }
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("choices/{0}/setup/compile", choice_count), 20, [&]() {
+        const auto compiled = fx::argparse::table::compile(descriptor);
+        if (compiled.options_size() != 1) {
+          std::abort();
+        }
+      }));
+
+  // What each invocation pays now: the compiled table comes from the cache.
+  const auto serialized = table.SerializeAsString();
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("choices/{0}/setup/cache load", choice_count), 20, [&]() {
+        fx::argparse::v1beta::ParseTable loaded;
+        if (!loaded.ParseFromString(serialized)) {
+          std::abort();
+        }
+      }));
+
+  const std::set<std::string> set(choices.begin(), choices.end());
+  std::size_t found = 0;
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("choices/{0}/1000 lookups/std::set", choice_count), 20,
+      [&]() {
+        for (const auto& value : values) {
+          found += set.count(value);
+        }
+      }));
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("choices/{0}/1000 lookups/sorted", choice_count), 20,
+      [&]() {
+        for (const auto& value : values) {
+          found += fx::argparse::table::is_string_choice(unindexed, value);
+        }
+      }));
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("choices/{0}/1000 lookups/hash", choice_count), 20, [&]() {
+        for (const auto& value : values) {
+          found += fx::argparse::table::is_string_choice(table.options(0),
+                                                         value);
+        }
+      }));
+  if (found == 0) {
+    std::abort();
+  }
+
+  fmt::print("choices/{0}: sorted spec {1} bytes, hashed spec {2} bytes\n",
+             choice_count, unindexed.SpaceUsedLong(),
+             table.options(0).SpaceUsedLong());
+}
+
+// Numeric lists: tens of thousands of ids passed to one int list option.
+
+static void measure_numbers(
+    std::vector<fx::benchmark::helper::measurement_t>& measurements,
+    std::size_t id_count) {
+  fx::descriptor::v1beta::FxCommandDescriptor descriptor;
+  auto& option = *descriptor.add_options();
+  option.set_name("ids");
+  option.mutable_int_value()->set_list(true);
+  const auto table = fx::argparse::table::compile(descriptor);
+
+  std::vector<std::string> separate;
+  std::string packed = "--ids=";
+  for (std::size_t index = 0; index < id_count; index++) {
+    const auto id = std::to_string(1000000007ULL * index % 9999999967ULL);
+    separate.emplace_back("--ids");
+    separate.emplace_back(id);
+    packed += (index == 0 ? "" : ",") + id;
+  }
+  const std::vector<std::string_view> separate_arguments(separate.begin(),
+                                                         separate.end());
+  const std::vector<std::string_view> packed_arguments{packed};
+
+  // What stream based conversion of each token used to cost on its own.
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("numbers/{0}/convert/istringstream", id_count), 20, [&]() {
+        std::vector<int64_t> ids;
+        for (std::size_t index = 1; index < separate.size(); index += 2) {
+          std::istringstream stream(separate[index]);
+          int64_t id = 0;
+          if (!(stream >> id)) {
+            std::abort();
+          }
+          ids.push_back(id);
+        }
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("numbers/{0}/parse/separate", id_count), 20, [&]() {
+        const auto result = fx::argparse::parse(separate_arguments, table);
+        if (result.failed()) {
+          std::abort();
+        }
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      fmt::format("numbers/{0}/parse/packed", id_count), 20, [&]() {
+        const auto result = fx::argparse::parse(packed_arguments, table);
+        if (result.failed()) {
+          std::abort();
+        }
+      }));
+}
+
+int main() {
+  std::vector<fx::benchmark::helper::measurement_t> measurements;
+
+  // Linear in tokens: 1k options with a growing number of tokens.
+  const auto table = create_table(1000);
+  for (const std::size_t token_count : {250, 500, 1000}) {
+    measurements.emplace_back(measure_parse(
+        fmt::format("parse/1000 options/{0} tokens", token_count), table,
+        create_arguments(1000, token_count)));
+  }
+
+  // Flat in options: 1k tokens over a growing number of options, with and
+  // without the perfect hash. Without it every token scans the options.
+  for (const std::size_t option_count : {10, 100, 1000}) {
+    auto option_table = create_table(option_count);
+    const auto arguments = create_arguments(option_count, 1000);
+    measurements.emplace_back(measure_parse(
+        fmt::format("parse/{0} options/1000 tokens/hash", option_count),
+        option_table, arguments));
+    option_table.clear_option_index();
+    measurements.emplace_back(measure_parse(
+        fmt::format("parse/{0} options/1000 tokens/scan", option_count),
+        option_table, arguments));
+  }
+
+  measurements.emplace_back(
+      fx::benchmark::helper::measure("compile/1000 options", 20, [&]() {
+        const auto compiled = create_table(1000);
+        if (compiled.option_index().keys().empty()) {
+          std::abort();
+        }
+      }));
+
+  for (const std::size_t choice_count : {100, 5000}) {
+    measure_choices(measurements, choice_count);
+  }
+
+  measure_numbers(measurements, 50000);
+
+  fmt::print("\n");
+  fx::benchmark::helper::print(measurements);
+}
@@ -0,0 +1,5 @@
+#include "fx/command/forwarder/plugin/fx_plugin.h"
+
+int fx_plugin_main_v1(const fx_plugin_context_t* context) {
+  return context->argument_count == 0;
+}
@@ -0,0 +1,99 @@
+#include <fmt/core.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+#include "benchmark/helper/helper.hpp"
+#include "fx/command/forwarder/plugin/plugin.hpp"
+
+extern char** environ;
+
+static fx::descriptor::v1beta::FxCommandDescriptor create_descriptor() {
+  fx::descriptor::v1beta::FxCommandDescriptor descriptor;
+  auto* verbose = descriptor.add_options();
+  verbose->set_name("verbose");
+  verbose->mutable_bool_value();
+  auto* jobs = descriptor.add_options();
+  jobs->set_name("jobs");
+  jobs->mutable_int_value();
+  auto* targets = descriptor.add_arguments();
+  targets->set_name("targets");
+  targets->mutable_string_value()->set_list(true);
+  return descriptor;
+}
+
+static void spawn(const std::vector<std::string>& arguments) {
+  std::vector<char*> argv;
+  for (const auto& argument : arguments) {
+    argv.push_back(const_cast<char*>(argument.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  pid_t pid = 0;
+  if (posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ) !=
+      0) {
+    std::abort();
+  }
+  int status = 0;
+  if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    std::abort();
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    fmt::print(stderr, "Usage: {0} <plugin> [iterations]\n", argv[0]);
+    return 1;
+  }
+  const std::filesystem::path plugin = std::filesystem::absolute(argv[1]);
+  const std::uint64_t iterations =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+
+  const auto descriptor = create_descriptor();
+  const auto arguments = nlohmann::json::parse(R"({
+    "verbose": {"user_set": true, "value": true},
+    "jobs": {"user_set": false, "value": 8},
+    "targets": {"user_set": true, "value": ["//a/...", "//b/...", "//c:d"]}
+  })");
+  const auto serialized = arguments.dump();
+
+  std::vector<fx::benchmark::helper::measurement_t> measurements;
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "plugin/call", iterations, [&]() {
+        const fx::command::forwarder::plugin::Arguments plugin_arguments(
+            descriptor, arguments);
+        fx_plugin_context_t context{};
+        context.abi_version = FX_PLUGIN_ABI_VERSION;
+        context.command = "benchmark";
+        context.workspace_directory = "/";
+        context.argument_count = plugin_arguments.size();
+        context.arguments = plugin_arguments.data();
+        context.in = stdin;
+        context.out = stdout;
+        context.err = stderr;
+        const auto result =
+            fx::command::forwarder::plugin::run(plugin, context);
+        if (result.failed() || result.value() != 0) {
+          std::abort();
+        }
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "execve/sh", iterations, [&]() {
+        spawn({"/bin/sh", "-c", "true \"$0\"", serialized});
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "execve/sh-login", iterations, [&]() {
+        spawn({"/bin/sh", "-l", "-c", "true \"$0\"", serialized});
+      }));
+
+  fx::benchmark::helper::print(measurements);
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <fcntl.h>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <spawn.h>
+#include <spdlog/cfg/env.h>
+#include <spdlog/spdlog.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "benchmark/helper/helper.hpp"
+#include "fx/log/log.hpp"
+
+extern char** environ;
+
+// What main did for every invocation before the logger was set up lazily.
+static void setup_eagerly() {
+  spdlog::cfg::load_env_levels();
+  const auto prefix = fmt::format(fmt::emphasis::faint, "fx %H:%M:%S.%e");
+  const auto pid = fmt::format(fg(fmt::terminal_color::magenta), "%P");
+  const auto thread = fmt::format(fmt::emphasis::faint, "~%t");
+  const auto separator = fmt::format(fmt::emphasis::faint, ":");
+  spdlog::set_pattern(
+      fmt::format("{0} %^%5l%$ {1}{2}{3} %v", prefix, pid, thread, separator));
+}
+
+static void spawn(const std::vector<std::string>& arguments) {
+  std::vector<char*> argv;
+  for (const auto& argument : arguments) {
+    argv.push_back(const_cast<char*>(argument.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+                                   O_WRONLY, 0);
+  pid_t pid = 0;
+  if (posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ) !=
+      0) {
+    std::abort();
+  }
+  posix_spawn_file_actions_destroy(&actions);
+  int status = 0;
+  if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    std::abort();
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    fmt::print(stderr, "Usage: {0} <fx> [iterations]\n", argv[0]);
+    return 1;
+  }
+  const auto fx = std::filesystem::absolute(argv[1]).u8string();
+  const std::uint64_t iterations =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+
+  const auto workspace = std::filesystem::temp_directory_path() /
+                         fmt::format("fx_log_benchmark_{0}", getpid());
+  std::filesystem::create_directories(workspace / "noop");
+  std::ofstream(workspace / "workspace.fx.yaml")
+      << "descriptor_version: v1beta\n";
+  std::ofstream(workspace / "noop" / "command.fx.yaml")
+      << "descriptor_version: v1beta\nsynopsis: noop\nruntime:\n  run: "
+         "\":\"\n";
+  std::filesystem::current_path(workspace);
+
+  const std::vector<std::string> arguments{"build", "//a/...", "//b/...",
+                                           "--jobs", "8"};
+  std::vector<fx::benchmark::helper::measurement_t> measurements;
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "setup/eager", iterations, [&]() { setup_eagerly(); }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "debug-off/spdlog", iterations * 100, [&]() {
+        spdlog::debug("Executing: {0}", fmt::join(arguments, " "));
+        spdlog::debug("Using cached descriptor {0}", workspace.u8string());
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "debug-off/fx", iterations * 100, [&]() {
+        FX_LOG_DEBUG("Executing: {0}", fmt::join(arguments, " "));
+        FX_LOG_DEBUG("Using cached descriptor {0}", workspace.u8string());
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "startup/version", iterations, [&]() { spawn({fx, "version"}); }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "startup/command", iterations, [&]() { spawn({fx, "noop"}); }));
+
+  std::filesystem::remove_all(workspace);
+  fx::benchmark::helper::print(measurements);
+  return 0;
+}
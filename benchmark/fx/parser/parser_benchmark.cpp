@@ -0,0 +1,142 @@
+#include <fmt/core.h>
+#include <fmt/os.h>
+#include <google/protobuf/arena.h>
+#include <cstdlib>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+#include "benchmark/helper/helper.hpp"
+#include "fx/parser/parser.hpp"
+#include "fx/parser/yaml_reader/yaml_reader.hpp"
+#include "fx/parser/yaml_to_json/yaml_to_json.hpp"
+
+static const std::string descriptor_yaml = R"(descriptor_version: v1beta
+synopsis: Benchmark command.
+description: A command descriptor that looks like the ones found in real workspaces.
+options:
+  - name: verbose
+    short_name: v
+    description: Print more.
+    bool_value: {}
+  - name: language
+    short_name: l
+    description: Languages to run on.
+    string_value:
+      list: true
+      choices: [all, cpp, java, python, go, rust]
+      default: all
+  - name: jobs
+    short_name: j
+    description: Number of parallel jobs.
+    int_value:
+      default: 8
+arguments:
+  - name: targets
+    description: Targets to run on.
+    string_value:
+      list: true
+runtime:
+  run: python3 $FX_WORKSPACE_DIRECTORY/benchmark/main.py
+)";
+
+static std::vector<std::filesystem::path> create_descriptors(
+    const std::filesystem::path& directory, std::uint64_t count) {
+  std::vector<std::filesystem::path> paths;
+  for (std::uint64_t index = 0; index < count; index++) {
+    const auto command_directory =
+        directory / std::filesystem::path(fmt::format("command-{0}", index));
+    std::filesystem::create_directories(command_directory);
+    const auto path =
+        command_directory / std::filesystem::path("command.fx.yaml");
+    auto file = fmt::output_file(path.u8string());
+    file.print("{}", descriptor_yaml);
+    paths.emplace_back(path);
+  }
+  return paths;
+}
+
+int main(int argc, char* argv[]) {
+  const std::uint64_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                       : 10000;
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::filesystem::path("fx-parser-benchmark");
+  std::filesystem::remove_all(directory);
+  const auto paths = create_descriptors(directory, count);
+
+  std::vector<fx::benchmark::helper::measurement_t> measurements;
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "parse_command_descriptor/heap", 1, [&]() {
+        for (const auto& path : paths) {
+          const auto result = fx::parser::parse_command_descriptor(path);
+          if (result.failed()) {
+            std::abort();
+          }
+        }
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "parse_command_descriptor/arena", 1, [&]() {
+        std::vector<char> block(64 * 1024);
+        google::protobuf::ArenaOptions options;
+        options.initial_block = block.data();
+        options.initial_block_size = block.size();
+        google::protobuf::Arena arena(options);
+        for (const auto& path : paths) {
+          const auto result = fx::parser::parse_command_descriptor(path, &arena);
+          if (result.failed()) {
+            std::abort();
+          }
+          arena.Reset();
+        }
+      }));
+
+  // Isolates the YAML side of parsing, which is what the fast path changes.
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "yaml_to_json/yaml-cpp", count, [&]() {
+        nlohmann::json json;
+        if (fx::parser::yaml_to_json::convert(YAML::Load(descriptor_yaml), json)
+                .failed()) {
+          std::abort();
+        }
+      }));
+
+  measurements.emplace_back(
+      fx::benchmark::helper::measure("yaml_to_json/fast", count, [&]() {
+        if (!fx::parser::yaml_reader::read(descriptor_yaml).has_value()) {
+          std::abort();
+        }
+      }));
+
+  // Isolates the protobuf side of parsing, which is what the arena changes.
+  nlohmann::json descriptor_json;
+  fx::parser::yaml_to_json::convert(YAML::Load(descriptor_yaml),
+                                    descriptor_json);
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "json_to_descriptor/heap", count, [&]() {
+        const auto result = fx::parser::json_to_descriptor<
+            fx::descriptor::v1beta::FxCommandDescriptor>(descriptor_json);
+        if (result.failed()) {
+          std::abort();
+        }
+      }));
+
+  {
+    google::protobuf::Arena arena;
+    measurements.emplace_back(fx::benchmark::helper::measure(
+        "json_to_descriptor/arena", count, [&]() {
+          const auto result = fx::parser::json_to_descriptor<
+              fx::descriptor::v1beta::FxCommandDescriptor>(descriptor_json,
+                                                          &arena);
+          if (result.failed()) {
+            std::abort();
+          }
+        }));
+  }
+
+  fmt::print("{0} descriptors\n\n", count);
+  fx::benchmark::helper::print(measurements);
+  std::filesystem::remove_all(directory);
+}
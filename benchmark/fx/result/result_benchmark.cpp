@@ -0,0 +1,119 @@
+#include <fmt/core.h>
+#include <fmt/os.h>
+#include <stdlib.h>
+#include <cstdlib>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "benchmark/helper/helper.hpp"
+#include "fx/command/forwarder/forwarder.hpp"
+#include "fx/descriptor/v1beta/descriptor.pb.h"
+
+// Measures the results the forward path hands around: the descriptor that
+// Forwarder::parse_command_descriptor returns from the cache, and the
+// arguments JSON that argparse returns. The copy rows are what one more copy
+// of either value costs, which the forward path rows would grow by if a copy
+// came back.
+
+static const std::string descriptor_yaml = R"(descriptor_version: v1beta
+synopsis: Benchmark command.
+description: A command descriptor with a handful of options.
+options:
+  - name: verbose
+    short_name: v
+    description: Print more.
+    bool_value: {}
+  - name: language
+    short_name: l
+    description: Languages.
+    string_value:
+      list: true
+      choices: [all, cpp, java, python]
+      default: all
+  - name: jobs
+    short_name: j
+    description: Jobs.
+    int_value:
+      default: 8
+arguments:
+  - name: targets
+    description: Targets.
+    string_value:
+      list: true
+runtime:
+  run: python3 main.py
+)";
+
+int main() {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::filesystem::path("fx-result-benchmark");
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory / "benchmark");
+  fmt::output_file((directory / "workspace.fx.yaml").u8string())
+      .print("descriptor_version: v1beta\n");
+  fmt::output_file((directory / "benchmark" / "command.fx.yaml").u8string())
+      .print("{}", descriptor_yaml);
+  setenv("FX_CACHE_DIR", (directory / "cache").c_str(), 1);
+
+  const auto workspace_path = directory / "workspace.fx.yaml";
+  const std::vector<std::string_view> arguments{
+      "-v", "-l", "cpp", "-l", "python", "//src/...", "//test/..."};
+
+  fx::command::Forwarder forwarder("benchmark");
+  // Fills the cache, so every iteration takes the cached path.
+  const auto descriptor_result =
+      forwarder.parse_command_descriptor(workspace_path);
+  if (descriptor_result.failed()) {
+    std::abort();
+  }
+  const auto& descriptor = descriptor_result.value();
+  const auto arguments_result =
+      forwarder.parse_command_arguments(descriptor, arguments);
+  if (arguments_result.failed()) {
+    std::abort();
+  }
+  const auto& arguments_json = arguments_result.value();
+
+  const std::uint64_t iterations = 10000;
+  fx::benchmark::helper::print({
+      fx::benchmark::helper::measure(
+          "forward_path/parse_command_descriptor", iterations,
+          [&]() {
+            const auto result =
+                forwarder.parse_command_descriptor(workspace_path);
+            if (result.failed() || result.value().synopsis().empty()) {
+              std::abort();
+            }
+          }),
+      fx::benchmark::helper::measure(
+          "forward_path/parse_command_arguments", iterations,
+          [&]() {
+            const auto result =
+                forwarder.parse_command_arguments(descriptor, arguments);
+            if (result.failed() || result.value().empty()) {
+              std::abort();
+            }
+          }),
+      fx::benchmark::helper::measure(
+          "copy/descriptor", iterations,
+          [&]() {
+            const fx::descriptor::v1beta::FxCommandDescriptor copy(
+                descriptor);
+            if (copy.synopsis().empty()) {
+              std::abort();
+            }
+          }),
+      fx::benchmark::helper::measure(
+          "copy/arguments", iterations,
+          [&]() {
+            const nlohmann::json copy(arguments_json);
+            if (copy.empty()) {
+              std::abort();
+            }
+          }),
+  });
+
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,95 @@
+#include <fmt/core.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "benchmark/helper/helper.hpp"
+#include "fx/suggest/suggest.hpp"
+
+// Command names shaped like those of a large monorepo, i.e. "payments/lint".
+
+static const std::vector<std::string> syllables{
+    "ba", "co", "de", "fi", "ga", "ho", "ju", "ki", "lo", "ma", "ne", "pi",
+    "qu", "ra", "se", "ti", "vo", "wa", "xe", "zu"};
+
+static const std::vector<std::string> verbs{
+    "build", "test",   "lint",  "format", "deploy", "release", "bench",
+    "check", "update", "clean", "serve",  "migrate"};
+
+static std::string create_word(std::uint64_t seed) {
+  std::string word;
+  for (int index = 0; index < 3 + static_cast<int>(seed % 3); index++) {
+    word += syllables[seed % syllables.size()];
+    seed /= syllables.size();
+    seed = seed * 2654435761u + 1;
+  }
+  return word;
+}
+
+static std::vector<std::string> create_names(std::uint64_t count) {
+  std::vector<std::string> names;
+  for (std::uint64_t index = 0; index < count; index++) {
+    names.emplace_back(fmt::format("{0}/{1}", create_word(index / verbs.size()),
+                                   verbs[index % verbs.size()]));
+  }
+  return names;
+}
+
+// A typo of every 97th name: one substitution and, for every other query, a
+// dropped character.
+static std::vector<std::string> create_queries(
+    const std::vector<std::string>& names) {
+  std::vector<std::string> queries;
+  for (std::size_t index = 0; index < names.size(); index += 97) {
+    auto query = names[index];
+    query[query.size() / 2] = 'x';
+    if (queries.size() % 2 == 0) {
+      query.erase(1, 1);
+    }
+    queries.push_back(std::move(query));
+  }
+  return queries;
+}
+
+int main(int argc, char* argv[]) {
+  const std::uint64_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                       : 50000;
+  const auto names = create_names(count);
+  const auto queries = create_queries(names);
+
+  std::vector<fx::benchmark::helper::measurement_t> measurements;
+
+  fx::suggest::v1beta::Trie trie;
+  measurements.emplace_back(
+      fx::benchmark::helper::measure("build", 1, [&]() {
+        trie = fx::suggest::build(names);
+      }));
+
+  std::string serialized;
+  measurements.emplace_back(
+      fx::benchmark::helper::measure("parse", 1, [&]() {
+        serialized = trie.SerializeAsString();
+        fx::suggest::v1beta::Trie parsed;
+        if (!parsed.ParseFromString(serialized)) {
+          std::abort();
+        }
+      }));
+
+  std::size_t found = 0;
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "suggest", queries.size(), [&, next = std::size_t(0)]() mutable {
+        found += fx::suggest::suggest(trie, queries[next++]).size();
+      }));
+
+  measurements.emplace_back(fx::benchmark::helper::measure(
+      "scan", queries.size(), [&, next = std::size_t(0)]() mutable {
+        const auto& query = queries[next++];
+        for (const auto& name : names) {
+          found += fx::suggest::distance(query, name) <= 2 ? 1 : 0;
+        }
+      }));
+
+  fx::benchmark::helper::print(measurements);
+  fmt::print("{0} names, {1} queries, {2} bytes serialized, {3} found\n",
+             names.size(), queries.size(), serialized.size(), found);
+  return 0;
+}
@@ -0,0 +1,42 @@
+#include "helper.hpp"
+#include <fmt/core.h>
+#include <algorithm>
+#include "test/helper/allocations/allocations.hpp"
+
+namespace fx::benchmark::helper {
+  allocations_t allocations() {
+    return allocations_t{fx::test::helper::allocations(),
+                         fx::test::helper::allocated_bytes()};
+  }
+
+  measurement_t measure(const std::string& name, std::uint64_t iterations,
+                        const std::function<void()>& body) {
+    const auto start_allocations = allocations();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t iteration = 0; iteration < iterations; iteration++) {
+      body();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto end_allocations = allocations();
+
+    return measurement_t{
+        name, iterations,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start),
+        allocations_t{end_allocations.count - start_allocations.count,
+                      end_allocations.bytes - start_allocations.bytes}};
+  }
+
+  void print(const std::vector<measurement_t>& measurements) {
+    fmt::print("{0:<48} {1:>10} {2:>14} {3:>14} {4:>14}\n", "benchmark",
+               "iterations", "ns/iter", "allocs/iter", "bytes/iter");
+    for (const auto& measurement : measurements) {
+      const auto iterations =
+          static_cast<double>(std::max<std::uint64_t>(measurement.iterations, 1));
+      fmt::print("{0:<48} {1:>10} {2:>14.1f} {3:>14.1f} {4:>14.1f}\n",
+                 measurement.name, measurement.iterations,
+                 static_cast<double>(measurement.elapsed.count()) / iterations,
+                 static_cast<double>(measurement.allocations.count) / iterations,
+                 static_cast<double>(measurement.allocations.bytes) / iterations);
+    }
+  }
+}  // namespace fx::benchmark::helper
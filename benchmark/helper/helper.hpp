@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fx::benchmark::helper {
+  struct allocations_t {
+    std::uint64_t count;
+    std::uint64_t bytes;
+  };
+
+  struct measurement_t {
+    std::string name;
+    std::uint64_t iterations;
+    std::chrono::nanoseconds elapsed;
+    allocations_t allocations;
+  };
+
+  // Allocations made through the global operator new since the process
+  // started.
+  allocations_t allocations();
+
+  measurement_t measure(const std::string& name, std::uint64_t iterations,
+                        const std::function<void()>& body);
+
+  void print(const std::vector<measurement_t>& measurements);
+}  // namespace fx::benchmark::helper
@@ -1,26 +1,216 @@
 #include "argparse.hpp"
 #include <fmt/core.h>
-#include <lyra/lyra.hpp>
+#include <algorithm>
+#include <charconv>
 #include "fx/argparse/converter/converter.hpp"
+#include "fx/argparse/stream/stream.hpp"
+#include "fx/argparse/table/table.hpp"
+#include "fx/suggest/suggest.hpp"
 
 namespace fx::argparse {
+  namespace {
+    bool is_help(std::string_view token) {
+      return token == "-h" || token == "--help" || token == "-?";
+    }
+
+    bool is_option(std::string_view token) {
+      return token.size() > 1 && token[0] == '-';
+    }
+
+    // "-5" and "-.5" are values rather than options; "-inf" is not.
+    bool is_negative_number(std::string_view token) {
+      const bool numeric =
+          token.size() > 1 &&
+          (('0' <= token[1] && token[1] <= '9') || token[1] == '.');
+      if (!numeric) {
+        return false;
+      }
+      double value;
+      const auto [end, error] =
+          std::from_chars(token.data(), token.data() + token.size(), value);
+      return error == std::errc() && end == token.data() + token.size();
+    }
+
+    bool is_full(const fx::argparse::v1beta::InputSpec &spec,
+                 const converter::opt_value_t &value) {
+      return value.user_set && !spec.list();
+    }
+
+    std::string usage(const fx::argparse::v1beta::InputSpec &spec,
+                      bool option) {
+      if (!option) {
+        return spec.list() ? fmt::format("<{0}> [<{0}>...]", spec.name())
+                           : fmt::format("<{0}>", spec.name());
+      }
+
+      if (spec.short_name().empty()) {
+        return fmt::format("--{0} <{0}>", spec.name());
+      }
+      return fmt::format("-{0}|--{1} <{1}>", spec.short_name(), spec.name());
+    }
+
+    std::string unrecognized(const fx::argparse::v1beta::ParseTable &table,
+                             std::string_view token) {
+      if (!is_option(token)) {
+        return fmt::format("Unrecognized token: {0}", token);
+      }
+
+      std::vector<std::string> keys;
+      for (const auto &spec : table.options()) {
+        keys.push_back(fmt::format("--{0}", spec.name()));
+        if (!spec.short_name().empty()) {
+          keys.push_back(fmt::format("-{0}", spec.short_name()));
+        }
+      }
+      const auto name = token.substr(0, token.find('='));
+      auto suggestions =
+          fx::suggest::suggest(fx::suggest::build(std::move(keys)), name);
+      // An exact match means a scalar option was repeated, not misspelled.
+      suggestions.erase(
+          std::remove(suggestions.begin(), suggestions.end(), name),
+          suggestions.end());
+      if (suggestions.empty()) {
+        return fmt::format("Unrecognized token: {0}", token);
+      }
+      return fmt::format("Unrecognized token: {0}.{1}", token,
+                         fx::suggest::did_you_mean(suggestions));
+    }
+  }  // namespace
+
   fx::result::Result<nlohmann::json> parse(
-      const std::vector<std::string> &arguments,
+      fx::util::arguments_t arguments,
       const fx::descriptor::v1beta::FxCommandDescriptor &descriptor) {
-    converter::named_opt_value_t values;
-    const auto cli = converter::create_lyra_cli(descriptor, values);
+    return parse(arguments, table::compile(descriptor));
+  }
+
+  fx::result::Result<nlohmann::json> parse(
+      fx::util::arguments_t arguments,
+      const fx::argparse::v1beta::ParseTable &table) {
+    std::vector<converter::opt_value_t> options;
+    options.reserve(table.options_size());
+    for (const auto &spec : table.options()) {
+      options.push_back(converter::default_value(spec));
+    }
+
+    std::vector<converter::opt_value_t> positionals;
+    positionals.reserve(table.arguments_size());
+    for (const auto &spec : table.arguments()) {
+      positionals.push_back(converter::default_value(spec));
+    }
+
+    const auto to_json = [&](bool help) {
+      converter::named_opt_value_t values;
+      values["help"] = converter::opt_value_t{false, help};
+      for (int i = 0; i < table.options_size(); i++) {
+        values[table.options(i).name()] = std::move(options[i]);
+      }
+      for (int i = 0; i < table.arguments_size(); i++) {
+        values[table.arguments(i).name()] = std::move(positionals[i]);
+      }
+      return fx::result::Result<nlohmann::json>(
+          fx::result::Ok(converter::values_to_json(values)));
+    };
+
+    const auto error = [](const std::string &message) {
+      return fx::result::Result<nlohmann::json>(
+          fx::result::Error(fmt::format("[argparse] {0}", message)));
+    };
+
+    stream::TokenStream tokens(arguments);
+    for (;;) {
+      auto next = tokens.next();
+      if (next.failed()) {
+        return error(next.error());
+      }
+      if (!next.value().has_value()) {
+        break;
+      }
+      const auto token = *next.value();
+
+      if (is_help(token)) {
+        return to_json(true);
+      }
+
+      const auto separator = token.find('=');
+      const auto name = token.substr(0, separator);
+      const auto found = is_option(token) ? table::find_option(table, name)
+                                          : std::nullopt;
+      // Only negative numbers fall through to the positional arguments;
+      // unknown and repeated options are errors.
+      if (is_option(token) && !is_negative_number(token) &&
+          (!found.has_value() ||
+           is_full(table.options(static_cast<int>(*found)),
+                   options[*found]))) {
+        return error(unrecognized(table, token));
+      }
+      if (found.has_value() &&
+          !is_full(table.options(static_cast<int>(*found)), options[*found])) {
+        const auto &spec = table.options(static_cast<int>(*found));
+        auto &value = options[*found];
+        if (spec.type() == fx::argparse::v1beta::InputSpec::TYPE_BOOL) {
+          if (separator != std::string_view::npos) {
+            return error(fmt::format("Unrecognized token: {0}", token));
+          }
+          value.user_set = true;
+          value.value = true;
+          continue;
+        }
+
+        std::string_view option_value;
+        if (separator != std::string_view::npos) {
+          option_value = token.substr(separator + 1);
+        } else {
+          // Reading the value may invalidate `token`.
+          const bool is_short = name.size() < 2 || name[1] != '-';
+          auto following = tokens.next();
+          if (following.failed()) {
+            return error(following.error());
+          }
+          if (!following.value().has_value()) {
+            return error(fmt::format(
+                "Expected argument following {0}{1}", is_short ? "-" : "--",
+                is_short ? spec.short_name() : spec.name()));
+          }
+          option_value = *following.value();
+        }
+
+        if (auto res = converter::assign_value(spec, option_value, value);
+            res.failed()) {
+          return error(res.error());
+        }
+        continue;
+      }
+
+      int index = 0;
+      while (index < table.arguments_size() &&
+             is_full(table.arguments(index), positionals[index])) {
+        index++;
+      }
+      if (index == table.arguments_size()) {
+        return error(unrecognized(table, token));
+      }
+
+      if (auto res = converter::assign_value(table.arguments(index), token,
+                                             positionals[index]);
+          res.failed()) {
+        return error(res.error());
+      }
+    }
+
+    for (int i = 0; i < table.options_size(); i++) {
+      if (table.options(i).required() && !options[i].user_set) {
+        return error(fmt::format("Expected: {0}",
+                                 usage(table.options(i), true)));
+      }
+    }
 
-    // Lyra expects the first argument to be the command name. So, insert a
-    // fake command when parsing the args.
-    std::vector<std::string> enriched_arguments{"fx"};
-    enriched_arguments.insert(enriched_arguments.end(), arguments.begin(),
-                              arguments.end());
-    auto result = cli.parse(
-        lyra::args{enriched_arguments.begin(), enriched_arguments.end()});
-    if (!result) {
-      return fx::result::Error(fmt::format("[argparse] {0}", result.message()));
+    for (int i = 0; i < table.arguments_size(); i++) {
+      if (table.arguments(i).required() && !positionals[i].user_set) {
+        return error(fmt::format("Expected: {0}",
+                                 usage(table.arguments(i), false)));
+      }
     }
 
-    return fx::result::Ok(converter::values_to_json(values));
+    return to_json(false);
   }
 }  // namespace fx::argparse
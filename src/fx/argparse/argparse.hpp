@@ -1,11 +1,17 @@
 #pragma once
 
 #include <nlohmann/json.hpp>
+#include "fx/argparse/v1beta/table.pb.h"
 #include "fx/descriptor/v1beta/descriptor.pb.h"
 #include "fx/result/result.hpp"
+#include "fx/util/util.hpp"
 
 namespace fx::argparse {
   fx::result::Result<nlohmann::json> parse(
-      const std::vector<std::string>& arguments,
+      fx::util::arguments_t arguments,
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor);
+
+  fx::result::Result<nlohmann::json> parse(
+      fx::util::arguments_t arguments,
+      const fx::argparse::v1beta::ParseTable& table);
 }  // namespace fx::argparse
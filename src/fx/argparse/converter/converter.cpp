@@ -1,178 +1,216 @@
 #include "converter.hpp"
+#include <fmt/core.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+#include "fx/argparse/table/table.hpp"
 
 namespace fx::argparse::converter {
-  template <>
-  lyra::opt enrich_input(
-      const fx::descriptor::v1beta::OptionDescriptor &descriptor,
-      lyra::opt &input) {
-    if (!descriptor.short_name().empty()) {
-      input = input.name("-" + descriptor.short_name());
+  opt_value_t default_value(const fx::argparse::v1beta::InputSpec& spec) {
+    switch (spec.type()) {
+      case fx::argparse::v1beta::InputSpec::TYPE_INT:
+        if (spec.list()) {
+          return opt_value_t{false, std::vector{spec.int_default()}};
+        }
+        return opt_value_t{false, spec.int_default()};
+      case fx::argparse::v1beta::InputSpec::TYPE_DOUBLE:
+        if (spec.list()) {
+          return opt_value_t{false, std::vector{spec.double_default()}};
+        }
+        return opt_value_t{false, spec.double_default()};
+      case fx::argparse::v1beta::InputSpec::TYPE_STRING:
+        if (spec.list()) {
+          return opt_value_t{false, std::vector{spec.string_default()}};
+        }
+        return opt_value_t{false, spec.string_default()};
+      default:
+        return opt_value_t{false, false};
     }
-    return input.name("--" + descriptor.name()).help(descriptor.description());
   }
 
-  template <typename I, typename T, typename D>
-  I create_input(const D &descriptor, named_opt_value_t &values,
-                 T default_value, bool required, const std::set<T> &choices) {
-    static_assert(std::is_base_of<lyra::bound_parser<I>, I>::value,
-                  "type I must be lyra::arg or lyra::opt");
-
-    values[descriptor.name()] = opt_value_t{false, default_value};
-    auto input = I(
-                     [&](T new_value) {
-                       opt_value_t &opt_value = values[descriptor.name()];
-                       opt_value.user_set = true;
-                       opt_value.value = new_value;
-                     },
-                     descriptor.name())
-                     .cardinality(required ? 1 : 0, 1);
-
-    if (!choices.empty()) {
-      input = input.choices([=](T choice) {
-        return choices.find(choice) != choices.end();
-      });
+  namespace {
+#if defined(__cpp_lib_to_chars)
+    constexpr bool has_floating_from_chars = true;
+#else
+    // Floating point from_chars is missing from older standard libraries.
+    constexpr bool has_floating_from_chars = false;
+#endif
+
+    fx::result::Result<void> format_error(std::string_view token) {
+      return fx::result::Error(fmt::format(
+          "Unable to convert '{0}' to destination type", token));
     }
 
-    return enrich_input(descriptor, input);
-  }
-
-  template <typename I, typename T, typename D>
-  I create_input(const D &descriptor, named_opt_value_t &values,
-                 std::vector<T> default_values, bool required,
-                 std::set<T> choices) {
-    static_assert(std::is_base_of<lyra::bound_parser<I>, I>::value,
-                  "type I must be lyra::arg or lyra::opt");
-    values[descriptor.name()] = opt_value_t{false, default_values};
-    auto input = I(
-                     [&](T new_value) {
-                       opt_value_t &opt_value = values[descriptor.name()];
-                       auto &current =
-                           std::get<std::vector<T>>(opt_value.value);
-                       if (!opt_value.user_set) {
-                         // The user is setting the input, so clear the
-                         // default values.
-                         current.clear();
-                       }
-                       opt_value.user_set = true;
-                       current.push_back(new_value);
-                     },
-                     descriptor.name())
-                     .cardinality(required ? 1 : 0, 0);
-
-    if (choices.size() > 0) {
-      input = input.choices([=](T choice) {
-        return choices.find(choice) != choices.end();
-      });
+    fx::result::Result<void> range_error(std::string_view token) {
+      return fx::result::Error(
+          fmt::format("Value '{0}' is out of range.", token));
     }
 
-    return enrich_input(descriptor, input);
-  }
-
-  lyra::opt create_bool_option(
-      const fx::descriptor::v1beta::OptionDescriptor &descriptor,
-      named_opt_value_t &values) {
-    values[descriptor.name()] = opt_value_t{false, false};
-    auto option = lyra::opt([&](bool new_value) {
-      opt_value_t &opt_value = values[descriptor.name()];
-      opt_value.user_set = true;
-      opt_value.value = new_value;
-    });
-    return enrich_input(descriptor, option);
-  }
+    fx::result::Result<void> choice_error(std::string_view token) {
+      return fx::result::Error(
+          fmt::format("Value '{0}' not expected.", token));
+    }
 
-  template <typename D>
-  std::variant<opt_input_t<int64_t>, opt_input_t<double>,
-               opt_input_t<std::string>>
-  create_opt_input_t(const D &descriptor) {
-    if (descriptor.has_int_value()) {
-      opt_input_t<int64_t> oit;
-      oit.choices = std::set<int64_t>{descriptor.int_value().choices().begin(),
-                                      descriptor.int_value().choices().end()};
-      oit.required = descriptor.int_value().required();
-      if (descriptor.int_value().list()) {
-        oit.default_value = std::vector{descriptor.int_value().default_()};
-      } else {
-        oit.default_value = descriptor.int_value().default_();
+    template <typename T>
+    fx::result::Result<void> convert_number(std::string_view token,
+                                            T& converted) {
+      const char* begin = token.data();
+      const char* end = token.data() + token.size();
+      if (begin != end && *begin == '+') {
+        begin++;
+        // from_chars would take the sign of "+-5" as its own.
+        if (begin != end && (*begin == '+' || *begin == '-')) {
+          return format_error(token);
+        }
       }
-      return oit;
-    } else if (descriptor.has_double_value()) {
-      opt_input_t<double> oit;
-      oit.choices =
-          std::set<double>{descriptor.double_value().choices().begin(),
-                           descriptor.double_value().choices().end()};
-      oit.required = descriptor.double_value().required();
-      if (descriptor.double_value().list()) {
-        oit.default_value = std::vector{descriptor.double_value().default_()};
-      } else {
-        oit.default_value = descriptor.double_value().default_();
+      if (begin == end) {
+        return format_error(token);
       }
-      return oit;
-    } else if (descriptor.has_string_value()) {
-      opt_input_t<std::string> oit;
-      oit.choices =
-          std::set<std::string>{descriptor.string_value().choices().begin(),
-                                descriptor.string_value().choices().end()};
-      oit.required = descriptor.string_value().required();
-      if (descriptor.string_value().list()) {
-        oit.default_value = std::vector{descriptor.string_value().default_()};
+
+      if constexpr (std::is_integral<T>::value || has_floating_from_chars) {
+        const auto [pointer, error] = std::from_chars(begin, end, converted);
+        if (error == std::errc::result_out_of_range) {
+          return range_error(token);
+        }
+        if (error != std::errc() || pointer != end) {
+          return format_error(token);
+        }
       } else {
-        oit.default_value = descriptor.string_value().default_();
+        const std::string copy(token);
+        char* pointer = nullptr;
+        errno = 0;
+        converted = std::strtod(copy.c_str(), &pointer);
+        if (pointer != copy.c_str() + copy.size() ||
+            std::isspace(static_cast<unsigned char>(copy[0]))) {
+          return format_error(token);
+        }
+        if (errno == ERANGE) {
+          return range_error(token);
+        }
+      }
+      // JSON has no representation for "inf" and "nan".
+      if constexpr (std::is_floating_point<T>::value) {
+        if (!std::isfinite(converted)) {
+          return format_error(token);
+        }
       }
-      return oit;
+      return fx::result::Ok();
     }
 
-    // We should never reach this case. This is here to satisfy the compiler.
-    exit(1);
-  }
-
-  lyra::cli create_lyra_cli(
-      const fx::descriptor::v1beta::FxCommandDescriptor &descriptor,
-      named_opt_value_t &values) {
-    auto cli = lyra::cli();
+    template <typename T, typename C>
+    fx::result::Result<void> assign_number(
+        const fx::argparse::v1beta::InputSpec& spec, std::string_view token,
+        const C& choices, opt_value_t& value) {
+      T converted;
+      if (!spec.list()) {
+        if (auto res = convert_number(token, converted); res.failed()) {
+          return res;
+        }
+        if (!choices.empty() && !is_choice(choices, converted)) {
+          return choice_error(token);
+        }
+        value.value = converted;
+        value.user_set = true;
+        return fx::result::Ok();
+      }
 
-    values["help"] = opt_value_t{false, false};
-    cli.add_argument(lyra::help(std::get<bool>(values["help"].value)));
+      auto& current = std::get<std::vector<T>>(value.value);
+      if (!value.user_set) {
+        // The user is setting the input, so clear the default values.
+        current.clear();
+      }
+      value.user_set = true;
 
-    for (const auto &option_descriptor : descriptor.options()) {
-      if (option_descriptor.has_bool_value()) {
-        cli.add_argument(create_bool_option(option_descriptor, values));
-      } else {
-        std::visit(
-            [&](auto oit) {
-              std::visit(
-                  [&](auto default_value) {
-                    cli.add_argument(create_input<lyra::opt>(
-                        option_descriptor, values, default_value, oit.required,
-                        oit.choices));
-                  },
-                  oit.default_value);
-            },
-            create_opt_input_t(option_descriptor));
+      // Packed lists are converted in place, one element per comma.
+      const auto needed = current.size() + 1 +
+                          std::count(token.begin(), token.end(), ',');
+      if (needed > current.capacity()) {
+        current.reserve(std::max(needed, current.capacity() * 2));
+      }
+      for (size_t start = 0;;) {
+        const auto separator = token.find(',', start);
+        const auto element = token.substr(start, separator - start);
+        if (auto res = convert_number(element, converted); res.failed()) {
+          return res;
+        }
+        if (!choices.empty() && !is_choice(choices, converted)) {
+          return choice_error(element);
+        }
+        current.push_back(converted);
+
+        if (separator == std::string_view::npos) {
+          break;
+        }
+        start = separator + 1;
       }
+      return fx::result::Ok();
     }
+  }  // namespace
 
-    for (const auto &argument_descriptor : descriptor.arguments()) {
-      std::visit(
-          [&](auto oit) {
-            std::visit(
-                [&](auto default_value) {
-                  cli.add_argument(create_input<lyra::arg>(
-                      argument_descriptor, values, default_value, oit.required,
-                      oit.choices));
-                },
-                oit.default_value);
-          },
-          create_opt_input_t(argument_descriptor));
-    }
+  template <>
+  fx::result::Result<int64_t> convert_token(std::string_view token) {
+    int64_t converted = 0;
+    return convert_number(token, converted).map([&]() {
+      return converted;
+    });
+  }
 
-    return cli;
+  template <>
+  fx::result::Result<double> convert_token(std::string_view token) {
+    double converted = 0;
+    return convert_number(token, converted).map([&]() {
+      return converted;
+    });
+  }
+
+  template <typename T, typename C>
+  bool is_choice(const C& choices, const T& value) {
+    // Choices are sorted when the parse table is compiled.
+    return std::binary_search(choices.begin(), choices.end(), value);
+  }
+
+  fx::result::Result<void> assign_value(
+      const fx::argparse::v1beta::InputSpec& spec, std::string_view token,
+      opt_value_t& value) {
+    switch (spec.type()) {
+      case fx::argparse::v1beta::InputSpec::TYPE_INT:
+        return assign_number<int64_t>(spec, token, spec.int_choices(), value);
+      case fx::argparse::v1beta::InputSpec::TYPE_DOUBLE:
+        return assign_number<double>(spec, token, spec.double_choices(),
+                                     value);
+      case fx::argparse::v1beta::InputSpec::TYPE_STRING:
+        if (!spec.string_choices().empty() &&
+            !fx::argparse::table::is_string_choice(spec, token)) {
+          return choice_error(token);
+        }
+        if (spec.list()) {
+          auto& current = std::get<std::vector<std::string>>(value.value);
+          if (!value.user_set) {
+            // The user is setting the input, so clear the default values.
+            current.clear();
+          }
+          current.emplace_back(token);
+        } else {
+          value.value = std::string(token);
+        }
+        value.user_set = true;
+        return fx::result::Ok();
+      default:
+        value.user_set = true;
+        value.value = true;
+        return fx::result::Ok();
+    }
   }
 
-  nlohmann::json values_to_json(const named_opt_value_t &values) {
+  nlohmann::json values_to_json(const named_opt_value_t& values) {
     auto json = nlohmann::json::object();
 
-    for (const auto &[option_name, option_value] : values) {
-      auto &option_json = json[option_name];
+    for (const auto& [option_name, option_value] : values) {
+      auto& option_json = json[option_name];
       option_json["user_set"] = option_value.user_set;
       std::visit(
           [&](auto value) {
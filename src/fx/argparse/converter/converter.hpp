@@ -1,10 +1,13 @@
 #pragma once
 
-#include <lyra/lyra.hpp>
 #include <nlohmann/json.hpp>
-#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
-#include "fx/descriptor/v1beta/descriptor.pb.h"
+#include <vector>
+#include "fx/argparse/v1beta/table.pb.h"
+#include "fx/result/result.hpp"
 
 namespace fx::argparse::converter {
   struct opt_value_t {
@@ -16,39 +19,19 @@ namespace fx::argparse::converter {
 
   typedef std::unordered_map<std::string, opt_value_t> named_opt_value_t;
 
-  template <typename T>
-  struct opt_input_t {
-    std::set<T> choices;
-    bool required;
-    std::variant<T, std::vector<T>> default_value;
-  };
-
-  template <typename D, typename I>
-  I enrich_input(const D& descriptor, I& input) {
-    return input;
-  }
+  opt_value_t default_value(const fx::argparse::v1beta::InputSpec& spec);
 
-  template <typename I, typename T, typename D>
-  I create_input(const D& descriptor, named_opt_value_t& values,
-                 T default_value, bool required, const std::set<T>& choices);
+  // Converts a user token and stores it in `value`, checking it against the
+  // spec's choices. Int and double lists also accept a packed "1,2,3" token.
+  fx::result::Result<void> assign_value(
+      const fx::argparse::v1beta::InputSpec& spec, std::string_view token,
+      opt_value_t& value);
 
-  template <typename I, typename T, typename D>
-  I create_input(const D& descriptor, named_opt_value_t& values,
-                 std::vector<T> default_values, bool required,
-                 std::set<T> choices);
-
-  lyra::opt create_bool_option(
-      const fx::descriptor::v1beta::OptionDescriptor& descriptor,
-      named_opt_value_t& values);
-
-  template <typename D>
-  std::variant<opt_input_t<int64_t>, opt_input_t<double>,
-               opt_input_t<std::string>>
-  create_opt_input_t(const D& descriptor);
+  template <typename T>
+  fx::result::Result<T> convert_token(std::string_view token);
 
-  lyra::cli create_lyra_cli(
-      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
-      named_opt_value_t& values);
+  template <typename T, typename C>
+  bool is_choice(const C& choices, const T& value);
 
   nlohmann::json values_to_json(const named_opt_value_t& values);
 }  // namespace fx::argparse::converter
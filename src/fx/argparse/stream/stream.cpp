@@ -0,0 +1,242 @@
+#include "stream.hpp"
+#include <fcntl.h>
+#include <fmt/core.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+
+namespace fx::argparse::stream {
+  namespace {
+    constexpr size_t read_chunk_size = 64 * 1024;
+
+    // Blank lines and carriage returns are noise in newline separated input,
+    // while NUL separated input is exact.
+    bool keep(std::string_view& token, char separator) {
+      if (separator != '\n') {
+        return true;
+      }
+      if (!token.empty() && token.back() == '\r') {
+        token.remove_suffix(1);
+      }
+      return !token.empty();
+    }
+
+    char detect_separator(const char* data, size_t size) {
+      return std::memchr(data, '\0', size) != nullptr ? '\0' : '\n';
+    }
+  }  // namespace
+
+  TokenStream::TokenStream(fx::util::arguments_t arguments,
+                           int stdin_fd)
+      : _arguments(arguments), _stdin_fd(stdin_fd) {}
+
+  TokenStream::~TokenStream() {
+    close_mapping();
+    close_reader();
+  }
+
+  fx::result::Result<std::optional<std::string_view>> TokenStream::next() {
+    for (;;) {
+      if (_mapping != nullptr) {
+        if (const auto token = next_mapped(); token.has_value()) {
+          return fx::result::Ok(token);
+        }
+        close_mapping();
+        continue;
+      }
+
+      if (_reader_fd != -1) {
+        auto token = next_read();
+        if (token.failed() || token.value().has_value()) {
+          return token;
+        }
+        close_reader();
+        continue;
+      }
+
+      if (_next_argument == _arguments.size()) {
+        return fx::result::Ok(std::optional<std::string_view>());
+      }
+
+      const auto argument = _arguments[_next_argument++];
+      if (argument == args_from_stdin) {
+        if (!_stdin_consumed) {
+          _stdin_consumed = true;
+          _reader_fd = _stdin_fd;
+          _owns_reader_fd = false;
+          _reader_name = "stdin";
+        }
+        continue;
+      }
+
+      if (argument.size() > 1 && argument[0] == '@') {
+        if (argument[1] == '@') {
+          return fx::result::Ok(std::optional(argument.substr(1)));
+        }
+        if (auto open_result =
+                open_response_file(std::string(argument.substr(1)));
+            open_result.failed()) {
+          return fx::result::Error(std::move(open_result).error());
+        }
+        continue;
+      }
+
+      return fx::result::Ok(std::optional(argument));
+    }
+  }
+
+  fx::result::Result<void> TokenStream::open_response_file(
+      const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      return fx::result::Error(
+          fmt::format("Unable to read arguments from {0}: {1}.", path,
+                      std::strerror(errno)));
+    }
+
+    struct stat status;
+    const int error = fstat(fd, &status) != 0 ? errno
+                      : S_ISDIR(status.st_mode) ? EISDIR
+                                                : 0;
+    if (error != 0) {
+      close(fd);
+      return fx::result::Error(
+          fmt::format("Unable to read arguments from {0}: {1}.", path,
+                      std::strerror(error)));
+    }
+
+    if (S_ISREG(status.st_mode)) {
+      const auto size = static_cast<size_t>(status.st_size);
+      void* data = size == 0 ? MAP_FAILED
+                             : mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+                                    fd, 0);
+      if (data != MAP_FAILED) {
+        close(fd);
+        _mapping = static_cast<char*>(data);
+        _mapping_size = size;
+        _mapping_offset = 0;
+        _mapping_separator = detect_separator(_mapping, size);
+        return fx::result::Ok();
+      }
+    }
+
+    // Pipes, devices and files that cannot be mapped are read in chunks.
+    _reader_fd = fd;
+    _owns_reader_fd = true;
+    _reader_name = path;
+    return fx::result::Ok();
+  }
+
+  std::optional<std::string_view> TokenStream::next_mapped() {
+    while (_mapping_offset < _mapping_size) {
+      const char* begin = _mapping + _mapping_offset;
+      const size_t remaining = _mapping_size - _mapping_offset;
+      const auto* separator = static_cast<const char*>(
+          std::memchr(begin, _mapping_separator, remaining));
+      const size_t length =
+          separator != nullptr ? static_cast<size_t>(separator - begin)
+                               : remaining;
+      _mapping_offset += length + (separator != nullptr ? 1 : 0);
+
+      std::string_view token(begin, length);
+      if (keep(token, _mapping_separator)) {
+        return token;
+      }
+    }
+    return std::nullopt;
+  }
+
+  fx::result::Result<std::optional<std::string_view>> TokenStream::next_read() {
+    if (_carry_returned) {
+      _carry.clear();
+      _carry_returned = false;
+    }
+
+    for (;;) {
+      if (_buffer_offset < _buffer_size) {
+        const char* begin = _buffer.data() + _buffer_offset;
+        const size_t remaining = _buffer_size - _buffer_offset;
+        const auto* separator = static_cast<const char*>(
+            std::memchr(begin, _reader_separator, remaining));
+        if (separator == nullptr) {
+          // The token continues in the next read.
+          _carry.append(begin, remaining);
+          _buffer_offset = _buffer_size;
+          continue;
+        }
+
+        const size_t length = static_cast<size_t>(separator - begin);
+        _buffer_offset += length + 1;
+        std::string_view token(begin, length);
+        if (!_carry.empty()) {
+          _carry.append(begin, length);
+          token = _carry;
+          _carry_returned = true;
+        }
+        if (keep(token, _reader_separator)) {
+          return fx::result::Ok(std::optional(token));
+        }
+        _carry.clear();
+        _carry_returned = false;
+        continue;
+      }
+
+      if (_reader_eof) {
+        std::string_view token(_carry);
+        _carry_returned = true;
+        if (!token.empty() && keep(token, _reader_separator)) {
+          return fx::result::Ok(std::optional(token));
+        }
+        return fx::result::Ok(std::optional<std::string_view>());
+      }
+
+      if (_buffer.empty()) {
+        _buffer.resize(read_chunk_size);
+      }
+      const auto count = read(_reader_fd, _buffer.data(), _buffer.size());
+      if (count == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return fx::result::Error(
+            fmt::format("Unable to read arguments from {0}: {1}.",
+                        _reader_name, std::strerror(errno)));
+      }
+      if (count == 0) {
+        _reader_eof = true;
+        continue;
+      }
+
+      if (!_reader_started) {
+        // Decided once per input, from the first chunk.
+        _reader_started = true;
+        _reader_separator =
+            detect_separator(_buffer.data(), static_cast<size_t>(count));
+      }
+      _buffer_offset = 0;
+      _buffer_size = static_cast<size_t>(count);
+    }
+  }
+
+  void TokenStream::close_mapping() {
+    if (_mapping != nullptr) {
+      munmap(_mapping, _mapping_size);
+      _mapping = nullptr;
+    }
+  }
+
+  void TokenStream::close_reader() {
+    if (_reader_fd != -1 && _owns_reader_fd) {
+      close(_reader_fd);
+    }
+    _reader_fd = -1;
+    _owns_reader_fd = false;
+    _reader_started = false;
+    _reader_eof = false;
+    _buffer_offset = 0;
+    _buffer_size = 0;
+    _carry.clear();
+    _carry_returned = false;
+  }
+}  // namespace fx::argparse::stream
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <unistd.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "fx/result/result.hpp"
+#include "fx/util/util.hpp"
+
+namespace fx::argparse::stream {
+  // Reads arguments one token at a time, expanding "@path" response files and
+  // "--args-from-stdin" in place so huge argument lists never exist as a
+  // vector of strings.
+  //
+  // Regular files are mapped, anything else (stdin, pipes such as
+  // @<(git diff --name-only)) is read in chunks. Input is split on NUL when it
+  // contains one, otherwise on newlines, skipping blank lines. Tokens read
+  // from input are taken literally. "@@" stands for a literal "@", so
+  // "@@path" is the token "@path", and "@path" naming a file that cannot be
+  // read is an error.
+  class TokenStream {
+   public:
+    static constexpr std::string_view args_from_stdin = "--args-from-stdin";
+
+    explicit TokenStream(fx::util::arguments_t arguments,
+                         int stdin_fd = STDIN_FILENO);
+
+    ~TokenStream();
+
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+
+    // The next token, or nullopt once every source is exhausted. A token stays
+    // valid until the following call.
+    fx::result::Result<std::optional<std::string_view>> next();
+
+   private:
+    fx::result::Result<void> open_response_file(const std::string& path);
+
+    std::optional<std::string_view> next_mapped();
+
+    fx::result::Result<std::optional<std::string_view>> next_read();
+
+    void close_mapping();
+
+    void close_reader();
+
+    fx::util::arguments_t _arguments;
+    size_t _next_argument = 0;
+    int _stdin_fd;
+    bool _stdin_consumed = false;
+
+    // The response file currently being mapped, if any.
+    char* _mapping = nullptr;
+    size_t _mapping_size = 0;
+    size_t _mapping_offset = 0;
+    char _mapping_separator = '\n';
+
+    // The descriptor currently being read in chunks, if any.
+    int _reader_fd = -1;
+    bool _owns_reader_fd = false;
+    std::string _reader_name;
+    bool _reader_started = false;
+    bool _reader_eof = false;
+    char _reader_separator = '\n';
+    std::vector<char> _buffer;
+    size_t _buffer_offset = 0;
+    size_t _buffer_size = 0;
+    // A token split across reads, and whether it was returned last call.
+    std::string _carry;
+    bool _carry_returned = false;
+  };
+}  // namespace fx::argparse::stream
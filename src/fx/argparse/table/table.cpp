@@ -0,0 +1,274 @@
+#include "table.hpp"
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fx::argparse::table {
+  namespace {
+    // Upper bound on the seeds tried per bucket before growing the table.
+    constexpr uint32_t max_seed = 1 << 16;
+
+    // Below this many choices a binary search beats hashing the value.
+    constexpr int min_indexed_choices = 16;
+
+    uint64_t hash_key(std::string_view key) {
+      uint64_t hash = 14695981039346656037ULL;
+      for (const unsigned char character : key) {
+        hash ^= character;
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    uint64_t mix(uint64_t hash, uint32_t seed) {
+      hash ^= seed * 0x9e3779b97f4a7c15ULL;
+      hash ^= hash >> 33;
+      hash *= 0xff51afd7ed558ccdULL;
+      hash ^= hash >> 33;
+      hash *= 0xc4ceb9fe1a85ec53ULL;
+      hash ^= hash >> 33;
+      return hash;
+    }
+
+    bool matches(const fx::argparse::v1beta::InputSpec& spec,
+                 std::string_view key) {
+      if (key.size() > 2 && key.substr(0, 2) == "--") {
+        return key.substr(2) == spec.name();
+      }
+      return key.size() > 1 && key[0] == '-' && !spec.short_name().empty() &&
+             key.substr(1) == spec.short_name();
+    }
+
+    // Hash-and-displace: keys are split into buckets by their unseeded hash
+    // and each bucket searches for a seed that sends all of its keys to free
+    // slots. Fills `slots` with the key index per slot, or -1 when empty.
+    bool build_perfect_hash(const std::vector<std::string_view>& keys,
+                            size_t slot_count, std::vector<uint32_t>& seeds,
+                            std::vector<int64_t>& slots) {
+      const size_t bucket_count = keys.size();
+      std::vector<uint64_t> hashes(keys.size());
+      std::vector<std::vector<size_t>> buckets(bucket_count);
+      for (size_t key = 0; key < keys.size(); key++) {
+        hashes[key] = hash_key(keys[key]);
+        buckets[mix(hashes[key], 0) % bucket_count].push_back(key);
+      }
+
+      // Place the largest buckets first while most slots are still free.
+      std::vector<size_t> order(bucket_count);
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&](size_t left,
+                                                       size_t right) {
+        return buckets[left].size() > buckets[right].size();
+      });
+
+      seeds.assign(bucket_count, 0);
+      slots.assign(slot_count, -1);
+      std::vector<size_t> candidate;
+      for (const auto bucket : order) {
+        if (buckets[bucket].empty()) {
+          break;
+        }
+
+        bool placed = false;
+        for (uint32_t seed = 1; seed < max_seed && !placed; seed++) {
+          candidate.clear();
+          placed = true;
+          for (const auto key : buckets[bucket]) {
+            const size_t slot = mix(hashes[key], seed) % slot_count;
+            if (slots[slot] != -1 ||
+                std::find(candidate.begin(), candidate.end(), slot) !=
+                    candidate.end()) {
+              placed = false;
+              break;
+            }
+            candidate.push_back(slot);
+          }
+
+          if (placed) {
+            seeds[bucket] = seed;
+            for (size_t i = 0; i < candidate.size(); i++) {
+              slots[candidate[i]] = static_cast<int64_t>(buckets[bucket][i]);
+            }
+          }
+        }
+
+        if (!placed) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // A minimal table almost always works; spare slots make the rare failure
+    // cheap to recover from. Returns false when every size failed.
+    bool find_perfect_hash(const std::vector<std::string_view>& keys,
+                           std::vector<uint32_t>& seeds,
+                           std::vector<int64_t>& slots) {
+      for (size_t slot_count = keys.size(); slot_count <= keys.size() * 4;
+           slot_count *= 2) {
+        if (build_perfect_hash(keys, slot_count, seeds, slots)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    template <typename S>
+    size_t perfect_hash_slot(const S& seeds, size_t slot_count,
+                             std::string_view key) {
+      const uint64_t hash = hash_key(key);
+      const uint32_t seed =
+          seeds[static_cast<int>(mix(hash, 0) % seeds.size())];
+      return mix(hash, seed) % slot_count;
+    }
+  }  // namespace
+
+  fx::argparse::v1beta::ParseTable compile(
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor) {
+    fx::argparse::v1beta::ParseTable table;
+
+    for (const auto& option : descriptor.options()) {
+      auto& spec = *table.add_options();
+      compile_input(option, spec);
+      spec.set_short_name(option.short_name());
+    }
+    compile_option_index(table);
+
+    for (const auto& argument : descriptor.arguments()) {
+      compile_input(argument, *table.add_arguments());
+    }
+
+    return table;
+  }
+
+  void compile_option_index(fx::argparse::v1beta::ParseTable& table) {
+    std::vector<std::string> names;
+    std::vector<uint32_t> options;
+    for (int option = 0; option < table.options_size(); option++) {
+      const auto& spec = table.options(option);
+      names.emplace_back("--" + spec.name());
+      options.push_back(option);
+      if (!spec.short_name().empty()) {
+        names.emplace_back("-" + spec.short_name());
+        options.push_back(option);
+      }
+    }
+
+    auto& index = *table.mutable_option_index();
+    index.Clear();
+    std::vector<uint32_t> seeds;
+    std::vector<int64_t> slots;
+    if (names.empty() ||
+        !find_perfect_hash({names.begin(), names.end()}, seeds, slots)) {
+      return;
+    }
+
+    index.mutable_seeds()->Add(seeds.begin(), seeds.end());
+    for (const auto key : slots) {
+      if (key == -1) {
+        index.add_keys();
+        index.add_options(0);
+      } else {
+        index.add_keys(names[key]);
+        index.add_options(options[key]);
+      }
+    }
+  }
+
+  void compile_choice_index(fx::argparse::v1beta::InputSpec& spec) {
+    auto& index = *spec.mutable_string_choice_index();
+    index.Clear();
+    if (spec.string_choices_size() < min_indexed_choices) {
+      return;
+    }
+
+    const std::vector<std::string_view> choices(spec.string_choices().begin(),
+                                                spec.string_choices().end());
+    std::vector<uint32_t> seeds;
+    std::vector<int64_t> slots;
+    if (!find_perfect_hash(choices, seeds, slots)) {
+      return;
+    }
+
+    index.mutable_seeds()->Add(seeds.begin(), seeds.end());
+    for (const auto choice : slots) {
+      index.add_slots(static_cast<uint32_t>(choice + 1));
+    }
+  }
+
+  std::optional<uint32_t> find_option(
+      const fx::argparse::v1beta::ParseTable& table, std::string_view key) {
+    const auto& index = table.option_index();
+    if (index.keys().empty()) {
+      for (int option = 0; option < table.options_size(); option++) {
+        if (matches(table.options(option), key)) {
+          return static_cast<uint32_t>(option);
+        }
+      }
+      return std::nullopt;
+    }
+
+    const auto slot = static_cast<int>(
+        perfect_hash_slot(index.seeds(), index.keys_size(), key));
+    if (index.keys(slot) != key) {
+      return std::nullopt;
+    }
+    return index.options(slot);
+  }
+
+  bool is_string_choice(const fx::argparse::v1beta::InputSpec& spec,
+                        std::string_view value) {
+    const auto& index = spec.string_choice_index();
+    if (index.slots().empty()) {
+      return std::binary_search(spec.string_choices().begin(),
+                                spec.string_choices().end(), value);
+    }
+
+    const auto choice = index.slots(static_cast<int>(
+        perfect_hash_slot(index.seeds(), index.slots_size(), value)));
+    return choice != 0 &&
+           spec.string_choices(static_cast<int>(choice - 1)) == value;
+  }
+
+  template <typename D>
+  void compile_input(const D& descriptor,
+                     fx::argparse::v1beta::InputSpec& spec) {
+    spec.set_name(descriptor.name());
+
+    if (descriptor.has_int_value()) {
+      const auto& value = descriptor.int_value();
+      spec.set_type(fx::argparse::v1beta::InputSpec::TYPE_INT);
+      spec.set_required(value.required());
+      spec.set_list(value.list());
+      spec.set_int_default(value.default_());
+      compile_choices(value, *spec.mutable_int_choices());
+    } else if (descriptor.has_double_value()) {
+      const auto& value = descriptor.double_value();
+      spec.set_type(fx::argparse::v1beta::InputSpec::TYPE_DOUBLE);
+      spec.set_required(value.required());
+      spec.set_list(value.list());
+      spec.set_double_default(value.default_());
+      compile_choices(value, *spec.mutable_double_choices());
+    } else if (descriptor.has_string_value()) {
+      const auto& value = descriptor.string_value();
+      spec.set_type(fx::argparse::v1beta::InputSpec::TYPE_STRING);
+      spec.set_required(value.required());
+      spec.set_list(value.list());
+      spec.set_string_default(value.default_());
+      compile_choices(value, *spec.mutable_string_choices());
+      compile_choice_index(spec);
+    } else {
+      spec.set_type(fx::argparse::v1beta::InputSpec::TYPE_BOOL);
+    }
+  }
+
+  template <typename V, typename C>
+  void compile_choices(const V& value, C& choices) {
+    choices = value.choices();
+    std::sort(choices.begin(), choices.end());
+    choices.erase(std::unique(choices.begin(), choices.end()), choices.end());
+  }
+}  // namespace fx::argparse::table
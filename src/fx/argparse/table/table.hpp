@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include "fx/argparse/v1beta/table.pb.h"
+#include "fx/descriptor/v1beta/descriptor.pb.h"
+
+namespace fx::argparse::table {
+  fx::argparse::v1beta::ParseTable compile(
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor);
+
+  // Builds table.option_index over the options already in the table. When no
+  // perfect hash can be found the index is left empty and lookups scan.
+  void compile_option_index(fx::argparse::v1beta::ParseTable& table);
+
+  // Builds spec.string_choice_index over the sorted string choices. Small
+  // sets are left unindexed and searched instead.
+  void compile_choice_index(fx::argparse::v1beta::InputSpec& spec);
+
+  // Index into table.options() of "--name" or "-short_name".
+  std::optional<uint32_t> find_option(
+      const fx::argparse::v1beta::ParseTable& table, std::string_view key);
+
+  bool is_string_choice(const fx::argparse::v1beta::InputSpec& spec,
+                        std::string_view value);
+
+  template <typename D>
+  void compile_input(const D& descriptor,
+                     fx::argparse::v1beta::InputSpec& spec);
+
+  template <typename V, typename C>
+  void compile_choices(const V& value, C& choices);
+}  // namespace fx::argparse::table
@@ -0,0 +1,283 @@
+#include "cache.hpp"
+#include <fmt/core.h>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include "fx/argparse/table/table.hpp"
+#include "fx/embedded/embedded.hpp"
+#include "fx/log/log.hpp"
+#include "fx/parser/parser.hpp"
+#include "fx/suggest/suggest.hpp"
+#include "fx/util/util.hpp"
+
+namespace fx::cache {
+  namespace {
+    // Terminal widths differ between windows, but rarely by much.
+    const int MAX_HELP_PAGES = 4;
+
+    // Bump whenever a cached message, or one it embeds, changes. Development
+    // builds all share an FX_VERSION, so it alone does not tell them apart.
+    const uint32_t SCHEMA_VERSION = 1;
+
+    uint64_t fnv1a(const std::string& value) {
+      uint64_t hash = 14695981039346656037ULL;
+      for (const unsigned char character : value) {
+        hash ^= character;
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    struct stamp_t {
+      int64_t mtime;
+      uint64_t size;
+    };
+
+    std::optional<stamp_t> stamp(const std::filesystem::path& path) {
+      std::error_code error;
+      const auto mtime = std::filesystem::last_write_time(path, error);
+      if (error) {
+        return std::nullopt;
+      }
+      const auto size = std::filesystem::file_size(path, error);
+      if (error) {
+        return std::nullopt;
+      }
+      return stamp_t{
+          static_cast<int64_t>(mtime.time_since_epoch().count()),
+          static_cast<uint64_t>(size)};
+    }
+
+    template <typename E>
+    bool is_fresh(const E& entry, const std::string& descriptor_path,
+                  const stamp_t& stamp) {
+      return entry.fx_version() == fmt::format("{0}", FX_VERSION) &&
+             entry.schema_version() == SCHEMA_VERSION &&
+             entry.descriptor_path() == descriptor_path &&
+             entry.descriptor_mtime() == stamp.mtime &&
+             entry.descriptor_size() == stamp.size;
+    }
+
+    std::filesystem::path entry_path(
+        const std::filesystem::path& cache_directory, const std::string& kind,
+        const std::filesystem::path& descriptor_path) {
+      return cache_directory / kind /
+             fmt::format("{0:016x}.binpb", fnv1a(descriptor_path.u8string()));
+    }
+
+    // Loads the entry for the descriptor at `descriptor_path` from
+    // `cache_directory/kind`, or calls `parse(absolute_path, entry)` and
+    // stores the result.
+    template <typename E, typename F>
+    fx::result::Result<E> load(const std::filesystem::path& descriptor_path,
+                               const std::filesystem::path& cache_directory,
+                               const std::string& kind, F parse) {
+      std::error_code error;
+      auto absolute_path = std::filesystem::absolute(descriptor_path, error);
+      if (error) {
+        absolute_path = descriptor_path;
+      }
+      const auto absolute_string = absolute_path.u8string();
+      const auto descriptor_stamp = stamp(absolute_path);
+      const auto path = cache_directory.empty()
+                            ? std::filesystem::path()
+                            : entry_path(cache_directory, kind, absolute_path);
+
+      E entry;
+      if (descriptor_stamp.has_value() && !path.empty()) {
+        std::ifstream input(path, std::ios::binary);
+        if (input && entry.ParseFromIstream(&input) &&
+            is_fresh(entry, absolute_string, *descriptor_stamp)) {
+          FX_LOG_DEBUG("Using cached descriptor {0}", path.u8string());
+          return fx::result::Ok(std::move(entry));
+        }
+        entry.Clear();
+      }
+
+      auto parse_result = parse(absolute_path, entry);
+      if (parse_result.failed()) {
+        return fx::result::Error(std::move(parse_result).error());
+      }
+
+      if (descriptor_stamp.has_value() && !path.empty()) {
+        entry.set_fx_version(fmt::format("{0}", FX_VERSION));
+        entry.set_schema_version(SCHEMA_VERSION);
+        entry.set_descriptor_path(absolute_string);
+        entry.set_descriptor_mtime(descriptor_stamp->mtime);
+        entry.set_descriptor_size(descriptor_stamp->size);
+        store(path, entry);
+      }
+
+      return fx::result::Ok(std::move(entry));
+    }
+  }  // namespace
+
+  std::filesystem::path directory() {
+    if (const char* fx_cache_dir = std::getenv("FX_CACHE_DIR");
+        fx_cache_dir != nullptr) {
+      return std::filesystem::path(fx_cache_dir);
+    }
+    if (const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME");
+        xdg_cache_home != nullptr && *xdg_cache_home != '\0') {
+      return std::filesystem::path(xdg_cache_home) / "fx";
+    }
+    if (const char* home = std::getenv("HOME");
+        home != nullptr && *home != '\0') {
+      return std::filesystem::path(home) / ".cache" / "fx";
+    }
+    return std::filesystem::path();
+  }
+
+  std::filesystem::path command_entry_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& descriptor_path) {
+    return entry_path(cache_directory, "commands", descriptor_path);
+  }
+
+  std::filesystem::path workspace_entry_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& descriptor_path) {
+    return entry_path(cache_directory, "workspaces", descriptor_path);
+  }
+
+  std::filesystem::path command_index_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& workspace_descriptor_path) {
+    return entry_path(cache_directory, "indexes", workspace_descriptor_path);
+  }
+
+  void store(const std::filesystem::path& entry_path,
+             const google::protobuf::MessageLite& entry) {
+    std::error_code error;
+    std::filesystem::create_directories(entry_path.parent_path(), error);
+    if (error) {
+      FX_LOG_DEBUG("Unable to create cache directory: {0}", error.message());
+      return;
+    }
+
+    // Concurrent invocations never read a partially written entry.
+    if (const auto result =
+            fx::util::write_atomically(entry_path, entry.SerializeAsString());
+        result.failed()) {
+      FX_LOG_DEBUG("Unable to store cache entry: {0}", result.error());
+    }
+  }
+
+  fx::result::Result<fx::cache::v1beta::CommandCacheEntry> load_command(
+      const std::filesystem::path& descriptor_path) {
+    return load_command(descriptor_path, directory());
+  }
+
+  fx::result::Result<fx::cache::v1beta::CommandCacheEntry> load_command(
+      const std::filesystem::path& descriptor_path,
+      const std::filesystem::path& cache_directory) {
+    return load<fx::cache::v1beta::CommandCacheEntry>(
+        descriptor_path, cache_directory, "commands",
+        [](const std::filesystem::path& path,
+           fx::cache::v1beta::CommandCacheEntry& entry)
+            -> fx::result::Result<void> {
+          auto descriptor_result = fx::parser::parse_descriptor_into(
+              path, entry.mutable_command_descriptor());
+          if (descriptor_result.failed()) {
+            return fx::result::Error(std::move(descriptor_result).error());
+          }
+          *entry.mutable_parse_table() =
+              fx::argparse::table::compile(entry.command_descriptor());
+          return fx::result::Ok();
+        });
+  }
+
+  std::string load_help_page(const std::filesystem::path& descriptor_path,
+                             const std::filesystem::path& cache_directory,
+                             const std::string& command_name, uint32_t width,
+                             const std::function<std::string()>& render) {
+    auto entry_result = load_command(descriptor_path, cache_directory);
+    if (entry_result.failed() || cache_directory.empty()) {
+      return render();
+    }
+    auto entry = std::move(entry_result).take();
+    for (const auto& help_page : entry.help_pages()) {
+      if (help_page.width() == width &&
+          help_page.command_name() == command_name) {
+        return help_page.page();
+      }
+    }
+
+    auto page = render();
+    // Entries without a version were not stored, i.e. the descriptor could
+    // not be stat'ed.
+    if (!entry.fx_version().empty()) {
+      auto* help_pages = entry.mutable_help_pages();
+      if (help_pages->size() >= MAX_HELP_PAGES) {
+        help_pages->DeleteSubrange(0, 1);
+      }
+      auto* help_page = help_pages->Add();
+      help_page->set_width(width);
+      help_page->set_command_name(command_name);
+      help_page->set_page(page);
+      store(command_entry_path(cache_directory, entry.descriptor_path()),
+            entry);
+    }
+    return page;
+  }
+
+  fx::result::Result<fx::cache::v1beta::WorkspaceCacheEntry> load_workspace(
+      const std::filesystem::path& descriptor_path) {
+    if (const auto* embedded = fx::embedded::workspace(); embedded != nullptr) {
+      return fx::result::Ok(fx::embedded::load(*embedded));
+    }
+    return load_workspace(descriptor_path, directory());
+  }
+
+  fx::result::Result<fx::cache::v1beta::WorkspaceCacheEntry> load_workspace(
+      const std::filesystem::path& descriptor_path,
+      const std::filesystem::path& cache_directory) {
+    return load<fx::cache::v1beta::WorkspaceCacheEntry>(
+        descriptor_path, cache_directory, "workspaces",
+        [](const std::filesystem::path& path,
+           fx::cache::v1beta::WorkspaceCacheEntry& entry)
+            -> fx::result::Result<void> {
+          auto descriptor_result = fx::parser::parse_descriptor_into(
+              path, entry.mutable_workspace_descriptor());
+          if (descriptor_result.failed()) {
+            return fx::result::Error(std::move(descriptor_result).error());
+          }
+          return fx::result::Ok();
+        });
+  }
+
+  std::optional<fx::cache::v1beta::CommandIndexEntry> load_command_index(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::filesystem::path& cache_directory) {
+    if (cache_directory.empty()) {
+      return std::nullopt;
+    }
+    std::ifstream input(
+        command_index_path(cache_directory, workspace_descriptor_path),
+        std::ios::binary);
+    fx::cache::v1beta::CommandIndexEntry entry;
+    if (!input || !entry.ParseFromIstream(&input) ||
+        entry.fx_version() != fmt::format("{0}", FX_VERSION) ||
+        entry.schema_version() != SCHEMA_VERSION ||
+        entry.workspace_path() != workspace_descriptor_path.u8string()) {
+      return std::nullopt;
+    }
+    return entry;
+  }
+
+  fx::cache::v1beta::CommandIndexEntry store_command_index(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::filesystem::path& cache_directory,
+      std::vector<std::string> command_names) {
+    fx::cache::v1beta::CommandIndexEntry entry;
+    entry.set_fx_version(fmt::format("{0}", FX_VERSION));
+    entry.set_schema_version(SCHEMA_VERSION);
+    entry.set_workspace_path(workspace_descriptor_path.u8string());
+    *entry.mutable_trie() = fx::suggest::build(std::move(command_names));
+    if (!cache_directory.empty()) {
+      store(command_index_path(cache_directory, workspace_descriptor_path),
+            entry);
+    }
+    return entry;
+  }
+}  // namespace fx::cache
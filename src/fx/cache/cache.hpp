@@ -0,0 +1,75 @@
+#pragma once
+
+#include <google/protobuf/message_lite.h>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "fx/cache/v1beta/cache.pb.h"
+#include "fx/result/result.hpp"
+
+// Precompiled command and workspace descriptors. Parsing YAML, converting it to
+// JSON and validating it dominates the cost of a forwarded command, so the
+// result is stored as a binary protobuf, next to the compiled argument parse
+// table for commands.
+namespace fx::cache {
+  // $FX_CACHE_DIR, else $XDG_CACHE_HOME/fx, else $HOME/.cache/fx. Empty when
+  // none of these are set, which disables the cache.
+  std::filesystem::path directory();
+
+  std::filesystem::path command_entry_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& descriptor_path);
+
+  std::filesystem::path workspace_entry_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& descriptor_path);
+
+  std::filesystem::path command_index_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& workspace_descriptor_path);
+
+  // Atomically replaces the entry at `entry_path`, creating its directory.
+  // Failures are only logged.
+  void store(const std::filesystem::path& entry_path,
+             const google::protobuf::MessageLite& entry);
+
+  // Returns the cached entry for the command descriptor at `descriptor_path`,
+  // parsing and storing it when the entry is missing or stale. Failing to read
+  // or write the cache is never an error; only parse failures are.
+  fx::result::Result<fx::cache::v1beta::CommandCacheEntry> load_command(
+      const std::filesystem::path& descriptor_path);
+
+  fx::result::Result<fx::cache::v1beta::CommandCacheEntry> load_command(
+      const std::filesystem::path& descriptor_path,
+      const std::filesystem::path& cache_directory);
+
+  // The --help page of the command at `descriptor_path` as `command_name` at
+  // `width` columns, calling `render` and storing the page on a miss.
+  std::string load_help_page(const std::filesystem::path& descriptor_path,
+                             const std::filesystem::path& cache_directory,
+                             const std::string& command_name, uint32_t width,
+                             const std::function<std::string()>& render);
+
+  // Binaries with embedded descriptors return their workspace instead.
+  fx::result::Result<fx::cache::v1beta::WorkspaceCacheEntry> load_workspace(
+      const std::filesystem::path& descriptor_path);
+
+  fx::result::Result<fx::cache::v1beta::WorkspaceCacheEntry> load_workspace(
+      const std::filesystem::path& descriptor_path,
+      const std::filesystem::path& cache_directory);
+
+  // The stored index of the workspace's command names, unless it is missing
+  // or was stored by another fx version.
+  std::optional<fx::cache::v1beta::CommandIndexEntry> load_command_index(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::filesystem::path& cache_directory);
+
+  // Indexes the workspace's command names and stores the index.
+  fx::cache::v1beta::CommandIndexEntry store_command_index(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::filesystem::path& cache_directory,
+      std::vector<std::string> command_names);
+}  // namespace fx::cache
@@ -1,15 +1,13 @@
 #pragma once
 
-#include <string>
-#include <vector>
 #include "fx/result/result.hpp"
+#include "fx/util/util.hpp"
 
 namespace fx::command {
   class Base {
    public:
     Base();
     virtual ~Base() = 0;
-    virtual fx::result::Result<void> run(
-        const std::vector<std::string>& arguments) = 0;
+    virtual fx::result::Result<void> run(fx::util::arguments_t arguments) = 0;
   };
 }  // namespace fx::command
@@ -0,0 +1,310 @@
+#include "batch.hpp"
+#include <fmt/core.h>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include "fx/command/forwarder/forwarder.hpp"
+#include "fx/command/forwarder/pool/pool.hpp"
+#include "fx/history/history.hpp"
+#include "fx/metrics/metrics.hpp"
+#include "fx/util/util.hpp"
+
+namespace fx::command {
+  namespace {
+    const std::string_view whitespace = " \t\r\n";
+
+    struct invocation_t {
+      std::vector<std::string> words;
+      // Set when the invocation could not be resolved, it is not run then.
+      std::optional<std::string> error;
+      fx::history::entry_t history_entry;
+      fx::metrics::observation_t observation;
+    };
+
+    struct command_t {
+      std::unique_ptr<fx::command::Forwarder> forwarder;
+      fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor>
+          descriptor;
+      double parse_seconds;
+    };
+
+    void print(const nlohmann::json& result) {
+      // Output that is not valid UTF-8 is replaced rather than throwing.
+      fx::command::forwarder::pool::print(
+          result.dump(-1, ' ', false,
+                      nlohmann::json::error_handler_t::replace) +
+          "\n");
+    }
+  }  // namespace
+
+  Batch::Batch() : _input(std::cin) {}
+
+  Batch::Batch(std::istream& input) : _input(input) {}
+
+  fx::result::Result<void> Batch::run(fx::util::arguments_t arguments) {
+    const auto started = std::chrono::steady_clock::now();
+
+    unsigned jobs = fx::command::forwarder::pool::default_jobs();
+    char delimiter = '\n';
+    for (std::size_t index = 0; index < arguments.size(); index++) {
+      auto jobs_result = fx::command::forwarder::pool::parse_jobs_option(
+          arguments, index, jobs);
+      if (jobs_result.failed()) {
+        return fx::result::Error(std::move(jobs_result).error());
+      }
+      if (jobs_result.value()) {
+        continue;
+      }
+      const std::string_view argument = arguments[index];
+      if (argument != "-0" && argument != "--null") {
+        return fx::result::Error(
+            fmt::format("Unknown option \"{0}\".", argument));
+      }
+      delimiter = '\0';
+    }
+
+    // Read up front, so the commands never compete with fx for stdin.
+    const std::string input((std::istreambuf_iterator<char>(_input)),
+                            std::istreambuf_iterator<char>());
+    std::vector<invocation_t> invocations;
+    for (std::size_t begin = 0; begin < input.size();) {
+      auto end = input.find(delimiter, begin);
+      end = end == std::string::npos ? input.size() : end;
+      const std::string_view record(input.data() + begin, end - begin);
+      begin = end + 1;
+      if (record.find_first_not_of(whitespace) == std::string_view::npos) {
+        continue;
+      }
+
+      invocation_t invocation;
+      auto words_result = split_invocation(record);
+      if (words_result.failed()) {
+        invocation.words.emplace_back(record);
+        invocation.error = std::move(words_result).error();
+      } else {
+        invocation.words = std::move(words_result).take();
+      }
+      invocations.push_back(std::move(invocation));
+    }
+
+    auto workspace_result = fx::command::forwarder::pool::load_workspace();
+    if (workspace_result.failed()) {
+      return fx::result::Error(std::move(workspace_result).error());
+    }
+    const auto& shared = workspace_result.value();
+    const auto& workspace_path = shared.path;
+    const auto& workspace = shared.entry.workspace_descriptor();
+
+    std::map<std::string, command_t> commands;
+    std::vector<fx::command::forwarder::pool::task_t> tasks(
+        invocations.size());
+    std::vector<std::size_t> order;
+    for (std::size_t index = 0; index < invocations.size(); index++) {
+      auto& invocation = invocations[index];
+      if (invocation.error.has_value()) {
+        continue;
+      }
+      const std::string& command_name = invocation.words[0];
+
+      auto found = commands.find(command_name);
+      if (found == commands.end()) {
+        auto forwarder =
+            std::make_unique<fx::command::Forwarder>(command_name);
+        forwarder->configure(workspace);
+        const auto phase_started = std::chrono::steady_clock::now();
+        auto descriptor = forwarder->parse_command_descriptor(workspace_path);
+        const double parse_seconds =
+            shared.parse_seconds + fx::util::seconds_since(phase_started);
+        found = commands
+                    .emplace(command_name,
+                             command_t{std::move(forwarder),
+                                       std::move(descriptor), parse_seconds})
+                    .first;
+      }
+      command_t& command = found->second;
+      if (command.descriptor.failed()) {
+        invocation.error = command.descriptor.error();
+        continue;
+      }
+      const auto& descriptor = command.descriptor.value();
+      if (descriptor.runtime().has_plugin()) {
+        invocation.error = fmt::format(
+            "Plugin command \"{0}\" cannot be run by fx batch.", command_name);
+        continue;
+      }
+
+      std::vector<std::string_view> words(invocation.words.begin() + 1,
+                                          invocation.words.end());
+      const auto phase_started = std::chrono::steady_clock::now();
+      auto command_arguments_result =
+          command.forwarder->parse_command_arguments(descriptor, words);
+      if (command_arguments_result.failed()) {
+        invocation.error = std::move(command_arguments_result).error();
+        continue;
+      }
+      const auto& command_arguments = command_arguments_result.value();
+      if (command_arguments["help"]["value"]) {
+        invocation.error = "--help is not supported by fx batch.";
+        continue;
+      }
+
+      invocation.observation.workspace =
+          workspace_path.parent_path().u8string();
+      invocation.observation.command = command_name;
+      invocation.observation.seconds[fx::metrics::PHASE_DISCOVERY] =
+          shared.discovery_seconds;
+      invocation.observation.seconds[fx::metrics::PHASE_PARSE] =
+          command.parse_seconds;
+      invocation.observation.seconds[fx::metrics::PHASE_ARGPARSE] =
+          fx::util::seconds_since(phase_started);
+      invocation.history_entry.workspace_hash = shared.hash;
+      invocation.history_entry.command = command_name;
+      for (const auto& word : words) {
+        // A separator after each one keeps "a b" apart from "ab".
+        invocation.history_entry.arguments_hash = fx::history::hash(
+            std::string_view("\0", 1),
+            fx::history::hash(word, invocation.history_entry.arguments_hash));
+      }
+
+      auto execution_arguments_result =
+          command.forwarder->collate_execution_arguments(descriptor,
+                                                         command_arguments);
+      if (execution_arguments_result.failed()) {
+        invocation.error = std::move(execution_arguments_result).error();
+        continue;
+      }
+      tasks[index].arguments = std::move(execution_arguments_result).value();
+      tasks[index].environment =
+          command.forwarder->collate_enviornment_variables(descriptor,
+                                                           workspace_path);
+      order.push_back(index);
+    }
+
+    std::size_t failed = 0;
+    for (std::size_t index = 0; index < invocations.size(); index++) {
+      if (invocations[index].error.has_value()) {
+        failed++;
+        print({{"index", index},
+               {"invocation", invocations[index].words},
+               {"error", *invocations[index].error}});
+      }
+    }
+
+    const auto start = [&](std::size_t index) {
+      auto& entry = invocations[index].history_entry;
+      entry.timestamp_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count();
+      entry.fx_overhead_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - started)
+              .count();
+    };
+    const auto finish =
+        [&](std::size_t index,
+            const fx::command::forwarder::pool::outcome_t& outcome) {
+          auto& invocation = invocations[index];
+          print({{"index", index},
+                 {"invocation", invocation.words},
+                 {"exit_code", outcome.exit_code},
+                 {"signal", outcome.signal},
+                 {"wall_seconds", outcome.wall_seconds},
+                 {"max_rss_kib", outcome.max_rss_kib},
+                 {"output", outcome.output}});
+          const bool invocation_failed =
+              outcome.exit_code != 0 || outcome.signal != 0;
+          if (invocation_failed) {
+            failed++;
+          }
+
+          invocation.history_entry.child_wall_us =
+              static_cast<int64_t>(outcome.wall_seconds * 1e6);
+          invocation.history_entry.max_rss_kib = outcome.max_rss_kib;
+          invocation.history_entry.exit_code = outcome.exit_code;
+          invocation.history_entry.signal = outcome.signal;
+          fx::history::append(shared.history_path, invocation.history_entry);
+
+          invocation.observation.seconds[fx::metrics::PHASE_CHILD] =
+              outcome.wall_seconds;
+          invocation.observation.failed = invocation_failed;
+          fx::metrics::record(fx::metrics::table_path(shared.cache_directory),
+                              fx::metrics::export_path(),
+                              invocation.observation);
+        };
+
+    auto pool_result =
+        fx::command::forwarder::pool::run(tasks, order, jobs, start, finish);
+    if (pool_result.failed()) {
+      return fx::result::Error(std::move(pool_result).error());
+    }
+
+    if (failed > 0) {
+      return fx::result::Error(fmt::format("{0} of {1} invocations failed.",
+                                           failed, invocations.size()));
+    }
+    return fx::result::Ok();
+  }
+
+  fx::result::Result<std::vector<std::string>> split_invocation(
+      std::string_view invocation) {
+    std::vector<std::string> words;
+    std::string word;
+    bool in_word = false;
+    for (std::size_t index = 0; index < invocation.size(); index++) {
+      const char character = invocation[index];
+      if (whitespace.find(character) != std::string_view::npos) {
+        if (in_word) {
+          words.push_back(std::move(word));
+          word.clear();
+          in_word = false;
+        }
+        continue;
+      }
+
+      in_word = true;
+      if (character == '\\') {
+        if (++index == invocation.size()) {
+          return fx::result::Error(
+              fmt::format("Trailing backslash in \"{0}\".", invocation));
+        }
+        word += invocation[index];
+      } else if (character == '\'') {
+        const auto end = invocation.find('\'', index + 1);
+        if (end == std::string_view::npos) {
+          return fx::result::Error(
+              fmt::format("Unterminated quote in \"{0}\".", invocation));
+        }
+        word += invocation.substr(index + 1, end - index - 1);
+        index = end;
+      } else if (character == '"') {
+        for (index++;; index++) {
+          if (index == invocation.size()) {
+            return fx::result::Error(
+                fmt::format("Unterminated quote in \"{0}\".", invocation));
+          }
+          if (invocation[index] == '"') {
+            break;
+          }
+          // Like the shell, only these are escaped within double quotes.
+          if (invocation[index] == '\\' && index + 1 < invocation.size() &&
+              std::string_view("\"\\$`").find(invocation[index + 1]) !=
+                  std::string_view::npos) {
+            index++;
+          }
+          word += invocation[index];
+        }
+      } else {
+        word += character;
+      }
+    }
+    if (in_word) {
+      words.push_back(std::move(word));
+    }
+    return fx::result::Ok(std::move(words));
+  }
+}  // namespace fx::command
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "fx/command/base/base.hpp"
+#include "fx/result/result.hpp"
+
+namespace fx::command {
+  // Runs the invocations read from stdin, one per line, i.e. "format -l
+  // bazel", against a single snapshot of the workspace. Results are written
+  // to stdout as JSON lines in the order the commands exit.
+  class Batch : public fx::command::Base {
+   public:
+    Batch();
+    explicit Batch(std::istream& input);
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
+
+   private:
+    std::istream& _input;
+  };
+
+  // Splits an invocation into words like a POSIX shell without expansions:
+  // words are separated by whitespace, and quotes and backslashes escape.
+  fx::result::Result<std::vector<std::string>> split_invocation(
+      std::string_view invocation);
+}  // namespace fx::command
@@ -0,0 +1,186 @@
+#include "counters.hpp"
+#include <fmt/core.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace fx::command::forwarder::counters {
+  namespace {
+    double ratio(uint64_t numerator, uint64_t denominator) {
+      return denominator == 0
+                 ? 0
+                 : static_cast<double>(numerator) / denominator;
+    }
+
+#ifdef __linux__
+    struct event_t {
+      uint64_t config;
+      // Index of the group leader in the event list.
+      std::size_t leader;
+    };
+
+    const std::array<event_t, 6> events{{
+        {PERF_COUNT_HW_CPU_CYCLES, 0},
+        {PERF_COUNT_HW_INSTRUCTIONS, 0},
+        {PERF_COUNT_HW_BRANCH_INSTRUCTIONS, 0},
+        {PERF_COUNT_HW_BRANCH_MISSES, 0},
+        {PERF_COUNT_HW_CACHE_REFERENCES, 4},
+        {PERF_COUNT_HW_CACHE_MISSES, 4},
+    }};
+
+    int open_event(const event_t& event, int group) {
+      perf_event_attr attributes;
+      std::memset(&attributes, 0, sizeof(attributes));
+      attributes.size = sizeof(attributes);
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.config = event.config;
+      attributes.disabled = group == -1;
+      attributes.inherit = 1;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      // PERF_FORMAT_GROUP cannot be combined with inherit, so each counter is
+      // read on its own.
+      attributes.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return static_cast<int>(
+          syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0));
+    }
+
+    std::string paranoid_level() {
+      std::string level;
+      std::ifstream("/proc/sys/kernel/perf_event_paranoid") >> level;
+      return level.empty() ? "unknown" : level;
+    }
+#endif
+  }  // namespace
+
+  double sample_t::instructions_per_cycle() const {
+    return ratio(instructions, cycles);
+  }
+
+  double sample_t::branch_miss_rate() const {
+    return ratio(branch_misses, branches);
+  }
+
+  double sample_t::cache_miss_rate() const {
+    return ratio(cache_misses, cache_references);
+  }
+
+  Counters::Counters() {
+    _descriptors.fill(-1);
+#ifdef __linux__
+    for (std::size_t index = 0; index < events.size(); index++) {
+      const auto& event = events[index];
+      const int group =
+          event.leader == index ? -1 : _descriptors[event.leader];
+      _descriptors[index] = open_event(event, group);
+      if (_descriptors[index] < 0) {
+        const int error = errno;
+        if (error == EACCES || error == EPERM) {
+          _error = fmt::format("{0} (perf_event_paranoid is {1})",
+                               std::strerror(error), paranoid_level());
+        } else if (error == ENOENT || error == ENODEV || error == EOPNOTSUPP) {
+          // Typical of virtual machines and containers without a PMU.
+          _error = fmt::format("no hardware counters ({0})",
+                               std::strerror(error));
+        } else {
+          _error = std::strerror(error);
+        }
+        break;
+      }
+    }
+#else
+    _error = "not supported on this platform";
+#endif
+    if (!_error.empty()) {
+      for (int& descriptor : _descriptors) {
+        if (descriptor >= 0) {
+          close(descriptor);
+        }
+        descriptor = -1;
+      }
+    }
+  }
+
+  Counters::~Counters() {
+    for (const int descriptor : _descriptors) {
+      if (descriptor >= 0) {
+        close(descriptor);
+      }
+    }
+  }
+
+  bool Counters::available() const {
+    return _error.empty();
+  }
+
+  const std::string& Counters::error() const {
+    return _error;
+  }
+
+  void Counters::start() {
+#ifdef __linux__
+    if (!available()) {
+      return;
+    }
+    for (std::size_t index = 0; index < events.size(); index++) {
+      if (events[index].leader == index) {
+        ioctl(_descriptors[index], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(_descriptors[index], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      }
+    }
+#endif
+  }
+
+  void Counters::stop() {
+#ifdef __linux__
+    if (!available()) {
+      return;
+    }
+    for (std::size_t index = 0; index < events.size(); index++) {
+      if (events[index].leader == index) {
+        ioctl(_descriptors[index], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      }
+    }
+#endif
+  }
+
+  sample_t Counters::read() const {
+    sample_t sample;
+    if (!available()) {
+      return sample;
+    }
+
+    std::array<uint64_t, event_count> values{};
+    sample.coverage = 1;
+    for (std::size_t index = 0; index < event_count; index++) {
+      // value, time enabled, time running
+      uint64_t buffer[3] = {0, 0, 0};
+      if (::read(_descriptors[index], buffer, sizeof(buffer)) !=
+              sizeof(buffer) ||
+          buffer[2] == 0) {
+        sample.coverage = 0;
+        continue;
+      }
+      const double coverage = static_cast<double>(buffer[2]) / buffer[1];
+      values[index] = static_cast<uint64_t>(buffer[0] / coverage);
+      sample.coverage = std::min(sample.coverage, coverage);
+    }
+
+    sample.cycles = values[0];
+    sample.instructions = values[1];
+    sample.branches = values[2];
+    sample.branch_misses = values[3];
+    sample.cache_references = values[4];
+    sample.cache_misses = values[5];
+    return sample;
+  }
+}  // namespace fx::command::forwarder::counters
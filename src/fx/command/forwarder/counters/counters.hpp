@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Hardware performance counters (Linux perf_event_open) for fx and every
+// process it spawns while the counters run. Only user space is counted, which
+// perf_event_paranoid allows up to level 2.
+namespace fx::command::forwarder::counters {
+  struct sample_t {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t branches = 0;
+    uint64_t branch_misses = 0;
+    uint64_t cache_references = 0;
+    uint64_t cache_misses = 0;
+    // The lowest fraction of the run a counter was scheduled on the PMU.
+    // Counts are scaled up when it is below 1.
+    double coverage = 0;
+
+    double instructions_per_cycle() const;
+    double branch_miss_rate() const;
+    double cache_miss_rate() const;
+  };
+
+  class Counters {
+   public:
+    // Opens the counters disabled. When that fails, i.e. because of
+    // perf_event_paranoid, the counters are unavailable and error() says why.
+    Counters();
+
+    ~Counters();
+
+    Counters(const Counters&) = delete;
+    Counters& operator=(const Counters&) = delete;
+
+    bool available() const;
+
+    const std::string& error() const;
+
+    // Counts from zero until stop(), including processes spawned meanwhile.
+    // Their counts are added once they exit.
+    void start();
+
+    void stop();
+
+    sample_t read() const;
+
+   private:
+    // Cycles, instructions and branches are grouped so IPC and the branch
+    // miss rate come from the same time slices; the cache events form a
+    // second group since few PMUs can schedule all six at once.
+    static constexpr std::size_t event_count = 6;
+
+    std::array<int, event_count> _descriptors;
+    std::string _error;
+  };
+}  // namespace fx::command::forwarder::counters
@@ -0,0 +1,222 @@
+#include "exec.hpp"
+#include <fmt/core.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace fx::command::forwarder::exec {
+  static const std::size_t min_block_size = 4 * 1024;
+
+  // MAX_ARG_STRLEN, 32 pages of 4 KiB. Other systems only limit the total.
+#ifdef __linux__
+  static const std::size_t max_string_size = 32 * 4096;
+#else
+  static const std::size_t max_string_size = SIZE_MAX;
+#endif
+
+  namespace {
+    std::string_view variable_name(std::string_view entry) {
+      return entry.substr(0, entry.find('='));
+    }
+
+    bool matches(std::string_view name,
+                 const google::protobuf::RepeatedPtrField<std::string>&
+                     patterns) {
+      for (const auto& pattern : patterns) {
+        if (!pattern.empty() && pattern.back() == '*') {
+          const std::string_view prefix(pattern.data(), pattern.size() - 1);
+          if (name.substr(0, prefix.size()) == prefix) {
+            return true;
+          }
+        } else if (name == pattern) {
+          return true;
+        }
+      }
+      return false;
+    }
+  }  // namespace
+
+  CStringArray::CStringArray() : _pointers{nullptr} {}
+
+  void CStringArray::reserve(std::size_t count, std::size_t bytes) {
+    _pointers.reserve(_pointers.size() + count);
+    const std::size_t needed = bytes + count;
+    if (_block_size - _block_used < needed) {
+      _blocks.emplace_back(new char[needed]);
+      _block_used = 0;
+      _block_size = needed;
+    }
+  }
+
+  void CStringArray::push_back(std::string_view value) {
+    char* destination = allocate(value.size() + 1);
+    std::memcpy(destination, value.data(), value.size());
+    destination[value.size()] = '\0';
+    // Keep the trailing nullptr in place.
+    _pointers.back() = destination;
+    _pointers.push_back(nullptr);
+  }
+
+  void CStringArray::push_back_borrowed(char* value) {
+    _pointers.back() = value;
+    _pointers.push_back(nullptr);
+  }
+
+  std::size_t CStringArray::size() const {
+    return _pointers.size() - 1;
+  }
+
+  char* const* CStringArray::data() const {
+    return _pointers.data();
+  }
+
+  char* CStringArray::allocate(std::size_t bytes) {
+    if (_block_size - _block_used < bytes) {
+      const std::size_t size = std::max(bytes, min_block_size);
+      _blocks.emplace_back(new char[size]);
+      _block_used = 0;
+      _block_size = size;
+    }
+    char* result = _blocks.back().get() + _block_used;
+    _block_used += bytes;
+    return result;
+  }
+
+  CStringArray pack(const std::vector<std::string>& values) {
+    std::size_t bytes = 0;
+    for (const auto& value : values) {
+      bytes += value.size();
+    }
+
+    CStringArray array;
+    array.reserve(values.size(), bytes);
+    for (const auto& value : values) {
+      array.push_back(value);
+    }
+    return array;
+  }
+
+  CStringArray environment(
+      char* const* inherited,
+      const fx::descriptor::v1beta::EnvironmentDescriptor& descriptor,
+      const std::vector<std::string>& overrides) {
+    std::size_t count = overrides.size();
+    std::size_t bytes = 0;
+    for (const auto& entry : overrides) {
+      bytes += entry.size();
+    }
+    for (char* const* entry = inherited; *entry != nullptr; entry++) {
+      count++;
+    }
+
+    CStringArray array;
+    array.reserve(count, bytes);
+    for (const auto& entry : overrides) {
+      array.push_back(entry);
+    }
+
+    for (char* const* entry = inherited; *entry != nullptr; entry++) {
+      const auto name = variable_name(*entry);
+      const bool overridden =
+          std::any_of(overrides.begin(), overrides.end(),
+                      [&](const auto& value) {
+                        return variable_name(value) == name;
+                      });
+      if (overridden ||
+          (!descriptor.allow().empty() && !matches(name, descriptor.allow())) ||
+          matches(name, descriptor.deny())) {
+        continue;
+      }
+      array.push_back_borrowed(*entry);
+    }
+
+    return array;
+  }
+
+  bool fits_in_argument(std::size_t size) {
+    const long arg_max = sysconf(_SC_ARG_MAX);
+    const std::size_t limit =
+        arg_max > 0 ? std::min(max_string_size,
+                               static_cast<std::size_t>(arg_max) / 4)
+                    : max_string_size;
+    return size + 1 <= limit;
+  }
+
+  fx::result::Result<std::filesystem::path> inherited_file(
+      std::string_view contents) {
+#ifdef __linux__
+    const int descriptor = memfd_create("fx-arguments", 0);
+#else
+    std::string name =
+        (std::filesystem::temp_directory_path() / "fx-arguments-XXXXXX")
+            .u8string();
+    const int descriptor = mkstemp(name.data());
+    if (descriptor >= 0) {
+      unlink(name.c_str());
+    }
+#endif
+    if (descriptor < 0) {
+      return fx::result::Error(fmt::format(
+          "Unable to create the arguments file: {0}.", std::strerror(errno)));
+    }
+
+    std::size_t written = 0;
+    while (written < contents.size()) {
+      const ssize_t count = ::write(descriptor, contents.data() + written,
+                                    contents.size() - written);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count <= 0) {
+        const int error = errno;
+        ::close(descriptor);
+        return fx::result::Error(
+            fmt::format("Unable to write the arguments file: {0}.",
+                        std::strerror(error)));
+      }
+      written += static_cast<std::size_t>(count);
+    }
+    // /dev/fd/<n> shares the offset on some systems rather than reopening.
+    lseek(descriptor, 0, SEEK_SET);
+    return fx::result::Ok(std::filesystem::path(
+        fmt::format("/dev/fd/{0}", descriptor)));
+  }
+
+  fx::result::Result<void> check_limits(const CStringArray& argv,
+                                        const CStringArray& envp) {
+    std::size_t total = 0;
+    for (std::size_t index = 0; index < argv.size(); index++) {
+      const std::size_t size = std::strlen(argv.data()[index]) + 1;
+      if (size > max_string_size) {
+        return fx::result::Error(fmt::format(
+            "An argument of {0} KiB exceeds the system limit of {1} KiB.",
+            size / 1024, max_string_size / 1024));
+      }
+      total += size + sizeof(char*);
+    }
+    for (std::size_t index = 0; index < envp.size(); index++) {
+      const std::string_view entry(envp.data()[index]);
+      const std::size_t size = entry.size() + 1;
+      if (size > max_string_size) {
+        return fx::result::Error(fmt::format(
+            "The environment variable {0} of {1} KiB exceeds the system "
+            "limit of {2} KiB.",
+            variable_name(entry), size / 1024, max_string_size / 1024));
+      }
+      total += size + sizeof(char*);
+    }
+
+    const long arg_max = sysconf(_SC_ARG_MAX);
+    if (arg_max > 0 && total > static_cast<std::size_t>(arg_max)) {
+      return fx::result::Error(fmt::format(
+          "The command line and environment take {0} KiB, more than the "
+          "system limit of {1} KiB.",
+          total / 1024, arg_max / 1024));
+    }
+    return fx::result::Ok();
+  }
+}  // namespace fx::command::forwarder::exec
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "fx/descriptor/v1beta/descriptor.pb.h"
+#include "fx/result/result.hpp"
+
+namespace fx::command::forwarder::exec {
+  // A NULL terminated char* array for execve, i.e. argv or envp. Strings are
+  // copied into a few large blocks owned by the array rather than allocated
+  // one by one.
+  class CStringArray {
+   public:
+    CStringArray();
+
+    // Makes room for `count` strings of `bytes` characters in total, so the
+    // following push_backs do not allocate.
+    void reserve(std::size_t count, std::size_t bytes);
+
+    void push_back(std::string_view value);
+
+    // Stores the pointer without copying, so `value` must outlive the array.
+    void push_back_borrowed(char* value);
+
+    std::size_t size() const;
+
+    // Valid until the array is modified or destroyed.
+    char* const* data() const;
+
+   private:
+    char* allocate(std::size_t bytes);
+
+    std::vector<char*> _pointers;
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    std::size_t _block_used = 0;
+    std::size_t _block_size = 0;
+  };
+
+  CStringArray pack(const std::vector<std::string>& values);
+
+  // Builds envp from `inherited`, usually environ. Inherited entries are
+  // borrowed rather than copied. `overrides` are "NAME=value" entries that
+  // replace inherited variables of the same name and are never filtered.
+  CStringArray environment(
+      char* const* inherited,
+      const fx::descriptor::v1beta::EnvironmentDescriptor& descriptor,
+      const std::vector<std::string>& overrides);
+
+  // Whether a string of `size` bytes, without its terminator, can be passed
+  // to execve as one argument: MAX_ARG_STRLEN on Linux, and a quarter of
+  // ARG_MAX elsewhere so the rest of the command line still fits.
+  bool fits_in_argument(std::size_t size);
+
+  // Writes `contents` to an anonymous file that stays open across exec, and
+  // returns the path commands read it from, /dev/fd/<descriptor>. The file
+  // goes away once fx and the command have both closed it.
+  fx::result::Result<std::filesystem::path> inherited_file(
+      std::string_view contents);
+
+  // Fails when execve would with E2BIG: Linux limits every string to
+  // MAX_ARG_STRLEN (128 KiB), and all of them together to ARG_MAX.
+  fx::result::Result<void> check_limits(const CStringArray& argv,
+                                        const CStringArray& envp);
+}  // namespace fx::command::forwarder::exec
@@ -1,11 +1,21 @@
 #include "forwarder.hpp"
 #include <fmt/core.h>
-#include <pwd.h>
-#include <spdlog/spdlog.h>
 #include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include "fx/argparse/argparse.hpp"
+#include "fx/cache/cache.hpp"
+#include "fx/command/forwarder/exec/exec.hpp"
 #include "fx/command/forwarder/help/help.hpp"
-#include "fx/parser/parser.hpp"
+#include "fx/command/forwarder/plugin/plugin.hpp"
+#include "fx/command/forwarder/shard/shard.hpp"
+#include "fx/command/forwarder/shell/shell.hpp"
+#include "fx/command/forwarder/supervise/supervise.hpp"
+#include "fx/command/list/list.hpp"
+#include "fx/embedded/embedded.hpp"
+#include "fx/log/log.hpp"
+#include "fx/suggest/suggest.hpp"
 #include "fx/util/util.hpp"
 
 extern char** environ;
@@ -20,117 +30,499 @@ namespace fx::command {
   Forwarder::Forwarder(const std::string& command_name)
       : _command_name(std::move(command_name)){};
 
-  fx::result::Result<void> Forwarder::run(
-      const std::vector<std::string>& arguments) {
-    const auto workspace_path_result = find_workspace_descriptor_path();
+  Forwarder::Forwarder(const std::string& command_name,
+                       std::filesystem::path workspace_descriptor_path)
+      : _command_name(command_name),
+        _workspace_descriptor_path(std::move(workspace_descriptor_path)){};
+
+  fx::result::Result<void> Forwarder::run(fx::util::arguments_t arguments) {
+    _started = std::chrono::steady_clock::now();
+    _history_entry.timestamp_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    _history_entry.command = _command_name;
+    _observation.command = _command_name;
+
+    auto fx_options_result = parse_fx_options(arguments);
+    if (fx_options_result.failed()) {
+      return fx::result::Error(std::move(fx_options_result).error());
+    }
+    arguments = fx_options_result.value();
+    for (const auto& argument : arguments) {
+      // A separator after each one keeps "a b" apart from "ab".
+      _history_entry.arguments_hash = fx::history::hash(
+          std::string_view("\0", 1),
+          fx::history::hash(argument, _history_entry.arguments_hash));
+    }
+
+    auto phase_started = std::chrono::steady_clock::now();
+    auto workspace_path_result = find_workspace_descriptor_path();
     if (workspace_path_result.failed()) {
-      return fx::result::Error(workspace_path_result.error());
+      return fx::result::Error(std::move(workspace_path_result).error());
     }
     const auto& workspace_path = workspace_path_result.value();
+    _history_entry.workspace_hash =
+        fx::history::hash(workspace_path.u8string());
+    _observation.workspace = workspace_path.parent_path().u8string();
+    _observation.seconds[fx::metrics::PHASE_DISCOVERY] =
+        fx::util::seconds_since(phase_started);
 
-    const auto descriptor_result = parse_command_descriptor(workspace_path);
+    phase_started = std::chrono::steady_clock::now();
+    auto descriptor_result = parse_command_descriptor(workspace_path);
     if (descriptor_result.failed()) {
-      return fx::result::Error(descriptor_result.error());
+      return fx::result::Error(std::move(descriptor_result).error());
     }
     const auto& descriptor = descriptor_result.value();
+    _observation.seconds[fx::metrics::PHASE_PARSE] =
+        fx::util::seconds_since(phase_started);
 
-    const auto command_arguments_result =
+    phase_started = std::chrono::steady_clock::now();
+    auto command_arguments_result =
         parse_command_arguments(descriptor, arguments);
     if (command_arguments_result.failed()) {
-      return fx::result::Error(command_arguments_result.error());
+      return fx::result::Error(std::move(command_arguments_result).error());
     }
-    const auto& command_arguments = command_arguments_result.value();
+    auto command_arguments = std::move(command_arguments_result).take();
+    _observation.seconds[fx::metrics::PHASE_ARGPARSE] =
+        fx::util::seconds_since(phase_started);
 
     if (command_arguments["help"]["value"]) {
       return execute_help(descriptor);
     } else {
-      const std::vector<std::string> execution_arguments =
+      phase_started = std::chrono::steady_clock::now();
+      auto workspace_result = parse_workspace_descriptor(workspace_path);
+      if (workspace_result.failed()) {
+        return fx::result::Error(std::move(workspace_result).error());
+      }
+      *_observation.seconds[fx::metrics::PHASE_PARSE] +=
+          fx::util::seconds_since(phase_started);
+      configure(workspace_result.value());
+
+      if (_shard.has_value()) {
+        const auto timings_path = _shard_timings.value_or(
+            fx::command::forwarder::shard::timings_path(workspace_path,
+                                                        _command_name));
+        if (_shard_timings.has_value() &&
+            !std::filesystem::is_regular_file(timings_path)) {
+          return fx::result::Error(fmt::format(
+              "Unable to read shard timings {0}.", timings_path.u8string()));
+        }
+        auto shard_result = fx::command::forwarder::shard::apply(
+            descriptor,
+            fx::command::forwarder::shard::load_timings(timings_path), *_shard,
+            command_arguments);
+        if (shard_result.failed()) {
+          return fx::result::Error(std::move(shard_result).error());
+        }
+
+        if (const auto cache_directory = fx::cache::directory();
+            !cache_directory.empty()) {
+          _shard_timings_path =
+              fx::command::forwarder::shard::collected_timings_path(
+                  cache_directory, workspace_path, _command_name);
+          std::error_code error;
+          std::filesystem::create_directories(
+              _shard_timings_path->parent_path(), error);
+        }
+      }
+
+      if (descriptor.runtime().has_plugin()) {
+        return execute_plugin(descriptor, command_arguments, workspace_path);
+      }
+
+      auto execution_arguments_result =
           collate_execution_arguments(descriptor, command_arguments);
-      const std::vector<std::string> enviornment_variables =
-          collate_enviornment_variables(workspace_path);
-      return execute_command(execution_arguments, enviornment_variables);
+      if (execution_arguments_result.failed()) {
+        return fx::result::Error(
+            std::move(execution_arguments_result).error());
+      }
+      const auto enviornment_variables =
+          collate_enviornment_variables(descriptor, workspace_path);
+      return execute_command(execution_arguments_result.value(),
+                             enviornment_variables);
     }
   }
 
+  void Forwarder::configure(
+      const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace) {
+    if (workspace.has_shell()) {
+      _shell = workspace.shell();
+    }
+    _supervise = _supervise || workspace.supervise();
+  }
+
+  fx::result::Result<fx::util::arguments_t> Forwarder::parse_fx_options(
+      fx::util::arguments_t arguments) {
+    const std::string_view prefix("--fx-");
+    const std::string_view profile("--fx-profile");
+    const std::string_view profile_path("--fx-profile=");
+    const std::string_view shard("--fx-shard=");
+    const std::string_view shard_timings("--fx-shard-timings=");
+    while (!arguments.empty() &&
+           arguments[0].substr(0, prefix.size()) == prefix) {
+      const auto token = arguments[0];
+      if (token == profile) {
+        _profile = std::filesystem::path();
+        _supervise = true;
+      } else if (token.size() > profile_path.size() &&
+                 token.substr(0, profile_path.size()) == profile_path) {
+        _profile = std::filesystem::path(token.substr(profile_path.size()));
+        _supervise = true;
+      } else if (token.substr(0, shard.size()) == shard) {
+        auto shard_result =
+            fx::command::forwarder::shard::parse(token.substr(shard.size()));
+        if (shard_result.failed()) {
+          return fx::result::Error(std::move(shard_result).error());
+        }
+        _shard = shard_result.value();
+        // fx waits for the command, to merge the timings it records.
+        _supervise = true;
+      } else if (token.size() > shard_timings.size() &&
+                 token.substr(0, shard_timings.size()) == shard_timings) {
+        _shard_timings =
+            std::filesystem::path(token.substr(shard_timings.size()));
+      } else {
+        return fx::result::Error(
+            fmt::format("Unknown fx option \"{0}\".", token));
+      }
+      arguments = arguments.subspan(1);
+    }
+    if (_shard_timings.has_value() && !_shard.has_value()) {
+      return fx::result::Error(
+          std::string("--fx-shard-timings requires --fx-shard."));
+    }
+    return fx::result::Ok(arguments);
+  }
+
   fx::result::Result<std::filesystem::path>
   Forwarder::find_workspace_descriptor_path() {
+    if (_workspace_descriptor_path.has_value()) {
+      return fx::result::Ok(*_workspace_descriptor_path);
+    }
     return fx::util::workspace_descriptor_path();
   }
 
+  fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor>
+  Forwarder::parse_workspace_descriptor(
+      const std::filesystem::path& workspace_descriptor_path) {
+    auto entry_result = fx::cache::load_workspace(workspace_descriptor_path);
+    if (entry_result.failed()) {
+      return fx::result::Error(std::move(entry_result).error());
+    }
+    auto entry = std::move(entry_result).take();
+
+    return fx::result::Ok(std::move(*entry.mutable_workspace_descriptor()));
+  }
+
   fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor>
   Forwarder::parse_command_descriptor(
       const std::filesystem::path& workspace_descriptor_path) {
+    if (const auto* embedded = fx::embedded::workspace(); embedded != nullptr) {
+      const auto* command = fx::embedded::find(*embedded, _command_name);
+      if (command == nullptr) {
+        return fx::result::Error(unknown_command(workspace_descriptor_path));
+      }
+      auto entry = fx::embedded::load(*command);
+      _parse_table = std::move(*entry.mutable_parse_table());
+      return fx::result::Ok(std::move(*entry.mutable_command_descriptor()));
+    }
+
     const auto command_descriptor_path =
         workspace_descriptor_path.parent_path() /
         std::filesystem::path(_command_name) /
         std::filesystem::path("command.fx.yaml");
 
     if (!std::filesystem::exists(command_descriptor_path)) {
-      return fx::result::Error(
-          fmt::format("Unknown command \"{0}\".", _command_name));
+      return fx::result::Error(unknown_command(workspace_descriptor_path));
     }
 
-    const auto result =
-        fx::parser::parse_command_descriptor(command_descriptor_path);
-    if (result.failed()) {
-      return fx::result::Error(result.error());
+    auto entry_result = fx::cache::load_command(command_descriptor_path);
+    if (entry_result.failed()) {
+      return fx::result::Error(std::move(entry_result).error());
     }
+    auto entry = std::move(entry_result).take();
+
+    _command_descriptor_path = command_descriptor_path;
+    _parse_table = std::move(*entry.mutable_parse_table());
+    return fx::result::Ok(std::move(*entry.mutable_command_descriptor()));
+  }
 
-    return fx::result::Ok(result.value());
+  std::string Forwarder::unknown_command(
+      const std::filesystem::path& workspace_descriptor_path) {
+    const auto cache_directory = fx::cache::directory();
+    const auto* embedded = fx::embedded::workspace();
+    const auto suggest =
+        [&](const fx::cache::v1beta::CommandIndexEntry& index) {
+          // A cached index may still name commands removed since.
+          std::vector<std::string> suggestions;
+          for (auto& suggestion :
+               fx::suggest::suggest(index.trie(), _command_name)) {
+            if (embedded != nullptr
+                    ? fx::embedded::find(*embedded, suggestion) != nullptr
+                    : std::filesystem::exists(
+                          workspace_descriptor_path.parent_path() /
+                          suggestion / "command.fx.yaml")) {
+              suggestions.push_back(std::move(suggestion));
+            }
+          }
+          return suggestions;
+        };
+
+    std::vector<std::string> suggestions;
+    const auto index = fx::cache::load_command_index(workspace_descriptor_path,
+                                                     cache_directory);
+    if (index.has_value()) {
+      suggestions = suggest(*index);
+    }
+    // Without a match the index may just predate the command that was meant,
+    // so it is rebuilt. Misses are rare enough to afford walking the
+    // workspace.
+    if (suggestions.empty()) {
+      auto names_result =
+          fx::command::List::command_names(workspace_descriptor_path);
+      if (names_result.ok()) {
+        suggestions = suggest(fx::cache::store_command_index(
+            workspace_descriptor_path, cache_directory,
+            std::move(names_result).take()));
+      }
+    }
+    return fmt::format("Unknown command \"{0}\".{1}", _command_name,
+                       fx::suggest::did_you_mean(suggestions));
   }
 
   fx::result::Result<nlohmann::json> Forwarder::parse_command_arguments(
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
-      const std::vector<std::string>& arguments) {
-    const auto result = fx::argparse::parse(arguments, descriptor);
-    if (result.failed()) {
-      return fx::result::Error(result.error());
+      fx::util::arguments_t arguments) {
+    if (_parse_table.has_value()) {
+      return fx::argparse::parse(arguments, *_parse_table);
     }
-    return fx::result::Ok(result.value());
+    return fx::argparse::parse(arguments, descriptor);
   }
 
   std::string Forwarder::shell() {
-    return std::string(getpwuid(geteuid())->pw_shell);
+    if (_shell.has_value()) {
+      return *_shell;
+    }
+    return fx::command::forwarder::shell::resolve();
   }
 
-  std::vector<std::string> Forwarder::collate_execution_arguments(
+  fx::result::Result<std::vector<std::string>>
+  Forwarder::collate_execution_arguments(
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
       const nlohmann::json& arguments) {
-    const auto invocation =
-        fmt::format("{0} '{1}'", descriptor.runtime().run(), arguments.dump());
-    return std::vector<std::string>{shell(), "-l", "-c", invocation};
+    _arguments_file.reset();
+    const auto json = arguments.dump();
+    auto invocation =
+        fmt::format("{0} '{1}'", descriptor.runtime().run(), json);
+    if (!fx::command::forwarder::exec::fits_in_argument(invocation.size())) {
+      auto file_result = fx::command::forwarder::exec::inherited_file(json);
+      if (file_result.failed()) {
+        return fx::result::Error(std::move(file_result).error());
+      }
+      FX_LOG_DEBUG("Passing {0} KiB of arguments in {1}.", json.size() / 1024,
+                   file_result.value().u8string());
+      _arguments_file = std::move(file_result).value();
+      invocation = descriptor.runtime().run();
+    }
+    return fx::result::Ok(
+        std::vector<std::string>{shell(), "-l", "-c", invocation});
   }
 
-  std::vector<std::string> Forwarder::collate_enviornment_variables(
+  fx::command::forwarder::exec::CStringArray
+  Forwarder::collate_enviornment_variables(
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
       const std::filesystem::path& workspace_descriptor_path) {
-    std::vector<std::string> envvars{
+    std::vector<std::string> overrides{
         fmt::format("FX_WORKSPACE_DIRECTORY={0}",
                     workspace_descriptor_path.parent_path().u8string())};
-
-    char** current_envvar_pointer = environ;
-    for (; *current_envvar_pointer != nullptr; current_envvar_pointer++) {
-      envvars.emplace_back(*current_envvar_pointer);
+    if (_arguments_file.has_value()) {
+      overrides.push_back(fmt::format("FX_ARGUMENTS_FILE={0}",
+                                      _arguments_file->u8string()));
+    }
+    if (_shard_timings_path.has_value()) {
+      overrides.push_back(fmt::format(
+          "FX_SHARD_TIMINGS_FILE={0}",
+          fx::command::forwarder::shard::pending_timings_path(
+              *_shard_timings_path)
+              .u8string()));
     }
 
-    return envvars;
+    return fx::command::forwarder::exec::environment(
+        environ, descriptor.runtime().environment(), overrides);
   }
 
   fx::result::Result<void> Forwarder::execute_command(
       const std::vector<std::string>& arguments,
-      const std::vector<std::string>& envvars) {
-    char** c_arguments = fx::util::c_vector_string(arguments);
-    char** c_envvars = fx::util::c_vector_string(envvars);
+      const fx::command::forwarder::exec::CStringArray& envvars) {
+    const auto argv = fx::command::forwarder::exec::pack(arguments);
+    if (auto limits_result =
+            fx::command::forwarder::exec::check_limits(argv, envvars);
+        limits_result.failed()) {
+      return fx::result::Error(std::move(limits_result).error());
+    }
+
+    FX_LOG_DEBUG("Executing: {0}", fmt::join(arguments, " "));
+    _history_entry.fx_overhead_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _started)
+            .count();
+    if (_supervise) {
+      return execute_supervised(argv, envvars);
+    }
 
-    spdlog::debug("Executing: {0}", fmt::join(arguments, " "));
-    execve(c_arguments[0], const_cast<char* const*>(c_arguments), c_envvars);
+    record_invocation();
+    execve(argv.data()[0], argv.data(), envvars.data());
 
-    free(c_arguments);
-    free(c_envvars);
     return fx::result::Error(fmt::format("Error executing command."));
   }
 
+  fx::result::Result<void> Forwarder::execute_supervised(
+      const fx::command::forwarder::exec::CStringArray& argv,
+      const fx::command::forwarder::exec::CStringArray& envvars) {
+    auto report_result = fx::command::forwarder::supervise::run(
+        argv.data(), envvars.data(),
+        /*hardware_counters=*/_profile.has_value());
+    if (report_result.failed()) {
+      return fx::result::Error(std::move(report_result).error());
+    }
+    const auto& report = report_result.value();
+
+    _history_entry.child_wall_us =
+        static_cast<int64_t>(report.wall_seconds * 1e6);
+    _history_entry.max_rss_kib = report.max_rss_kib;
+    _history_entry.exit_code = report.exit_code;
+    _history_entry.signal = report.signal;
+    _observation.seconds[fx::metrics::PHASE_CHILD] = report.wall_seconds;
+    _observation.failed = report.exit_code != 0 || report.signal != 0;
+    record_invocation();
+
+    merge_shard_timings();
+
+    if (_profile.has_value()) {
+      write_profile(report);
+    }
+
+    fx::command::forwarder::supervise::pass_through(report);
+  }
+
+  fx::result::Result<void> Forwarder::execute_plugin(
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+      const nlohmann::json& arguments,
+      const std::filesystem::path& workspace_descriptor_path) {
+    // There is no child process to measure.
+    if (_profile.has_value()) {
+      return fx::result::Error(fmt::format(
+          "--fx-profile is not supported for \"{0}\", which runs as a "
+          "plugin.",
+          _command_name));
+    }
+
+    const auto plugin_path = fx::command::forwarder::plugin::path(
+        workspace_descriptor_path, _command_name,
+        descriptor.runtime().plugin());
+    const fx::command::forwarder::plugin::Arguments plugin_arguments(
+        descriptor, arguments);
+    const auto workspace_directory =
+        workspace_descriptor_path.parent_path().u8string();
+
+    fx_plugin_context_t context{};
+    context.abi_version = FX_PLUGIN_ABI_VERSION;
+    context.command = _command_name.c_str();
+    context.workspace_directory = workspace_directory.c_str();
+    context.argument_count = plugin_arguments.size();
+    context.arguments = plugin_arguments.data();
+    context.in = stdin;
+    context.out = stdout;
+    context.err = stderr;
+
+    FX_LOG_DEBUG("Calling plugin: {0}", plugin_path.u8string());
+    _history_entry.fx_overhead_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _started)
+            .count();
+    // The plugin sees the environment a command would get, but only during
+    // the call: fx still needs its own afterwards.
+    const auto enviornment_variables =
+        collate_enviornment_variables(descriptor, workspace_descriptor_path);
+    char** const inherited = environ;
+    environ = const_cast<char**>(enviornment_variables.data());
+    const auto plugin_started = std::chrono::steady_clock::now();
+    auto exit_code_result =
+        fx::command::forwarder::plugin::run(plugin_path, context);
+    environ = inherited;
+    if (exit_code_result.failed()) {
+      return fx::result::Error(std::move(exit_code_result).error());
+    }
+    std::fflush(stdout);
+    std::fflush(stderr);
+
+    const int exit_code = exit_code_result.value();
+    const double seconds = fx::util::seconds_since(plugin_started);
+    _history_entry.child_wall_us = static_cast<int64_t>(seconds * 1e6);
+    _history_entry.exit_code = exit_code;
+    _observation.seconds[fx::metrics::PHASE_CHILD] = seconds;
+    _observation.failed = exit_code != 0;
+    record_invocation();
+
+    merge_shard_timings();
+
+    if (exit_code != 0) {
+      std::exit(exit_code);
+    }
+    return fx::result::Ok();
+  }
+
+  void Forwarder::record_invocation() {
+    const auto cache_directory = fx::cache::directory();
+    fx::history::append(fx::history::path(cache_directory), _history_entry);
+    fx::metrics::record(fx::metrics::table_path(cache_directory),
+                        fx::metrics::export_path(), _observation);
+  }
+
+  void Forwarder::merge_shard_timings() {
+    if (!_shard_timings_path.has_value()) {
+      return;
+    }
+    if (const auto merge_result =
+            fx::command::forwarder::shard::merge_timings(*_shard_timings_path);
+        merge_result.failed()) {
+      FX_LOG_WARN("{0}", merge_result.error());
+    }
+  }
+
+  void Forwarder::write_profile(
+      const fx::command::forwarder::supervise::report_t& report) {
+    if (_profile->empty()) {
+      fmt::print(stderr, "{0}",
+                 fx::command::forwarder::supervise::format(_command_name,
+                                                           report));
+      return;
+    }
+
+    std::ofstream output(*_profile, std::ios::trunc);
+    output << fx::command::forwarder::supervise::to_json(_command_name, report)
+                  .dump()
+           << "\n";
+    if (!output) {
+      FX_LOG_ERROR("Unable to write profile to {0}", _profile->u8string());
+    }
+  }
+
   fx::result::Result<void> Forwarder::execute_help(
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor) {
-    return fx::command::forwarder::help::print(_command_name, descriptor);
+    if (!_command_descriptor_path.has_value()) {
+      return fx::command::forwarder::help::print(_command_name, descriptor);
+    }
+
+    const auto width = fx::command::forwarder::help::width();
+    fmt::print("{0}",
+               fx::cache::load_help_page(
+                   *_command_descriptor_path, fx::cache::directory(),
+                   _command_name, static_cast<uint32_t>(width), [&] {
+                     return fx::command::forwarder::help::render(
+                         _command_name, descriptor, width);
+                   }));
+    return fx::result::Ok();
   }
 }  // namespace fx::command
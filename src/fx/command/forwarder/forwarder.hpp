@@ -1,10 +1,19 @@
 #pragma once
 
+#include <chrono>
 #include <filesystem>
 #include <nlohmann/json.hpp>
+#include <optional>
+#include "fx/argparse/v1beta/table.pb.h"
 #include "fx/command/base/base.hpp"
+#include "fx/command/forwarder/exec/exec.hpp"
+#include "fx/command/forwarder/shard/shard.hpp"
+#include "fx/command/forwarder/supervise/supervise.hpp"
 #include "fx/descriptor/v1beta/descriptor.pb.h"
+#include "fx/history/history.hpp"
+#include "fx/metrics/metrics.hpp"
 #include "fx/result/result.hpp"
+#include "fx/util/util.hpp"
 
 namespace fx::command {
   class Protocol {
@@ -16,26 +25,38 @@ namespace fx::command {
     virtual fx::result::Result<std::filesystem::path>
     find_workspace_descriptor_path() = 0;
 
+    virtual fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor>
+    parse_workspace_descriptor(
+        const std::filesystem::path& workspace_descriptor_path) = 0;
+
     virtual fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor>
     parse_command_descriptor(
         const std::filesystem::path& workspace_descriptor_path) = 0;
 
     virtual fx::result::Result<nlohmann::json> parse_command_arguments(
         const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
-        const std::vector<std::string>& arguments) = 0;
+        fx::util::arguments_t arguments) = 0;
 
     virtual std::string shell() = 0;
 
-    virtual std::vector<std::string> collate_execution_arguments(
+    virtual fx::result::Result<std::vector<std::string>>
+    collate_execution_arguments(
         const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
         const nlohmann::json& arguments) = 0;
 
-    virtual std::vector<std::string> collate_enviornment_variables(
+    virtual fx::command::forwarder::exec::CStringArray
+    collate_enviornment_variables(
+        const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
         const std::filesystem::path& workspace_descriptor_path) = 0;
 
     virtual fx::result::Result<void> execute_command(
         const std::vector<std::string>& arguments,
-        const std::vector<std::string>& envvars) = 0;
+        const fx::command::forwarder::exec::CStringArray& envvars) = 0;
+
+    virtual fx::result::Result<void> execute_plugin(
+        const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+        const nlohmann::json& arguments,
+        const std::filesystem::path& workspace_descriptor_path) = 0;
 
     virtual fx::result::Result<void> execute_help(
         const fx::descriptor::v1beta::FxCommandDescriptor& descriptor) = 0;
@@ -45,37 +66,113 @@ namespace fx::command {
    public:
     Forwarder(const std::string& command_name);
 
-    fx::result::Result<void> run(
-        const std::vector<std::string>& arguments) override;
+    // Skips finding the workspace, for shims that know it up front.
+    Forwarder(const std::string& command_name,
+              std::filesystem::path workspace_descriptor_path);
+
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
 
     fx::result::Result<std::filesystem::path> find_workspace_descriptor_path()
         override;
 
+    fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor>
+    parse_workspace_descriptor(
+        const std::filesystem::path& workspace_descriptor_path) override;
+
     fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor>
     parse_command_descriptor(
         const std::filesystem::path& workspace_descriptor_path) override;
 
     fx::result::Result<nlohmann::json> parse_command_arguments(
         const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
-        const std::vector<std::string>& arguments) override;
+        fx::util::arguments_t arguments) override;
 
     std::string shell() override;
 
-    std::vector<std::string> collate_execution_arguments(
+    // Passes the arguments as one JSON string after `run`, or when that is
+    // too long for execve, in an inherited file instead, which the following
+    // collate_enviornment_variables names in FX_ARGUMENTS_FILE.
+    fx::result::Result<std::vector<std::string>> collate_execution_arguments(
         const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
         const nlohmann::json& arguments) override;
 
-    std::vector<std::string> collate_enviornment_variables(
+    fx::command::forwarder::exec::CStringArray collate_enviornment_variables(
+        const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
         const std::filesystem::path& workspace_descriptor_path) override;
 
     fx::result::Result<void> execute_command(
         const std::vector<std::string>& arguments,
-        const std::vector<std::string>& envvars) override;
+        const fx::command::forwarder::exec::CStringArray& envvars) override;
+
+    // Calls the plugin in-process. Exits with the plugin's exit code unless
+    // it is 0.
+    fx::result::Result<void> execute_plugin(
+        const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+        const nlohmann::json& arguments,
+        const std::filesystem::path& workspace_descriptor_path) override;
 
     fx::result::Result<void> execute_help(
         const fx::descriptor::v1beta::FxCommandDescriptor& descriptor) override;
 
+    // Applies the workspace settings, i.e. the pinned shell and supervision.
+    void configure(
+        const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace);
+
    private:
+    // Consumes the leading --fx-* options, which configure fx itself rather
+    // than the command.
+    fx::result::Result<fx::util::arguments_t> parse_fx_options(
+        fx::util::arguments_t arguments);
+
+    fx::result::Result<void> execute_supervised(
+        const fx::command::forwarder::exec::CStringArray& argv,
+        const fx::command::forwarder::exec::CStringArray& envvars);
+
+    // The error for a command that does not exist, suggesting similar ones.
+    std::string unknown_command(
+        const std::filesystem::path& workspace_descriptor_path);
+
+    // Appends to the history and records the metrics.
+    void record_invocation();
+
+    // Folds the timings a sharded command recorded into the collected
+    // timings.
+    void merge_shard_timings();
+
+    void write_profile(
+        const fx::command::forwarder::supervise::report_t& report);
+
     std::string _command_name;
+    std::optional<std::filesystem::path> _workspace_descriptor_path;
+    // Set when the descriptor came from the cache, so arguments can be parsed
+    // without recompiling the table.
+    std::optional<fx::argparse::v1beta::ParseTable> _parse_table;
+    // Set when the descriptor came from a file, whose cache entry also holds
+    // the rendered help pages.
+    std::optional<std::filesystem::path> _command_descriptor_path;
+    // Set when the workspace pins the shell.
+    std::optional<std::string> _shell;
+    // Set by --fx-profile. Empty reports to stderr, otherwise the report is
+    // written to the path as JSON.
+    std::optional<std::filesystem::path> _profile;
+    // Set by --fx-shard.
+    std::optional<fx::command::forwarder::shard::shard_t> _shard;
+    // Set by --fx-shard-timings, to balance by other timings than the
+    // command's shard-timings.tsv.
+    std::optional<std::filesystem::path> _shard_timings;
+    // Where a sharded run collects the timings its command records, set once
+    // it found its command and the cache is enabled.
+    std::optional<std::filesystem::path> _shard_timings_path;
+    // Set by collate_execution_arguments when the arguments did not fit on
+    // the command line.
+    std::optional<std::filesystem::path> _arguments_file;
+    // Set by the workspace descriptor; --fx-profile and --fx-shard imply it.
+    bool _supervise = false;
+    std::chrono::steady_clock::time_point _started;
+    // Filled in while forwarding, appended to the history when the command
+    // starts, or once it exits when supervised.
+    fx::history::entry_t _history_entry;
+    // Filled in alongside the history entry, with the time spent per phase.
+    fx::metrics::observation_t _observation;
   };
 }  // namespace fx::command
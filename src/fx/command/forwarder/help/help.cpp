@@ -1,256 +1,255 @@
 #include "help.hpp"
 #include <fmt/color.h>
 #include <fmt/core.h>
-#include <boost/algorithm/string_regex.hpp>
-#include <boost/regex.hpp>
-#include <sstream>
+#include <fmt/format.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
 
-// This is a complete mess. Like seriously. Gotta ship tho. CLEAN IT UP LATER!!!
 namespace fx::command::forwarder::help {
-  static const std::string::size_type WIDTH = 80;
-  static const std::string::size_type INDENT = 3;
+  namespace {
+    const std::size_t DEFAULT_WIDTH = 80;
+    const std::size_t MINIMUM_WIDTH = 40;
+    const std::size_t INDENT = 3;
+
+    // Views into the descriptor, so choices and defaults are never copied.
+    template <typename T, typename C>
+    struct coerced_value_t {
+      std::string_view type_name;
+      const C& choices;
+      bool required;
+      bool list;
+      T default_value;
+      bool takes_value;
+    };
+
+    template <typename V, typename F>
+    void coerce(const V& value, std::string_view type_name, bool takes_value,
+                F lambda) {
+      lambda(coerced_value_t<decltype(value.default_()),
+                             std::decay_t<decltype(value.choices())>>{
+          type_name, value.choices(), value.required(), value.list(),
+          value.default_(), takes_value});
+    }
+
+    template <typename F>
+    void coerce_value(
+        const fx::descriptor::v1beta::OptionDescriptor& descriptor,
+        F lambda) {
+      static const google::protobuf::RepeatedField<bool> no_choices;
+      if (descriptor.has_bool_value()) {
+        lambda(coerced_value_t<bool, google::protobuf::RepeatedField<bool>>{
+            "bool", no_choices, false, false, false, false});
+      } else if (descriptor.has_int_value()) {
+        coerce(descriptor.int_value(), "int", true, lambda);
+      } else if (descriptor.has_double_value()) {
+        coerce(descriptor.double_value(), "double", true, lambda);
+      } else if (descriptor.has_string_value()) {
+        coerce(descriptor.string_value(), "string", true, lambda);
+      }
+    }
+
+    template <typename F>
+    void coerce_value(
+        const fx::descriptor::v1beta::ArgumentDescriptor& descriptor,
+        F lambda) {
+      if (descriptor.has_int_value()) {
+        coerce(descriptor.int_value(), "int", false, lambda);
+      } else if (descriptor.has_double_value()) {
+        coerce(descriptor.double_value(), "double", false, lambda);
+      } else if (descriptor.has_string_value()) {
+        coerce(descriptor.string_value(), "string", false, lambda);
+      }
+    }
+
+    // Columns taken by UTF-8 text, counting code points.
+    std::size_t columns(std::string_view text) {
+      std::size_t count = 0;
+      for (const unsigned char character : text) {
+        count += (character & 0xC0) != 0x80;
+      }
+      return count;
+    }
+
+    void append_wrapped(std::string& result, std::string_view content,
+                        std::size_t left_padding, std::size_t width) {
+      const std::size_t max_width =
+          width > left_padding ? width - left_padding : 1;
+      std::size_t column = 0;
+      std::size_t newlines = 0;
+      bool paragraph_break = false;
+
+      std::size_t index = 0;
+      while (index < content.size()) {
+        const char character = content[index];
+        if (character == '\n') {
+          paragraph_break = paragraph_break || (++newlines > 1 && column > 0);
+          index++;
+          continue;
+        }
+        if (character == ' ' || character == '\t' || character == '\r') {
+          index++;
+          continue;
+        }
+
+        const auto end = std::min(content.find_first_of(" \t\r\n", index),
+                                  content.size());
+        const auto word = content.substr(index, end - index);
+        const auto word_columns = columns(word);
+        if (paragraph_break) {
+          result += "\n\n";
+          column = 0;
+        } else if (column > 0 && column + 1 + word_columns > max_width) {
+          result += '\n';
+          column = 0;
+        }
+        if (column == 0) {
+          result.append(left_padding, ' ');
+        } else {
+          result += ' ';
+          column++;
+        }
+        result.append(word);
+        column += word_columns;
+        newlines = 0;
+        paragraph_break = false;
+        index = end;
+      }
+    }
+
+    template <typename V>
+    void append_value(std::string& page, const std::string& name,
+                      const std::string& description, const V& value,
+                      std::size_t width) {
+      auto out = std::back_inserter(page);
+      fmt::format_to(out, "{0:>{1}} · ", name, name.size() + INDENT);
+      fmt::format_to(out, value.list ? "List<{}>" : "{}", value.type_name);
+      fmt::format_to(out, " · {0}\n\n",
+                     value.required ? "required" : "optional");
+
+      append_wrapped(page, description, INDENT * 2, width);
+      page += "\n\n";
+
+      std::string footer = fmt::format("Default: {}", value.default_value);
+      if (!value.choices.empty()) {
+        fmt::format_to(std::back_inserter(footer), " | Choices: {0}",
+                       fmt::join(value.choices, ", "));
+      }
+      append_wrapped(page, footer, INDENT * 2, width);
+      page += "\n";
+    }
+  }  // namespace
+
+  std::size_t width() {
+    std::size_t result = 0;
+    if (const char* value = std::getenv("COLUMNS"); value != nullptr) {
+      const std::string_view columns(value);
+      std::from_chars(columns.data(), columns.data() + columns.size(), result);
+    }
+    if (struct winsize size{};
+        result == 0 && ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0) {
+      result = size.ws_col;
+    }
+    if (result == 0) {
+      return DEFAULT_WIDTH;
+    }
+    return std::max(result, MINIMUM_WIDTH);
+  }
 
   fx::result::Result<void> print(
       const std::string& command_name,
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor) {
-    fmt::print("{0} — {1}\n\n",
-               fmt::format(fmt::emphasis::bold, "fx {0}", command_name),
-               descriptor.synopsis());
+    fmt::print("{0}", render(command_name, descriptor, width()));
+    return fx::result::Ok();
+  }
 
-    fmt::print("{}\n", wrap("usage:", INDENT));
-    fmt::print("{}\n\n", wrap(usage(command_name, descriptor), INDENT * 2));
+  std::string render(
+      const std::string& command_name,
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+      std::size_t width) {
+    std::string page;
+    auto out = std::back_inserter(page);
+    fmt::format_to(out, "{0} — {1}\n\n",
+                   fmt::format(fmt::emphasis::bold, "fx {0}", command_name),
+                   descriptor.synopsis());
+
+    append_wrapped(page, "usage:", INDENT, width);
+    page += "\n";
+    append_wrapped(page, usage(command_name, descriptor), INDENT * 2, width);
+    page += "\n\n";
 
     if (!descriptor.description().empty()) {
-      fmt::print("{0}\n\n", wrap(descriptor.description(), 0));
+      append_wrapped(page, descriptor.description(), 0, width);
+      page += "\n\n";
     }
 
     if (!descriptor.options().empty()) {
-      fmt::print("{0:·<{1}}\n\n", "· OPTIONS ", WIDTH);
+      fmt::format_to(out, "{0:·<{1}}\n\n", "· OPTIONS ", width);
       for (const auto& option : descriptor.options()) {
-        coerce_value(option, [&](auto value) {
-          std::vector<std::string> header_components{};
-          std::string name = fmt::format("{0:>{1}}", "--" + option.name(),
-                                         option.name().size() + INDENT + 2);
+        coerce_value(option, [&](const auto& value) {
+          std::string name = "--" + option.name();
           if (!option.short_name().empty()) {
-            name = fmt::format("{0}, -{1}", name, option.short_name());
+            name += ", -" + option.short_name();
           }
-          header_components.emplace_back(name);
-          header_components.emplace_back(
-              fmt::format(value.list ? "List<{}>" : "{}", value.type_name));
-          header_components.emplace_back(value.required ? "required"
-                                                        : "optional");
-          fmt::print("{}\n\n", fmt::join(header_components, " · "));
-
-          fmt::print("{}\n", wrap(option.description(), INDENT * 2));
-
-          std::vector<std::string> footer_components{};
-          footer_components.emplace_back(
-              fmt::format("Default: {}", value.default_value));
-          if (!value.choices.empty()) {
-            footer_components.emplace_back(
-                fmt::format("Choices: {0}", fmt::join(value.choices, ", ")));
-          }
-          fmt::print(
-              "\n{}\n",
-              wrap(fmt::format("{}", fmt::join(footer_components, " | ")),
-                   INDENT * 2));
+          append_value(page, name, option.description(), value, width);
         });
-        fmt::print("\n");
+        page += "\n";
       }
     }
 
     if (!descriptor.arguments().empty()) {
-      fmt::print("{0:·<{1}}\n\n", "· ARGUMENTS ", WIDTH);
+      fmt::format_to(out, "{0:·<{1}}\n\n", "· ARGUMENTS ", width);
       for (const auto& argument : descriptor.arguments()) {
-        coerce_value(argument, [&](auto value) {
-          std::vector<std::string> header_components{};
-          const std::string name = fmt::format("{0:>{1}}", argument.name(),
-                                               argument.name().size() + INDENT);
-          header_components.emplace_back(name);
-          header_components.emplace_back(
-              fmt::format(value.list ? "List<{}>" : "{}", value.type_name));
-          header_components.emplace_back(value.required ? "required"
-                                                        : "optional");
-          fmt::print("{}\n\n", fmt::join(header_components, " · "));
-
-          fmt::print("{}\n", wrap(argument.description(), INDENT * 2));
-
-          std::vector<std::string> footer_components{};
-          footer_components.emplace_back(
-              fmt::format("Default: {}", value.default_value));
-          if (!value.choices.empty()) {
-            footer_components.emplace_back(
-                fmt::format("Choices: {0}", fmt::join(value.choices, ", ")));
-          }
-          fmt::print(
-              "\n{}\n",
-              wrap(fmt::format("{}", fmt::join(footer_components, " | ")),
-                   INDENT * 2));
+        coerce_value(argument, [&](const auto& value) {
+          append_value(page, argument.name(), argument.description(), value,
+                       width);
         });
-
-        fmt::print("\n");
+        page += "\n";
       }
     }
 
-    return fx::result::Ok();
+    return page;
   }
 
   std::string usage(
       const std::string& command_name,
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor) {
-    std::vector<std::string> components{"fx", command_name};
+    std::string result = "fx " + command_name;
+    auto out = std::back_inserter(result);
 
     for (const auto& option : descriptor.options()) {
-      coerce_value(option, [&](auto value) {
-        std::vector<std::string> subcomps{};
+      coerce_value(option, [&](const auto& value) {
+        result += value.required ? " " : " [";
         if (!option.short_name().empty()) {
-          subcomps.emplace_back(fmt::format("-{0}", option.short_name()));
+          fmt::format_to(out, "-{0}|", option.short_name());
+        }
+        fmt::format_to(out, "--{0}", option.name());
+        if (value.takes_value) {
+          fmt::format_to(out, "=<{0}{1}>", option.name(),
+                         value.list ? "..." : "");
         }
-        subcomps.emplace_back(fmt::format(
-            "--{0}{1}", option.name(),
-            value.takes_value ? fmt::format("=<{0}{1}>", option.name(),
-                                            value.list ? "..." : "")
-                              : ""));
-        components.emplace_back(fmt::format(value.required ? "{}" : "[{}]",
-                                            fmt::join(subcomps, "|")));
+        result += value.required ? "" : "]";
       });
     }
 
     for (const auto& argument : descriptor.arguments()) {
-      coerce_value(argument, [&](auto value) {
-        const auto arg =
-            fmt::format("{0}{1}", argument.name(), value.list ? "..." : "");
-        components.emplace_back(
-            fmt::format(value.required ? "{}" : "[{}]", arg));
+      coerce_value(argument, [&](const auto& value) {
+        fmt::format_to(out, value.required ? " {0}{1}" : " [{0}{1}]",
+                       argument.name(), value.list ? "..." : "");
       });
     }
 
-    return fmt::format("{}", fmt::join(components, " "));
-  }
-
-  std::string wrap(const std::string& content,
-                   std::string::size_type left_padding) {
-    const std::string padding = fmt::format("{0:<{1}}", "", left_padding);
-    std::string result{};
-    const std::string::size_type max_width = WIDTH - left_padding;
-
-    std::vector<std::string> lines;
-    boost::algorithm::split_regex(lines, content, boost::regex("\n"));
-
-    for (const auto& line : lines) {
-      if (line.empty()) {
-        result += "\n";
-      } else {
-        std::vector<std::string> words;
-        boost::algorithm::split(words, line, boost::is_any_of("\t "));
-        std::string::size_type current_line_length = 0;
-        result += padding;
-        for (const auto& word : words) {
-          const auto padded_word = fmt::format("{} ", word);
-          if (current_line_length + padded_word.size() > max_width) {
-            result += fmt::format("\n{}", padding);
-            current_line_length = 0;
-          }
-          result += padded_word;
-          current_line_length += padded_word.size();
-        }
-      }
-    }
-
     return result;
   }
 
-  template <typename F>
-  void coerce_value(const fx::descriptor::v1beta::OptionDescriptor& descriptor,
-                    F lambda) {
-    if (descriptor.has_bool_value()) {
-      coerced_value_t<bool> coerced_value;
-      coerced_value.type_name = "bool";
-      coerced_value.choices = std::vector<bool>{};
-      coerced_value.required = false;
-      coerced_value.list = false;
-      coerced_value.default_value = false;
-      coerced_value.takes_value = false;
-
-      lambda(coerced_value);
-    } else if (descriptor.has_int_value()) {
-      coerced_value_t<int64_t> coerced_value;
-      coerced_value.type_name = "int";
-      coerced_value.choices =
-          std::vector<int64_t>{descriptor.int_value().choices().begin(),
-                               descriptor.int_value().choices().end()};
-      coerced_value.required = descriptor.int_value().required();
-      coerced_value.list = descriptor.int_value().list();
-      coerced_value.default_value = descriptor.int_value().default_();
-      coerced_value.takes_value = true;
-
-      lambda(coerced_value);
-    } else if (descriptor.has_double_value()) {
-      coerced_value_t<double> coerced_value;
-      coerced_value.type_name = "double";
-      coerced_value.choices =
-          std::vector<double>{descriptor.double_value().choices().begin(),
-                              descriptor.double_value().choices().end()};
-      coerced_value.required = descriptor.double_value().required();
-      coerced_value.list = descriptor.double_value().list();
-      coerced_value.default_value = descriptor.double_value().default_();
-      coerced_value.takes_value = true;
-
-      lambda(coerced_value);
-    } else if (descriptor.has_string_value()) {
-      coerced_value_t<std::string> coerced_value;
-      coerced_value.type_name = "string";
-      coerced_value.choices =
-          std::vector<std::string>{descriptor.string_value().choices().begin(),
-                                   descriptor.string_value().choices().end()};
-      coerced_value.required = descriptor.string_value().required();
-      coerced_value.list = descriptor.string_value().list();
-      coerced_value.default_value = descriptor.string_value().default_();
-      coerced_value.takes_value = true;
-
-      lambda(coerced_value);
-    }
-  }
-
-  template <typename F>
-  void coerce_value(
-      const fx::descriptor::v1beta::ArgumentDescriptor& descriptor, F lambda) {
-    if (descriptor.has_int_value()) {
-      coerced_value_t<int64_t> coerced_value;
-      coerced_value.type_name = "int";
-      coerced_value.choices =
-          std::vector<int64_t>{descriptor.int_value().choices().begin(),
-                               descriptor.int_value().choices().end()};
-      coerced_value.required = descriptor.int_value().required();
-      coerced_value.list = descriptor.int_value().list();
-      coerced_value.default_value = descriptor.int_value().default_();
-      coerced_value.takes_value = false;
-
-      lambda(coerced_value);
-    } else if (descriptor.has_double_value()) {
-      coerced_value_t<double> coerced_value;
-      coerced_value.type_name = "double";
-      coerced_value.choices =
-          std::vector<double>{descriptor.double_value().choices().begin(),
-                              descriptor.double_value().choices().end()};
-      coerced_value.required = descriptor.double_value().required();
-      coerced_value.list = descriptor.double_value().list();
-      coerced_value.default_value = descriptor.double_value().default_();
-      coerced_value.takes_value = false;
-
-      lambda(coerced_value);
-    } else if (descriptor.has_string_value()) {
-      coerced_value_t<std::string> coerced_value;
-      coerced_value.type_name = "string";
-      coerced_value.choices =
-          std::vector<std::string>{descriptor.string_value().choices().begin(),
-                                   descriptor.string_value().choices().end()};
-      coerced_value.required = descriptor.string_value().required();
-      coerced_value.list = descriptor.string_value().list();
-      coerced_value.default_value = descriptor.string_value().default_();
-      coerced_value.takes_value = false;
-
-      lambda(coerced_value);
-    }
+  std::string wrap(std::string_view content, std::size_t left_padding,
+                   std::size_t width) {
+    std::string result;
+    append_wrapped(result, content, left_padding, width);
+    return result;
   }
 }  // namespace fx::command::forwarder::help
@@ -1,36 +1,32 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include "fx/descriptor/v1beta/descriptor.pb.h"
 #include "fx/result/result.hpp"
 
 namespace fx::command::forwarder::help {
-  template <typename T>
-  struct coerced_value_t {
-    std::string type_name;
-    std::vector<T> choices;
-    bool required;
-    bool list;
-    T default_value;
-    bool takes_value;
-  };
+  // $COLUMNS, else the width of the terminal on stdout, else 80. Never less
+  // than 40 so that indented text keeps some room.
+  std::size_t width();
 
   fx::result::Result<void> print(
       const std::string& command_name,
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor);
 
+  std::string render(
+      const std::string& command_name,
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+      std::size_t width);
+
   std::string usage(
       const std::string& command_name,
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor);
 
-  std::string wrap(const std::string& content,
-                   std::string::size_type left_padding);
-
-  template <typename F>
-  void coerce_value(const fx::descriptor::v1beta::OptionDescriptor& descriptor,
-                    F lambda);
-
-  template <typename F>
-  void coerce_value(
-      const fx::descriptor::v1beta::ArgumentDescriptor& descriptor, F lambda);
+  // Reflows the words of `content` into lines of at most `width` columns,
+  // each indented by `left_padding`. Blank lines separate paragraphs; words
+  // longer than a line are kept whole.
+  std::string wrap(std::string_view content, std::size_t left_padding,
+                   std::size_t width);
 }  // namespace fx::command::forwarder::help
@@ -0,0 +1,73 @@
+/*
+ * The C ABI of native fx command plugins, see RuntimeDescriptor.plugin.
+ *
+ * A plugin is a shared object exporting FX_PLUGIN_ENTRY_POINT. fx loads it
+ * into its own process and calls it with the parsed arguments instead of
+ * starting the command through a shell. The return value is the exit code.
+ *
+ *   #include "fx_plugin.h"
+ *
+ *   int fx_plugin_main_v1(const fx_plugin_context_t* context) {
+ *     fprintf(context->out, "%s\n", context->workspace_directory);
+ *     return 0;
+ *   }
+ *
+ * Everything the context points to is owned by fx and only valid during the
+ * call. Structs only ever grow at the end; incompatible changes get a new
+ * entry point.
+ */
+#ifndef FX_PLUGIN_H_
+#define FX_PLUGIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FX_PLUGIN_ABI_VERSION 1
+#define FX_PLUGIN_ENTRY_POINT "fx_plugin_main_v1"
+
+typedef enum fx_plugin_type_t {
+  FX_PLUGIN_BOOL = 0,
+  FX_PLUGIN_INT = 1,
+  FX_PLUGIN_DOUBLE = 2,
+  FX_PLUGIN_STRING = 3,
+} fx_plugin_type_t;
+
+typedef struct fx_plugin_argument_t {
+  /* The option or argument name, i.e. "verbose". */
+  const char* name;
+  fx_plugin_type_t type;
+  /* Non-zero when given by the user rather than defaulted. */
+  int user_set;
+  /* Non-zero for list options and arguments. Otherwise count is 1. */
+  int list;
+  size_t count;
+  /* Only the array matching type is set; bools are 0 or 1 in ints. */
+  const int64_t* ints;
+  const double* doubles;
+  const char* const* strings;
+} fx_plugin_argument_t;
+
+typedef struct fx_plugin_context_t {
+  /* FX_PLUGIN_ABI_VERSION of the calling fx. */
+  uint32_t abi_version;
+  const char* command;
+  const char* workspace_directory;
+  size_t argument_count;
+  const fx_plugin_argument_t* arguments;
+  FILE* in;
+  FILE* out;
+  FILE* err;
+} fx_plugin_context_t;
+
+typedef int (*fx_plugin_main_t)(const fx_plugin_context_t* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FX_PLUGIN_H_ */
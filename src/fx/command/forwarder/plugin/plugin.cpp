@@ -0,0 +1,136 @@
+#include "plugin.hpp"
+#include <dlfcn.h>
+#include <fmt/core.h>
+
+namespace fx::command::forwarder::plugin {
+  Arguments::Arguments(
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+      const nlohmann::json& arguments) {
+    // Reserved up front, so the pointers into the storage stay valid.
+    _storage.reserve(descriptor.options_size() + descriptor.arguments_size());
+    _arguments.reserve(_storage.capacity());
+
+    for (const auto& option : descriptor.options()) {
+      if (!arguments.contains(option.name())) {
+        continue;
+      }
+      const auto& argument = arguments[option.name()];
+      if (option.has_bool_value()) {
+        add(option.name(), FX_PLUGIN_BOOL, false, argument);
+      } else if (option.has_int_value()) {
+        add(option.name(), FX_PLUGIN_INT, option.int_value().list(), argument);
+      } else if (option.has_double_value()) {
+        add(option.name(), FX_PLUGIN_DOUBLE, option.double_value().list(),
+            argument);
+      } else if (option.has_string_value()) {
+        add(option.name(), FX_PLUGIN_STRING, option.string_value().list(),
+            argument);
+      }
+    }
+
+    for (const auto& positional : descriptor.arguments()) {
+      if (!arguments.contains(positional.name())) {
+        continue;
+      }
+      const auto& argument = arguments[positional.name()];
+      if (positional.has_int_value()) {
+        add(positional.name(), FX_PLUGIN_INT, positional.int_value().list(),
+            argument);
+      } else if (positional.has_double_value()) {
+        add(positional.name(), FX_PLUGIN_DOUBLE,
+            positional.double_value().list(), argument);
+      } else if (positional.has_string_value()) {
+        add(positional.name(), FX_PLUGIN_STRING,
+            positional.string_value().list(), argument);
+      }
+    }
+  }
+
+  void Arguments::add(const std::string& name,
+                      fx_plugin_type_t type,
+                      bool list,
+                      const nlohmann::json& argument) {
+    auto& storage = _storage.emplace_back();
+    storage.name = name;
+
+    const auto& value = argument["value"];
+    const auto append = [&](const nlohmann::json& element) {
+      switch (type) {
+        case FX_PLUGIN_BOOL:
+          storage.ints.push_back(element.get<bool>() ? 1 : 0);
+          break;
+        case FX_PLUGIN_INT:
+          storage.ints.push_back(element.get<int64_t>());
+          break;
+        case FX_PLUGIN_DOUBLE:
+          storage.doubles.push_back(element.get<double>());
+          break;
+        case FX_PLUGIN_STRING:
+          storage.strings.push_back(element.get<std::string>());
+          break;
+      }
+    };
+    if (list) {
+      for (const auto& element : value) {
+        append(element);
+      }
+    } else {
+      append(value);
+    }
+    for (const auto& string : storage.strings) {
+      storage.string_pointers.push_back(string.c_str());
+    }
+
+    fx_plugin_argument_t result{};
+    result.name = storage.name.c_str();
+    result.type = type;
+    result.user_set = argument.value("user_set", false) ? 1 : 0;
+    result.list = list ? 1 : 0;
+    result.count = storage.ints.size() + storage.doubles.size() +
+                   storage.strings.size();
+    result.ints = storage.ints.empty() ? nullptr : storage.ints.data();
+    result.doubles =
+        storage.doubles.empty() ? nullptr : storage.doubles.data();
+    result.strings = storage.string_pointers.empty()
+                         ? nullptr
+                         : storage.string_pointers.data();
+    _arguments.push_back(result);
+  }
+
+  const fx_plugin_argument_t* Arguments::data() const {
+    return _arguments.data();
+  }
+
+  std::size_t Arguments::size() const {
+    return _arguments.size();
+  }
+
+  std::filesystem::path path(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::string& command_name,
+      const std::string& plugin) {
+    const std::filesystem::path plugin_path(plugin);
+    if (plugin_path.is_absolute()) {
+      return plugin_path;
+    }
+    return workspace_descriptor_path.parent_path() / command_name / plugin_path;
+  }
+
+  fx::result::Result<int> run(const std::filesystem::path& plugin_path,
+                              const fx_plugin_context_t& context) {
+    void* handle = dlopen(plugin_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+      return fx::result::Error(
+          fmt::format("Unable to load plugin: {0}.", dlerror()));
+    }
+
+    const auto entry_point = reinterpret_cast<fx_plugin_main_t>(
+        dlsym(handle, FX_PLUGIN_ENTRY_POINT));
+    if (entry_point == nullptr) {
+      return fx::result::Error(
+          fmt::format("Plugin \"{0}\" does not export {1}.",
+                      plugin_path.u8string(), FX_PLUGIN_ENTRY_POINT));
+    }
+    return fx::result::Ok(entry_point(&context));
+  }
+}  // namespace fx::command::forwarder::plugin
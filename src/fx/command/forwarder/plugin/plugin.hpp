@@ -0,0 +1,54 @@
+#pragma once
+
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+#include "fx/command/forwarder/plugin/fx_plugin.h"
+#include "fx/descriptor/v1beta/descriptor.pb.h"
+#include "fx/result/result.hpp"
+
+namespace fx::command::forwarder::plugin {
+  // The parsed arguments as the C structs handed to a plugin, typed by the
+  // descriptor. Owns everything the structs point to.
+  class Arguments {
+   public:
+    Arguments(const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+              const nlohmann::json& arguments);
+
+    Arguments(const Arguments&) = delete;
+    Arguments& operator=(const Arguments&) = delete;
+
+    const fx_plugin_argument_t* data() const;
+
+    std::size_t size() const;
+
+   private:
+    struct storage_t {
+      std::string name;
+      std::vector<int64_t> ints;
+      std::vector<double> doubles;
+      std::vector<std::string> strings;
+      std::vector<const char*> string_pointers;
+    };
+
+    void add(const std::string& name,
+             fx_plugin_type_t type,
+             bool list,
+             const nlohmann::json& argument);
+
+    std::vector<storage_t> _storage;
+    std::vector<fx_plugin_argument_t> _arguments;
+  };
+
+  // Relative plugin paths are resolved against the command directory.
+  std::filesystem::path path(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::string& command_name,
+      const std::string& plugin);
+
+  // Loads the plugin, which then stays loaded, and calls its entry point.
+  // Returns the exit code.
+  fx::result::Result<int> run(const std::filesystem::path& plugin_path,
+                              const fx_plugin_context_t& context);
+}  // namespace fx::command::forwarder::plugin
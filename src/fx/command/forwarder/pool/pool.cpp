@@ -0,0 +1,235 @@
+#include "pool.hpp"
+#include <fcntl.h>
+#include <fmt/core.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "fx/cache/cache.hpp"
+#include "fx/history/history.hpp"
+
+namespace fx::command::forwarder::pool {
+  namespace {
+    // How long to wait for a command that closed its output to exit.
+    const int reap_interval_ms = 10;
+
+    struct running_t {
+      std::size_t task;
+      pid_t pid = 0;
+      // Read end of the command's stdout and stderr, -1 once it is closed.
+      int output = -1;
+      std::string buffer;
+      std::chrono::steady_clock::time_point started;
+    };
+
+    fx::result::Result<running_t> spawn(const task_t& task, std::size_t index) {
+      const auto argv = fx::command::forwarder::exec::pack(task.arguments);
+      if (auto limits_result = fx::command::forwarder::exec::check_limits(
+              argv, task.environment);
+          limits_result.failed()) {
+        return fx::result::Error(std::move(limits_result).error());
+      }
+
+      int pipe_descriptors[2];
+      if (pipe2(pipe_descriptors, O_CLOEXEC) != 0) {
+        return fx::result::Error(fmt::format("Error creating a pipe: {0}.",
+                                             std::strerror(errno)));
+      }
+
+      posix_spawn_file_actions_t actions;
+      posix_spawn_file_actions_init(&actions);
+      posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null",
+                                       O_RDONLY, 0);
+      posix_spawn_file_actions_adddup2(&actions, pipe_descriptors[1],
+                                       STDOUT_FILENO);
+      posix_spawn_file_actions_adddup2(&actions, pipe_descriptors[1],
+                                       STDERR_FILENO);
+
+      running_t running;
+      running.task = index;
+      running.started = std::chrono::steady_clock::now();
+      const int spawn_error =
+          posix_spawn(&running.pid, argv.data()[0], &actions, nullptr,
+                      argv.data(), task.environment.data());
+      posix_spawn_file_actions_destroy(&actions);
+      ::close(pipe_descriptors[1]);
+      if (spawn_error != 0) {
+        ::close(pipe_descriptors[0]);
+        return fx::result::Error(fmt::format("Error executing command: {0}.",
+                                             std::strerror(spawn_error)));
+      }
+      running.output = pipe_descriptors[0];
+      return fx::result::Ok(std::move(running));
+    }
+
+    void drain(running_t& running) {
+      char buffer[64 * 1024];
+      const ssize_t count = ::read(running.output, buffer, sizeof(buffer));
+      if (count > 0) {
+        running.buffer.append(buffer, static_cast<std::size_t>(count));
+      } else if (count == 0 || (errno != EINTR && errno != EAGAIN)) {
+        ::close(running.output);
+        running.output = -1;
+      }
+    }
+  }  // namespace
+
+  fx::result::Result<workspace_t> load_workspace() {
+    workspace_t workspace;
+    auto phase_started = std::chrono::steady_clock::now();
+    auto path_result = fx::util::workspace_descriptor_path();
+    if (path_result.failed()) {
+      return fx::result::Error(std::move(path_result).error());
+    }
+    workspace.path = std::move(path_result).take();
+    workspace.discovery_seconds = fx::util::seconds_since(phase_started);
+
+    phase_started = std::chrono::steady_clock::now();
+    auto entry_result = fx::cache::load_workspace(workspace.path);
+    if (entry_result.failed()) {
+      return fx::result::Error(std::move(entry_result).error());
+    }
+    workspace.entry = std::move(entry_result).take();
+    workspace.parse_seconds = fx::util::seconds_since(phase_started);
+
+    workspace.cache_directory = fx::cache::directory();
+    workspace.history_path = fx::history::path(workspace.cache_directory);
+    workspace.hash = fx::history::hash(workspace.path.u8string());
+    return fx::result::Ok(std::move(workspace));
+  }
+
+  unsigned default_jobs() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  fx::result::Result<unsigned> parse_jobs(std::string_view value) {
+    unsigned jobs = 0;
+    const auto [end, error] =
+        std::from_chars(value.data(), value.data() + value.size(), jobs);
+    if (error != std::errc() || end != value.data() + value.size() ||
+        jobs == 0) {
+      return fx::result::Error(
+          fmt::format("Invalid number of jobs \"{0}\".", value));
+    }
+    return fx::result::Ok(jobs);
+  }
+
+  fx::result::Result<bool> parse_jobs_option(fx::util::arguments_t arguments,
+                                             std::size_t& index,
+                                             unsigned& jobs) {
+    const std::string_view argument = arguments[index];
+    std::string_view value;
+    if (argument == "-j" || argument == "--jobs") {
+      if (index + 1 == arguments.size()) {
+        return fx::result::Error(
+            fmt::format("Option \"{0}\" requires a value.", argument));
+      }
+      value = arguments[++index];
+    } else if (argument.substr(0, 7) == "--jobs=") {
+      value = argument.substr(7);
+    } else if (argument.size() > 2 && argument.substr(0, 2) == "-j") {
+      value = argument.substr(2);
+    } else {
+      return fx::result::Ok(false);
+    }
+
+    auto jobs_result = parse_jobs(value);
+    if (jobs_result.failed()) {
+      return fx::result::Error(std::move(jobs_result).error());
+    }
+    jobs = jobs_result.value();
+    return fx::result::Ok(true);
+  }
+
+  void print(std::string_view output) {
+    std::fwrite(output.data(), 1, output.size(), stdout);
+    std::fflush(stdout);
+  }
+
+  fx::result::Result<void> run(
+      const std::vector<task_t>& tasks,
+      const std::vector<std::size_t>& order,
+      unsigned jobs,
+      const std::function<void(std::size_t)>& started,
+      const std::function<void(std::size_t, const outcome_t&)>& finished) {
+    std::size_t next = 0;
+    std::vector<running_t> running;
+    while (next < order.size() || !running.empty()) {
+      while (running.size() < jobs && next < order.size()) {
+        const std::size_t index = order[next++];
+        started(index);
+        auto spawn_result = spawn(tasks[index], index);
+        if (spawn_result.failed()) {
+          outcome_t outcome;
+          outcome.exit_code = 127;
+          outcome.output = spawn_result.error() + "\n";
+          finished(index, outcome);
+          continue;
+        }
+        running.push_back(std::move(spawn_result).take());
+      }
+
+      // Commands that closed their output are reaped without blocking, so a
+      // command that keeps running does not hold up the others.
+      bool reaping = false;
+      for (auto iterator = running.begin(); iterator != running.end();) {
+        if (iterator->output >= 0) {
+          ++iterator;
+          continue;
+        }
+        int wait_status = 0;
+        struct rusage usage {};
+        if (wait4(iterator->pid, &wait_status, WNOHANG, &usage) !=
+            iterator->pid) {
+          reaping = true;
+          ++iterator;
+          continue;
+        }
+
+        outcome_t outcome;
+        outcome.exit_code =
+            WIFEXITED(wait_status) ? WEXITSTATUS(wait_status) : 0;
+        outcome.signal = WIFSIGNALED(wait_status) ? WTERMSIG(wait_status) : 0;
+        outcome.wall_seconds = fx::util::seconds_since(iterator->started);
+        outcome.max_rss_kib = usage.ru_maxrss;
+        outcome.output = std::move(iterator->buffer);
+        const std::size_t index = iterator->task;
+        iterator = running.erase(iterator);
+        finished(index, outcome);
+      }
+      if (running.empty()) {
+        continue;
+      }
+
+      std::vector<pollfd> descriptors;
+      std::vector<running_t*> readers;
+      for (auto& job : running) {
+        if (job.output >= 0) {
+          descriptors.push_back({job.output, POLLIN, 0});
+          readers.push_back(&job);
+        }
+      }
+      const int ready = poll(descriptors.data(), descriptors.size(),
+                             reaping ? reap_interval_ms : -1);
+      if (ready < 0 && errno != EINTR) {
+        return fx::result::Error(fmt::format("Error waiting for commands: {0}.",
+                                             std::strerror(errno)));
+      }
+      for (std::size_t index = 0; ready > 0 && index < descriptors.size();
+           index++) {
+        if (descriptors[index].revents != 0) {
+          drain(*readers[index]);
+        }
+      }
+    }
+    return fx::result::Ok();
+  }
+}  // namespace fx::command::forwarder::pool
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "fx/cache/v1beta/cache.pb.h"
+#include "fx/command/forwarder/exec/exec.hpp"
+#include "fx/result/result.hpp"
+#include "fx/util/util.hpp"
+
+// Runs commands concurrently as children of fx. Every command reads stdin
+// from /dev/null and writes both stdout and stderr into a pipe, so its output
+// keeps its order and is handed over in one piece once it exits.
+namespace fx::command::forwarder::pool {
+  struct task_t {
+    std::vector<std::string> arguments;
+    fx::command::forwarder::exec::CStringArray environment;
+  };
+
+  struct outcome_t {
+    // 127 when the command could not be started, with the reason as output.
+    int exit_code = 0;
+    int signal = 0;
+    double wall_seconds = 0;
+    int64_t max_rss_kib = 0;
+    std::string output;
+  };
+
+  // Everything the commands of fx run and fx batch share, looked up once.
+  struct workspace_t {
+    std::filesystem::path path;
+    fx::cache::v1beta::WorkspaceCacheEntry entry;
+    double discovery_seconds = 0;
+    double parse_seconds = 0;
+    std::filesystem::path cache_directory;
+    std::filesystem::path history_path;
+    uint64_t hash = 0;
+  };
+
+  fx::result::Result<workspace_t> load_workspace();
+
+  // One per core.
+  unsigned default_jobs();
+
+  // Positive, from the value of --jobs.
+  fx::result::Result<unsigned> parse_jobs(std::string_view value);
+
+  // Reads -j, --jobs, --jobs=<n> or -j<n> at `arguments[index]` into `jobs`,
+  // moving `index` onto a separate value. False for any other argument.
+  fx::result::Result<bool> parse_jobs_option(fx::util::arguments_t arguments,
+                                             std::size_t& index,
+                                             unsigned& jobs);
+
+  // Written with a single flush so the output of concurrent commands never
+  // interleaves.
+  void print(std::string_view output);
+
+  // Starts `tasks` in `order`, at most `jobs` at a time. `started` and
+  // `finished` are called with the index of the task.
+  fx::result::Result<void> run(
+      const std::vector<task_t>& tasks,
+      const std::vector<std::size_t>& order,
+      unsigned jobs,
+      const std::function<void(std::size_t)>& started,
+      const std::function<void(std::size_t, const outcome_t&)>& finished);
+}  // namespace fx::command::forwarder::pool
@@ -0,0 +1,237 @@
+#include "shard.hpp"
+#include <fcntl.h>
+#include <fmt/core.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <optional>
+#include "fx/history/history.hpp"
+#include "fx/util/util.hpp"
+
+namespace fx::command::forwarder::shard {
+  namespace {
+    std::optional<uint32_t> parse_number(std::string_view value) {
+      uint32_t number = 0;
+      const auto [end, error] =
+          std::from_chars(value.data(), value.data() + value.size(), number);
+      if (error != std::errc() || end != value.data() + value.size()) {
+        return std::nullopt;
+      }
+      return number;
+    }
+
+    void read_timings(const std::filesystem::path& timings_path,
+                      std::unordered_map<std::string, double>& timings) {
+      std::ifstream input(timings_path);
+      std::string line;
+      while (std::getline(input, line)) {
+        const auto separator = line.rfind('\t');
+        if (separator == std::string::npos || separator == 0) {
+          continue;
+        }
+        const std::string value = line.substr(separator + 1);
+        char* end = nullptr;
+        const double seconds = std::strtod(value.c_str(), &end);
+        if (end == value.c_str() || *end != '\0' || !std::isfinite(seconds) ||
+            seconds < 0) {
+          continue;
+        }
+        timings[line.substr(0, separator)] = seconds;
+      }
+    }
+
+    double median(const std::unordered_map<std::string, double>& timings) {
+      std::vector<double> values;
+      values.reserve(timings.size());
+      for (const auto& [item, seconds] : timings) {
+        values.push_back(seconds);
+      }
+      std::sort(values.begin(), values.end());
+      return values[values.size() / 2];
+    }
+
+    const fx::descriptor::v1beta::ArgumentDescriptor* list_argument(
+        const fx::descriptor::v1beta::FxCommandDescriptor& descriptor) {
+      for (const auto& argument : descriptor.arguments()) {
+        if ((argument.has_int_value() && argument.int_value().list()) ||
+            (argument.has_double_value() && argument.double_value().list()) ||
+            (argument.has_string_value() && argument.string_value().list())) {
+          return &argument;
+        }
+      }
+      return nullptr;
+    }
+  }  // namespace
+
+  fx::result::Result<shard_t> parse(std::string_view value) {
+    const auto separator = value.find('/');
+    const auto index = parse_number(value.substr(0, separator));
+    const auto count = separator == std::string_view::npos
+                           ? std::nullopt
+                           : parse_number(value.substr(separator + 1));
+    if (!index.has_value() || !count.has_value() || *index == 0 ||
+        *index > *count || *count > max_count) {
+      return fx::result::Error(fmt::format(
+          "Invalid shard \"{0}\", expected <index>/<count> with 1 <= index "
+          "<= count <= {1}.",
+          value, max_count));
+    }
+    return fx::result::Ok(shard_t{*index - 1, *count});
+  }
+
+  std::unordered_map<std::string, double> load_timings(
+      const std::filesystem::path& timings_path) {
+    std::unordered_map<std::string, double> timings;
+    read_timings(timings_path, timings);
+    return timings;
+  }
+
+  std::filesystem::path pending_timings_path(
+      const std::filesystem::path& timings_path) {
+    return timings_path.parent_path() /
+           fmt::format(".{0}.{1}", timings_path.filename().u8string(),
+                       getpid());
+  }
+
+  fx::result::Result<void> merge_timings(
+      const std::filesystem::path& timings_path) {
+    const auto pending_path = pending_timings_path(timings_path);
+    std::error_code error;
+    if (!std::filesystem::exists(pending_path, error)) {
+      return fx::result::Ok();
+    }
+
+    // The file itself is replaced by every merge, so the lock is on its
+    // directory.
+    const int directory = ::open(timings_path.parent_path().c_str(),
+                                 O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory < 0 || flock(directory, LOCK_EX) != 0) {
+      const std::string reason = std::strerror(errno);
+      if (directory >= 0) {
+        ::close(directory);
+      }
+      return fx::result::Error(fmt::format(
+          "Unable to lock {0}: {1}.", timings_path.u8string(), reason));
+    }
+
+    std::unordered_map<std::string, double> timings;
+    read_timings(timings_path, timings);
+    read_timings(pending_path, timings);
+    const std::map<std::string, double> sorted(timings.begin(),
+                                               timings.end());
+    std::string contents;
+    for (const auto& [item, seconds] : sorted) {
+      contents += fmt::format("{0}\t{1}\n", item, seconds);
+    }
+    auto write_result = fx::util::write_atomically(timings_path, contents);
+    ::close(directory);
+    if (write_result.failed()) {
+      return fx::result::Error(std::move(write_result).error());
+    }
+    std::filesystem::remove(pending_path, error);
+    return fx::result::Ok();
+  }
+
+  std::filesystem::path timings_path(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::string& command_name) {
+    return workspace_descriptor_path.parent_path() / command_name /
+           "shard-timings.tsv";
+  }
+
+  std::filesystem::path collected_timings_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::string& command_name) {
+    const auto workspace_hash =
+        fx::history::hash(workspace_descriptor_path.u8string());
+    return cache_directory / "shard-timings" /
+           fmt::format("{0:016x}", workspace_hash) / command_name /
+           "shard-timings.tsv";
+  }
+
+  std::vector<std::size_t> select(
+      const std::vector<std::string>& items,
+      const std::unordered_map<std::string, double>& timings,
+      shard_t shard) {
+    std::vector<std::size_t> selected;
+    if (timings.empty()) {
+      for (std::size_t index = 0; index < items.size(); index++) {
+        if (fx::history::hash(items[index]) % shard.count == shard.index) {
+          selected.push_back(index);
+        }
+      }
+      return selected;
+    }
+
+    const double fallback = median(timings);
+    std::vector<double> costs(items.size());
+    std::vector<std::size_t> order(items.size());
+    for (std::size_t index = 0; index < items.size(); index++) {
+      const auto found = timings.find(items[index]);
+      costs[index] = found == timings.end() ? fallback : found->second;
+      order[index] = index;
+    }
+    // Ties are broken by the item, so the order does not depend on how the
+    // items were passed.
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t left, std::size_t right) {
+                if (costs[left] != costs[right]) {
+                  return costs[left] > costs[right];
+                }
+                if (items[left] != items[right]) {
+                  return items[left] < items[right];
+                }
+                return left < right;
+              });
+
+    // Every item goes onto an empty shard before any shard gets a second
+    // one, so shards beyond the number of items stay empty either way.
+    std::vector<double> loads(
+        std::min<std::size_t>(shard.count, items.size()), 0);
+    for (const std::size_t index : order) {
+      const auto least_loaded = static_cast<std::size_t>(
+          std::min_element(loads.begin(), loads.end()) - loads.begin());
+      loads[least_loaded] += costs[index];
+      if (least_loaded == shard.index) {
+        selected.push_back(index);
+      }
+    }
+    std::sort(selected.begin(), selected.end());
+    return selected;
+  }
+
+  fx::result::Result<void> apply(
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+      const std::unordered_map<std::string, double>& timings,
+      shard_t shard,
+      nlohmann::json& arguments) {
+    const auto* argument = list_argument(descriptor);
+    if (argument == nullptr) {
+      return fx::result::Error(std::string(
+          "--fx-shard requires the command to have a list argument."));
+    }
+
+    auto& values = arguments[argument->name()]["value"];
+    std::vector<std::string> items;
+    items.reserve(values.size());
+    for (const auto& value : values) {
+      items.push_back(value.is_string() ? value.get<std::string>()
+                                        : value.dump());
+    }
+
+    nlohmann::json selected = nlohmann::json::array();
+    for (const std::size_t index : select(items, timings, shard)) {
+      selected.push_back(std::move(values[index]));
+    }
+    values = std::move(selected);
+    return fx::result::Ok();
+  }
+}  // namespace fx::command::forwarder::shard
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "fx/descriptor/v1beta/descriptor.pb.h"
+#include "fx/result/result.hpp"
+
+// Splits the items of a command's list argument across machines. Every shard
+// computes the same partition on its own, so the items are neither dropped
+// nor run twice as long as all shards see the same timings.
+namespace fx::command::forwarder::shard {
+  struct shard_t {
+    // Zero-based, parsed from one-based "<index>/<count>".
+    uint32_t index = 0;
+    uint32_t count = 1;
+  };
+
+  // Far beyond any CI fleet; larger counts are typos.
+  const uint32_t max_count = 65536;
+
+  fx::result::Result<shard_t> parse(std::string_view value);
+
+  // Seconds per item, the last line wins. Lines are "<item>\t<seconds>".
+  std::unordered_map<std::string, double> load_timings(
+      const std::filesystem::path& timings_path);
+
+  // Where the command of a sharded run appends its timings, passed as
+  // FX_SHARD_TIMINGS_FILE. It belongs to this fx process alone.
+  std::filesystem::path pending_timings_path(
+      const std::filesystem::path& timings_path);
+
+  // Moves the timings the command appended to its pending file into
+  // `timings_path`, which is rewritten compacted. fx processes take turns
+  // through a lock on the directory, and are the only ones writing the file,
+  // so no timing is lost to a concurrent rewrite.
+  fx::result::Result<void> merge_timings(
+      const std::filesystem::path& timings_path);
+
+  // The timings select() reads unless --fx-shard-timings names others. It
+  // sits next to the command descriptor and is only ever read, so every
+  // checkout of the same commit sees the same timings.
+  std::filesystem::path timings_path(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::string& command_name);
+
+  // Where sharded runs of the command collect the timings they record, in
+  // the cache directory. Nothing reads them back: each machine only has the
+  // timings of its own shards, so they are for the user to combine and
+  // publish as the timings file.
+  std::filesystem::path collected_timings_path(
+      const std::filesystem::path& cache_directory,
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::string& command_name);
+
+  // Indices of the items in `shard`, in order. Items with a timing are
+  // balanced by cost, longest first onto the least loaded shard, and items
+  // without one count as the median timing. Without any timings, items are
+  // assigned by a stable hash.
+  std::vector<std::size_t> select(
+      const std::vector<std::string>& items,
+      const std::unordered_map<std::string, double>& timings,
+      shard_t shard);
+
+  // Replaces the value of the command's list argument with the items of
+  // `shard`.
+  fx::result::Result<void> apply(
+      const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
+      const std::unordered_map<std::string, double>& timings,
+      shard_t shard,
+      nlohmann::json& arguments);
+}  // namespace fx::command::forwarder::shard
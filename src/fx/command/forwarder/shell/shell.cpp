@@ -0,0 +1,77 @@
+#include "shell.hpp"
+#include <fmt/core.h>
+#include <pwd.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include "fx/cache/cache.hpp"
+#include "fx/cache/v1beta/cache.pb.h"
+#include "fx/log/log.hpp"
+
+namespace fx::command::forwarder::shell {
+  // Login shells rarely change, but a changed one should not be ignored
+  // forever.
+  static const int64_t max_entry_age_seconds = 24 * 60 * 60;
+
+  namespace {
+    int64_t now() {
+      return std::chrono::duration_cast<std::chrono::seconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    bool is_executable(const std::string& path) {
+      return !path.empty() && access(path.c_str(), X_OK) == 0;
+    }
+  }  // namespace
+
+  std::filesystem::path entry_path(const std::filesystem::path& cache_directory,
+                                   unsigned int uid) {
+    return cache_directory / "shells" / fmt::format("{0}.binpb", uid);
+  }
+
+  std::string resolve() {
+    return resolve(fx::cache::directory());
+  }
+
+  std::string resolve(const std::filesystem::path& cache_directory) {
+    if (const char* shell = std::getenv("SHELL");
+        shell != nullptr && *shell != '\0') {
+      return std::string(shell);
+    }
+
+    const auto uid = geteuid();
+    const auto path = cache_directory.empty()
+                          ? std::filesystem::path()
+                          : entry_path(cache_directory, uid);
+    if (!path.empty()) {
+      fx::cache::v1beta::ShellCacheEntry entry;
+      std::ifstream input(path, std::ios::binary);
+      if (input && entry.ParseFromIstream(&input) && entry.uid() == uid &&
+          now() - entry.resolved_at() < max_entry_age_seconds &&
+          is_executable(entry.shell())) {
+        return entry.shell();
+      }
+    }
+
+    std::string shell("/bin/sh");
+    if (const auto* passwd = getpwuid(uid);
+        passwd != nullptr && passwd->pw_shell != nullptr &&
+        *passwd->pw_shell != '\0') {
+      shell = passwd->pw_shell;
+    } else {
+      FX_LOG_DEBUG("Unable to look up the login shell, using {0}", shell);
+    }
+
+    if (!path.empty()) {
+      fx::cache::v1beta::ShellCacheEntry entry;
+      entry.set_uid(uid);
+      entry.set_shell(shell);
+      entry.set_resolved_at(now());
+      fx::cache::store(path, entry);
+    }
+
+    return shell;
+  }
+}  // namespace fx::command::forwarder::shell
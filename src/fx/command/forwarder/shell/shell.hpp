@@ -0,0 +1,16 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace fx::command::forwarder::shell {
+  std::filesystem::path entry_path(const std::filesystem::path& cache_directory,
+                                   unsigned int uid);
+
+  // The shell commands are run with: $SHELL, else the login shell cached in
+  // the fx cache directory, else the login shell from the user database
+  // (getpwuid), which is then cached. Falls back to /bin/sh.
+  std::string resolve();
+
+  std::string resolve(const std::filesystem::path& cache_directory);
+}  // namespace fx::command::forwarder::shell
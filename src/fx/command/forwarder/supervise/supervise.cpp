@@ -0,0 +1,266 @@
+#include "supervise.hpp"
+#include <fmt/core.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace fx::command::forwarder::supervise {
+  static constexpr std::array<int, 4> forwarded_signals{SIGTERM, SIGHUP,
+                                                        SIGUSR1, SIGUSR2};
+  static constexpr std::array<int, 2> ignored_signals{SIGINT, SIGQUIT};
+
+  namespace {
+    volatile sig_atomic_t child_pid = 0;
+
+    void forward(int signal) {
+      if (child_pid > 0) {
+        kill(child_pid, signal);
+      }
+    }
+
+    double seconds(const timeval& value) {
+      return value.tv_sec + value.tv_usec / 1e6;
+    }
+
+    std::string metric(uint64_t value) {
+      if (value >= 1000000000) {
+        return fmt::format("{0:.2f}G", value / 1e9);
+      } else if (value >= 1000000) {
+        return fmt::format("{0:.2f}M", value / 1e6);
+      } else if (value >= 1000) {
+        return fmt::format("{0:.2f}K", value / 1e3);
+      }
+      return fmt::format("{0}", value);
+    }
+
+    // Restores the signal dispositions and mask fx had before run().
+    class SignalScope {
+     public:
+      SignalScope() {
+        sigset_t blocked;
+        sigemptyset(&blocked);
+        for (const int signal : forwarded_signals) {
+          sigaddset(&blocked, signal);
+        }
+        // Held until the child's pid is known, so nothing is forwarded to
+        // pid 0 (which would signal the whole process group).
+        sigprocmask(SIG_BLOCK, &blocked, &_mask);
+
+        struct sigaction action {};
+        action.sa_handler = forward;
+        sigemptyset(&action.sa_mask);
+        for (std::size_t index = 0; index < forwarded_signals.size();
+             index++) {
+          sigaction(forwarded_signals[index], &action, &_forwarded[index]);
+        }
+
+        action.sa_handler = SIG_IGN;
+        for (std::size_t index = 0; index < ignored_signals.size(); index++) {
+          sigaction(ignored_signals[index], &action, &_ignored[index]);
+        }
+      }
+
+      ~SignalScope() {
+        child_pid = 0;
+        for (std::size_t index = 0; index < forwarded_signals.size();
+             index++) {
+          sigaction(forwarded_signals[index], &_forwarded[index], nullptr);
+        }
+        for (std::size_t index = 0; index < ignored_signals.size(); index++) {
+          sigaction(ignored_signals[index], &_ignored[index], nullptr);
+        }
+        sigprocmask(SIG_SETMASK, &_mask, nullptr);
+      }
+
+      const sigset_t& mask() const {
+        return _mask;
+      }
+
+      void unblock(pid_t pid) {
+        child_pid = pid;
+        sigprocmask(SIG_SETMASK, &_mask, nullptr);
+      }
+
+     private:
+      sigset_t _mask;
+      std::array<struct sigaction, forwarded_signals.size()> _forwarded;
+      std::array<struct sigaction, ignored_signals.size()> _ignored;
+    };
+  }  // namespace
+
+  fx::result::Result<report_t> run(char* const* argv, char* const* envp,
+                                   bool hardware_counters) {
+    SignalScope scope;
+    std::optional<fx::command::forwarder::counters::Counters> counters;
+    if (hardware_counters) {
+      counters.emplace();
+    }
+
+    // The child starts with default dispositions and fx's original mask.
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    for (const int signal : forwarded_signals) {
+      sigaddset(&defaults, signal);
+    }
+    for (const int signal : ignored_signals) {
+      sigaddset(&defaults, signal);
+    }
+    posix_spawnattr_setsigdefault(&attributes, &defaults);
+    posix_spawnattr_setsigmask(&attributes, &scope.mask());
+    posix_spawnattr_setflags(&attributes,
+                             POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+    if (counters.has_value()) {
+      counters->start();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    pid_t pid = 0;
+    const int spawn_error =
+        posix_spawn(&pid, argv[0], nullptr, &attributes, argv, envp);
+    posix_spawnattr_destroy(&attributes);
+    if (spawn_error != 0) {
+      return fx::result::Error(fmt::format("Error executing command: {0}.",
+                                           std::strerror(spawn_error)));
+    }
+    scope.unblock(pid);
+
+    int status = 0;
+    struct rusage usage {};
+    while (wait4(pid, &status, 0, &usage) < 0) {
+      if (errno != EINTR) {
+        return fx::result::Error(fmt::format(
+            "Error waiting for command: {0}.", std::strerror(errno)));
+      }
+    }
+    const std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - start;
+
+    report_t report;
+    if (counters.has_value()) {
+      counters->stop();
+      if (counters->available()) {
+        report.counters = counters->read();
+      } else {
+        report.counters_error = counters->error();
+      }
+    }
+    if (WIFEXITED(status)) {
+      report.exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+      report.signal = WTERMSIG(status);
+    }
+    report.wall_seconds = wall.count();
+    report.user_seconds = seconds(usage.ru_utime);
+    report.system_seconds = seconds(usage.ru_stime);
+#ifdef __APPLE__
+    // Bytes rather than kilobytes on macOS.
+    report.max_rss_kib = usage.ru_maxrss / 1024;
+#else
+    report.max_rss_kib = usage.ru_maxrss;
+#endif
+    report.voluntary_context_switches = usage.ru_nvcsw;
+    report.involuntary_context_switches = usage.ru_nivcsw;
+    report.block_input_operations = usage.ru_inblock;
+    report.block_output_operations = usage.ru_oublock;
+
+    return fx::result::Ok(report);
+  }
+
+  nlohmann::json to_json(const std::string& command_name,
+                         const report_t& report) {
+    nlohmann::json json{
+        {"command", command_name},
+        {"wall_seconds", report.wall_seconds},
+        {"user_seconds", report.user_seconds},
+        {"system_seconds", report.system_seconds},
+        {"max_rss_kib", report.max_rss_kib},
+        {"voluntary_context_switches", report.voluntary_context_switches},
+        {"involuntary_context_switches", report.involuntary_context_switches},
+        {"block_input_operations", report.block_input_operations},
+        {"block_output_operations", report.block_output_operations}};
+    if (report.signal != 0) {
+      json["signal"] = report.signal;
+    } else {
+      json["exit_code"] = report.exit_code;
+    }
+    if (report.counters.has_value()) {
+      const auto& counters = *report.counters;
+      json["counters"] = {
+          {"cycles", counters.cycles},
+          {"instructions", counters.instructions},
+          {"branches", counters.branches},
+          {"branch_misses", counters.branch_misses},
+          {"cache_references", counters.cache_references},
+          {"cache_misses", counters.cache_misses},
+          {"coverage", counters.coverage},
+          {"instructions_per_cycle", counters.instructions_per_cycle()},
+          {"branch_miss_rate", counters.branch_miss_rate()},
+          {"cache_miss_rate", counters.cache_miss_rate()}};
+    } else if (!report.counters_error.empty()) {
+      json["counters_error"] = report.counters_error;
+    }
+    return json;
+  }
+
+  std::string format(const std::string& command_name, const report_t& report) {
+    const auto status =
+        report.signal != 0
+            ? fmt::format("killed by signal {0} ({1})", report.signal,
+                          strsignal(report.signal))
+            : fmt::format("exit code {0}", report.exit_code);
+    auto formatted = fmt::format(
+        "fx profile · {0} · {1}\n"
+        "   wall {2:.3f}s · user {3:.3f}s · sys {4:.3f}s\n"
+        "   max rss {5:.1f} MiB · block io {6} in, {7} out\n"
+        "   context switches {8} voluntary, {9} involuntary\n",
+        command_name, status, report.wall_seconds, report.user_seconds,
+        report.system_seconds, report.max_rss_kib / 1024.0,
+        report.block_input_operations, report.block_output_operations,
+        report.voluntary_context_switches,
+        report.involuntary_context_switches);
+    if (report.counters.has_value()) {
+      const auto& counters = *report.counters;
+      formatted += fmt::format(
+          "   ipc {0:.2f} ({1} instructions, {2} cycles) · branch misses "
+          "{3:.2f}% · cache misses {4:.2f}%\n",
+          counters.instructions_per_cycle(), metric(counters.instructions),
+          metric(counters.cycles), counters.branch_miss_rate() * 100,
+          counters.cache_miss_rate() * 100);
+      if (counters.coverage < 1) {
+        formatted += fmt::format(
+            "   counters ran {0:.0f}% of the time and were scaled\n",
+            counters.coverage * 100);
+      }
+    } else if (!report.counters_error.empty()) {
+      formatted += fmt::format("   hardware counters unavailable: {0}\n",
+                               report.counters_error);
+    }
+    return formatted;
+  }
+
+  void pass_through(const report_t& report) {
+    if (report.signal != 0) {
+      std::fflush(nullptr);
+      signal(report.signal, SIG_DFL);
+      sigset_t unblocked;
+      sigemptyset(&unblocked);
+      sigaddset(&unblocked, report.signal);
+      sigprocmask(SIG_UNBLOCK, &unblocked, nullptr);
+      raise(report.signal);
+      // Signals that do not terminate, i.e. SIGCHLD, fall back to the shell
+      // convention.
+      std::exit(128 + report.signal);
+    }
+    std::exit(report.exit_code);
+  }
+}  // namespace fx::command::forwarder::supervise
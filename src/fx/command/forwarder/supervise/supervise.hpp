@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include "fx/command/forwarder/counters/counters.hpp"
+#include "fx/result/result.hpp"
+
+// Runs a command as a child of fx rather than replacing fx with it, so its
+// resource usage can be reported once it exits.
+namespace fx::command::forwarder::supervise {
+  struct report_t {
+    // Set when the child exited normally, otherwise `signal` is set.
+    int exit_code = 0;
+    int signal = 0;
+    double wall_seconds = 0;
+    double user_seconds = 0;
+    double system_seconds = 0;
+    int64_t max_rss_kib = 0;
+    int64_t voluntary_context_switches = 0;
+    int64_t involuntary_context_switches = 0;
+    int64_t block_input_operations = 0;
+    int64_t block_output_operations = 0;
+    // Set when hardware counters were requested and available, otherwise
+    // counters_error says why they are missing.
+    std::optional<fx::command::forwarder::counters::sample_t> counters;
+    std::string counters_error;
+  };
+
+  // Spawns `argv` with `envp` and waits for it. SIGTERM, SIGHUP, SIGUSR1 and
+  // SIGUSR2 sent to fx are forwarded to the child. SIGINT and SIGQUIT are
+  // ignored by fx meanwhile, since the terminal already delivers them to the
+  // child. With `hardware_counters`, the child's process tree is also
+  // measured with perf counters.
+  fx::result::Result<report_t> run(char* const* argv, char* const* envp,
+                                   bool hardware_counters = false);
+
+  nlohmann::json to_json(const std::string& command_name,
+                         const report_t& report);
+
+  std::string format(const std::string& command_name, const report_t& report);
+
+  // Exits fx the way the child exited: with the same code, or killed by the
+  // same signal.
+  [[noreturn]] void pass_through(const report_t& report);
+}  // namespace fx::command::forwarder::supervise
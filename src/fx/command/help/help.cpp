@@ -4,8 +4,7 @@
 namespace fx::command {
   Help::Help() = default;
 
-  fx::result::Result<void> Help::run(
-      const std::vector<std::string>& /*arguments*/) {
+  fx::result::Result<void> Help::run(fx::util::arguments_t /*arguments*/) {
     fmt::print(
         "fx is a workspace tool manager. Learn more: "
         "https://github.com/jathu/fx\n");
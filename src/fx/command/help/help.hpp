@@ -7,7 +7,6 @@ namespace fx::command {
   class Help : public fx::command::Base {
    public:
     Help();
-    fx::result::Result<void> run(
-        const std::vector<std::string>& arguments) override;
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
   };
 }  // namespace fx::command
@@ -1,10 +1,14 @@
 #include "list.hpp"
 #include <fmt/color.h>
 #include <fmt/core.h>
-#include <spdlog/spdlog.h>
+#include <google/protobuf/arena.h>
 #include <algorithm>
+#include <iterator>
 #include <set>
 #include <unordered_map>
+#include "fx/cache/cache.hpp"
+#include "fx/embedded/embedded.hpp"
+#include "fx/log/log.hpp"
 #include "fx/parser/parser.hpp"
 #include "fx/util/util.hpp"
 
@@ -16,12 +20,40 @@ namespace fx::command {
           {"list", "List available commands."},
           {"help", "Learn more about fx."},
           {"version", "Print the fx version."},
+          {"stats", "Show how often and how long commands run."},
+          {"run", "Run several commands concurrently."},
+          {"batch", "Run the commands read from stdin."},
+          {"install-shims", "Write an fx-<command> launcher per command."},
       };
 
   static const std::string spacing{"    "};
 
-  fx::result::Result<void> List::run(
-      const std::vector<std::string>& /*arguments*/) {
+  // Always dispatched to fx itself, see fx::dispatcher::Dispatcher. The
+  // commands fx added later yield to workspace commands of the same name.
+  static bool is_reserved_command(const std::string& command_name) {
+    return command_name == "list" || command_name == "help" ||
+           command_name == "version";
+  }
+
+  static void warn_shadowed(const std::vector<std::string>& command_names) {
+    std::vector<std::string> shadowed;
+    std::copy_if(command_names.begin(), command_names.end(),
+                 std::back_inserter(shadowed), is_reserved_command);
+    if (!shadowed.empty()) {
+      fmt::print("\n");
+    }
+    for (const auto& command_name : shadowed) {
+      fmt::print(fg(fmt::terminal_color::yellow),
+                 "\"{0}\" is shadowed by fx {0}; run it through its shim "
+                 "(fx install-shims) or rename it.",
+                 command_name);
+      fmt::print("\n");
+    }
+  }
+
+  static const std::vector<char>::size_type arena_block_size = 64 * 1024;
+
+  fx::result::Result<void> List::run(fx::util::arguments_t /*arguments*/) {
     fmt::print("{0} — workspace tool manager [version {1}]\n\n",
                fmt::format(fmt::emphasis::bold, "fx"), FX_VERSION);
     fmt::print("Usage:  fx <command> --help\n");
@@ -40,63 +72,127 @@ namespace fx::command {
       const auto& workspace_path = workspace_path_result.value();
       fmt::print("\n[workspace {0}]\n", workspace_path.u8string());
 
+      if (const auto* embedded = fx::embedded::workspace();
+          embedded != nullptr) {
+        std::vector<std::string> command_names;
+        for (const auto& command : embedded->commands) {
+          if (command.listed) {
+            fmt::print("{0}{1} - {2}\n", spacing, command.name,
+                       command.synopsis);
+            command_names.emplace_back(command.name);
+          }
+        }
+        warn_shadowed(command_names);
+        return fx::result::Ok();
+      }
+
       const auto workspace_result =
           fx::parser::parse_workspace_descriptor(workspace_path);
       if (workspace_result.failed()) {
         return fx::result::Error(workspace_result.error());
       } else {
-        const auto workspace = workspace_result.value();
-        const auto commands =
-            list_workspace_commands(workspace_path, workspace);
-        for (const auto& command : commands) {
-          fmt::print("{0}{1} - {2}\n", spacing, command.command_name,
-                     command.synopsis);
-        }
+        const auto& workspace = workspace_result.value();
+        std::vector<std::string> command_names;
+        stream_workspace_commands(
+            workspace_path, workspace, [&](const search_result_t& command) {
+              fmt::print("{0}{1} - {2}\n", spacing, command.command_name,
+                         command.synopsis);
+              command_names.push_back(command.command_name);
+            });
+        warn_shadowed(command_names);
+        // Refreshes the index behind suggestions for unknown commands.
+        fx::cache::store_command_index(workspace_path, fx::cache::directory(),
+                                       std::move(command_names));
       }
     }
 
     return fx::result::Ok();
   }
 
-  std::vector<search_result_t> List::list_workspace_commands(
-      const std::filesystem::path& workspace_descriptor_path,
-      const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace) {
-    std::vector<search_result_t> commands;
-    const auto descriptor_paths =
-        list_command_descriptor_paths(workspace_descriptor_path, workspace);
-    const auto workspace_directory_size =
-        workspace_descriptor_path.parent_path().u8string().size() + 1;
-
-    for (auto const& descriptor_path : descriptor_paths) {
-      search_result_t search_result;
-      search_result.command_name =
-          descriptor_path.parent_path().u8string().replace(
-              0, workspace_directory_size, "");
-      const auto descriptor_result =
-          fx::parser::parse_command_descriptor(descriptor_path);
-      if (descriptor_result.ok()) {
-        search_result.synopsis = descriptor_result.value().synopsis();
-      } else {
-        search_result.synopsis =
-            fmt::format(fg(fmt::terminal_color::red),
-                        "Descriptor contains errors. Run this to learn more.",
-                        search_result.command_name);
+  fx::result::Result<std::vector<std::string>> List::command_names(
+      const std::filesystem::path& workspace_descriptor_path) {
+    std::vector<std::string> names;
+    if (const auto* embedded = fx::embedded::workspace();
+        embedded != nullptr) {
+      for (const auto& command : embedded->commands) {
+        if (command.listed) {
+          names.emplace_back(command.name);
+        }
       }
-      commands.emplace_back(search_result);
+      return fx::result::Ok(std::move(names));
+    }
+
+    auto workspace_result =
+        fx::cache::load_workspace(workspace_descriptor_path);
+    if (workspace_result.failed()) {
+      return fx::result::Error(std::move(workspace_result).error());
     }
+    walk_command_descriptor_paths(
+        workspace_descriptor_path,
+        workspace_result.value().workspace_descriptor(),
+        [&](const std::filesystem::path& /*descriptor_path*/,
+            const std::string& command_name) {
+          names.push_back(command_name);
+        },
+        [](const std::optional<std::string>& /*horizon*/) {});
+    return fx::result::Ok(std::move(names));
+  }
+
+  void List::stream_workspace_commands(
+      const std::filesystem::path& workspace_descriptor_path,
+      const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace,
+      const std::function<void(const search_result_t&)>& emit) {
+    // Commands are parsed as soon as they are found, but only emitted once no
+    // command still to be found can sort before them. Anything else waits
+    // here, so this only ever holds the out of order part of the walk.
+    std::set<search_result_t> pending;
 
-    std::sort(commands.begin(), commands.end(),
-              [](const auto& left, const auto& right) {
-                return left.command_name < right.command_name;
-              });
+    // Descriptors only need to live long enough to read their synopsis, so
+    // they all share one block of memory that is reset after each parse. This
+    // only covers the messages: reading the YAML and converting it to JSON
+    // still allocate per node, and account for most of a parse.
+    std::vector<char> arena_block(arena_block_size);
+    google::protobuf::ArenaOptions arena_options;
+    arena_options.initial_block = arena_block.data();
+    arena_options.initial_block_size = arena_block.size();
+    google::protobuf::Arena arena(arena_options);
 
-    return commands;
+    walk_command_descriptor_paths(
+        workspace_descriptor_path, workspace,
+        [&](const std::filesystem::path& descriptor_path,
+            const std::string& command_name) {
+          search_result_t search_result;
+          search_result.command_name = command_name;
+          const auto descriptor_result =
+              fx::parser::parse_command_descriptor(descriptor_path, &arena);
+          if (descriptor_result.ok()) {
+            search_result.synopsis = descriptor_result.value()->synopsis();
+          } else {
+            search_result.synopsis = fmt::format(
+                fg(fmt::terminal_color::red),
+                "Descriptor contains errors. Run this to learn more.");
+          }
+          pending.emplace(std::move(search_result));
+          arena.Reset();
+        },
+        [&](const std::optional<std::string>& horizon) {
+          while (!pending.empty() &&
+                 (!horizon || pending.begin()->command_name < *horizon)) {
+            emit(*pending.begin());
+            pending.erase(pending.begin());
+          }
+        });
   }
 
-  std::vector<std::filesystem::path> List::list_command_descriptor_paths(
+  void List::walk_command_descriptor_paths(
       const std::filesystem::path& workspace_descriptor_path,
-      const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace) {
-    std::vector<std::filesystem::path> descriptor_paths;
+      const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace,
+      const descriptor_visitor_t& visit_descriptor,
+      const horizon_visitor_t& visit_horizon) {
+    if (workspace_descriptor_path.empty()) {
+      visit_horizon(std::nullopt);
+      return;
+    }
 
     std::set<std::filesystem::path> paths_to_ignore;
     for (const auto& ignore : workspace.ignore()) {
@@ -105,25 +201,78 @@ namespace fx::command {
                                  .lexically_normal());
     }
 
-    if (!workspace_descriptor_path.empty()) {
-      std::filesystem::recursive_directory_iterator current_entry(
-          workspace_descriptor_path.parent_path());
-      const std::filesystem::recursive_directory_iterator end_entry;
-      for (; current_entry != end_entry; current_entry++) {
-        auto const filename = current_entry->path().filename();
-        if (filename == "command.fx.yaml") {
-          descriptor_paths.push_back(current_entry->path());
-        } else if ((current_entry->is_directory() &&
-                    strncmp(filename.c_str(), ".", 1) == 0) ||
-                   (paths_to_ignore.find(current_entry->path()) !=
-                    paths_to_ignore.end())) {
-          spdlog::debug("Ignoring command search in {0}",
-                        current_entry->path().u8string());
-          current_entry.disable_recursion_pending();
+    struct frame_t {
+      std::filesystem::path directory;
+      std::string command_name;
+      std::vector<std::string> children;
+      std::vector<std::string>::size_type next;
+    };
+
+    // Directories are walked depth first with their children sorted, so the
+    // next unvisited child of each open directory bounds what comes next.
+    const auto open_frame = [&](const std::filesystem::path& directory,
+                                const std::string& command_name) {
+      frame_t frame{directory, command_name, {}, 0};
+      for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (!entry.is_directory() || entry.is_symlink()) {
+          continue;
+        }
+        const auto filename = entry.path().filename().u8string();
+        if (strncmp(filename.c_str(), ".", 1) == 0 ||
+            paths_to_ignore.find(entry.path()) != paths_to_ignore.end()) {
+          FX_LOG_DEBUG("Ignoring command search in {0}",
+                       entry.path().u8string());
+          continue;
+        }
+        frame.children.emplace_back(filename);
+      }
+      std::sort(frame.children.begin(), frame.children.end());
+      return frame;
+    };
+
+    const auto horizon = [](const std::vector<frame_t>& stack) {
+      std::optional<std::string> lower_bound;
+      for (const auto& frame : stack) {
+        if (frame.next < frame.children.size()) {
+          const auto& child = frame.children[frame.next];
+          auto command_name = frame.command_name.empty()
+                                  ? child
+                                  : frame.command_name + "/" + child;
+          if (!lower_bound || command_name < *lower_bound) {
+            lower_bound = std::move(command_name);
+          }
         }
       }
+      return lower_bound;
+    };
+
+    std::vector<frame_t> stack;
+    stack.emplace_back(
+        open_frame(workspace_descriptor_path.parent_path(), std::string()));
+
+    while (!stack.empty()) {
+      if (stack.back().next == stack.back().children.size()) {
+        stack.pop_back();
+        continue;
+      }
+
+      const auto& parent = stack.back();
+      const auto& child = parent.children[parent.next];
+      const auto directory = parent.directory / child;
+      const auto command_name = parent.command_name.empty()
+                                    ? child
+                                    : parent.command_name + "/" + child;
+      stack.back().next++;
+      stack.emplace_back(open_frame(directory, command_name));
+
+      const auto descriptor_path =
+          directory / std::filesystem::path("command.fx.yaml");
+      if (std::filesystem::exists(descriptor_path)) {
+        visit_descriptor(descriptor_path, command_name);
+      }
+      visit_horizon(horizon(stack));
     }
 
-    return descriptor_paths;
+    visit_horizon(std::nullopt);
   }
 }  // namespace fx::command
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
+#include <optional>
 #include <tuple>
+#include <vector>
 #include "fx/command/base/base.hpp"
 #include "fx/descriptor/v1beta/descriptor.pb.h"
 #include "fx/result/result.hpp"
@@ -11,22 +14,41 @@ namespace fx::command {
     struct search_result_t {
       std::string command_name;
       std::string synopsis;
+
+      bool operator<(const search_result_t& other) const {
+        return command_name < other.command_name;
+      }
     };
   }  // namespace
 
+  // Called for every command descriptor found while walking the workspace.
+  // `horizon` is a lower bound of every command name the walk can still
+  // produce, or std::nullopt once nothing else can be found.
+  typedef std::function<void(const std::filesystem::path& descriptor_path,
+                             const std::string& command_name)>
+      descriptor_visitor_t;
+  typedef std::function<void(const std::optional<std::string>& horizon)>
+      horizon_visitor_t;
+
   class List : public fx::command::Base {
    public:
     List();
-    fx::result::Result<void> run(
-        const std::vector<std::string>& arguments) override;
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
 
-   private:
-    static std::vector<search_result_t> list_workspace_commands(
+    // The names of the commands fx list shows.
+    static fx::result::Result<std::vector<std::string>> command_names(
+        const std::filesystem::path& workspace_descriptor_path);
+
+    static void walk_command_descriptor_paths(
         const std::filesystem::path& workspace_descriptor_path,
-        const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace);
+        const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace,
+        const descriptor_visitor_t& visit_descriptor,
+        const horizon_visitor_t& visit_horizon);
 
-    static std::vector<std::filesystem::path> list_command_descriptor_paths(
+   private:
+    static void stream_workspace_commands(
         const std::filesystem::path& workspace_descriptor_path,
-        const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace);
+        const fx::descriptor::v1beta::FxWorkspaceDescriptor& workspace,
+        const std::function<void(const search_result_t&)>& emit);
   };
 }  // namespace fx::command
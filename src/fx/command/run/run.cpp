@@ -0,0 +1,240 @@
+#include "run.hpp"
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include "fx/command/forwarder/forwarder.hpp"
+#include "fx/command/forwarder/pool/pool.hpp"
+#include "fx/history/sketch/sketch.hpp"
+#include "fx/metrics/metrics.hpp"
+#include "fx/util/util.hpp"
+
+namespace fx::command {
+  namespace {
+    struct job_t {
+      std::string command;
+      fx::history::entry_t history_entry;
+      fx::metrics::observation_t observation;
+    };
+
+    std::string status(int exit_code, int signal) {
+      if (signal != 0) {
+        return fmt::format("signal {0}", signal);
+      }
+      return fmt::format("exit code {0}", exit_code);
+    }
+
+    void print(const std::string& command,
+               double seconds,
+               const std::string& status,
+               const std::string& output) {
+      std::string block = fmt::format(
+          "{0} · {1:.2f}s · {2}\n",
+          fmt::format(fmt::emphasis::bold, "fx run · {0}", command), seconds,
+          status);
+      block += output;
+      if (!output.empty() && output.back() != '\n') {
+        block += '\n';
+      }
+      fx::command::forwarder::pool::print(block);
+    }
+  }  // namespace
+
+  Run::Run() = default;
+
+  fx::result::Result<void> Run::run(fx::util::arguments_t arguments) {
+    const auto started = std::chrono::steady_clock::now();
+
+    unsigned jobs = fx::command::forwarder::pool::default_jobs();
+    std::vector<std::string> commands;
+    for (std::size_t index = 0; index < arguments.size(); index++) {
+      auto jobs_result = fx::command::forwarder::pool::parse_jobs_option(
+          arguments, index, jobs);
+      if (jobs_result.failed()) {
+        return fx::result::Error(std::move(jobs_result).error());
+      }
+      if (jobs_result.value()) {
+        continue;
+      }
+      const std::string_view argument = arguments[index];
+      if (!argument.empty() && argument[0] == '-') {
+        return fx::result::Error(
+            fmt::format("Unknown option \"{0}\".", argument));
+      }
+      commands.emplace_back(argument);
+    }
+    if (commands.empty()) {
+      return fx::result::Error(
+          std::string("Usage: fx run [--jobs=<n>] <command>..."));
+    }
+
+    auto workspace_result = fx::command::forwarder::pool::load_workspace();
+    if (workspace_result.failed()) {
+      return fx::result::Error(std::move(workspace_result).error());
+    }
+    const auto& shared = workspace_result.value();
+    const auto& workspace_path = shared.path;
+    const auto& workspace = shared.entry.workspace_descriptor();
+
+    std::vector<job_t> prepared;
+    std::vector<fx::command::forwarder::pool::task_t> tasks;
+    prepared.reserve(commands.size());
+    tasks.reserve(commands.size());
+    for (const auto& command : commands) {
+      fx::command::Forwarder forwarder(command);
+      forwarder.configure(workspace);
+
+      job_t job;
+      job.command = command;
+      job.observation.workspace = workspace_path.parent_path().u8string();
+      job.observation.command = command;
+      job.observation.seconds[fx::metrics::PHASE_DISCOVERY] =
+          shared.discovery_seconds;
+
+      auto phase_started = std::chrono::steady_clock::now();
+      auto descriptor_result =
+          forwarder.parse_command_descriptor(workspace_path);
+      if (descriptor_result.failed()) {
+        return fx::result::Error(std::move(descriptor_result).error());
+      }
+      const auto& descriptor = descriptor_result.value();
+      if (descriptor.runtime().has_plugin()) {
+        return fx::result::Error(fmt::format(
+            "Plugin command \"{0}\" cannot be run by fx run.", command));
+      }
+      job.observation.seconds[fx::metrics::PHASE_PARSE] =
+          shared.parse_seconds + fx::util::seconds_since(phase_started);
+
+      phase_started = std::chrono::steady_clock::now();
+      auto command_arguments_result =
+          forwarder.parse_command_arguments(descriptor, {});
+      if (command_arguments_result.failed()) {
+        return fx::result::Error(
+            fmt::format("{0}: {1}", command,
+                        std::move(command_arguments_result).error()));
+      }
+      job.observation.seconds[fx::metrics::PHASE_ARGPARSE] =
+          fx::util::seconds_since(phase_started);
+
+      auto execution_arguments_result = forwarder.collate_execution_arguments(
+          descriptor, command_arguments_result.value());
+      if (execution_arguments_result.failed()) {
+        return fx::result::Error(
+            fmt::format("{0}: {1}", command,
+                        std::move(execution_arguments_result).error()));
+      }
+
+      fx::command::forwarder::pool::task_t task;
+      task.arguments = std::move(execution_arguments_result).value();
+      task.environment =
+          forwarder.collate_enviornment_variables(descriptor, workspace_path);
+      tasks.push_back(std::move(task));
+
+      job.history_entry.workspace_hash = shared.hash;
+      job.history_entry.command = command;
+      prepared.push_back(std::move(job));
+    }
+
+    const auto order = schedule_longest_first(
+        commands,
+        estimate_runtimes(fx::history::read(shared.history_path), shared.hash));
+
+    std::vector<std::string> failed;
+    const auto start = [&](std::size_t index) {
+      auto& entry = prepared[index].history_entry;
+      entry.timestamp_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count();
+      entry.fx_overhead_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - started)
+              .count();
+    };
+    const auto finish =
+        [&](std::size_t index,
+            const fx::command::forwarder::pool::outcome_t& outcome) {
+          job_t& job = prepared[index];
+          print(job.command, outcome.wall_seconds,
+                status(outcome.exit_code, outcome.signal), outcome.output);
+          const bool job_failed = outcome.exit_code != 0 || outcome.signal != 0;
+          if (job_failed) {
+            failed.push_back(job.command);
+          }
+
+          job.history_entry.child_wall_us =
+              static_cast<int64_t>(outcome.wall_seconds * 1e6);
+          job.history_entry.max_rss_kib = outcome.max_rss_kib;
+          job.history_entry.exit_code = outcome.exit_code;
+          job.history_entry.signal = outcome.signal;
+          fx::history::append(shared.history_path, job.history_entry);
+
+          job.observation.seconds[fx::metrics::PHASE_CHILD] =
+              outcome.wall_seconds;
+          job.observation.failed = job_failed;
+          fx::metrics::record(fx::metrics::table_path(shared.cache_directory),
+                              fx::metrics::export_path(), job.observation);
+        };
+
+    auto pool_result =
+        fx::command::forwarder::pool::run(tasks, order, jobs, start, finish);
+    if (pool_result.failed()) {
+      return fx::result::Error(std::move(pool_result).error());
+    }
+
+    fmt::print("{0} · {1} commands · {2:.2f}s\n",
+               fmt::format(fmt::emphasis::bold, "fx run"), commands.size(),
+               fx::util::seconds_since(started));
+    if (!failed.empty()) {
+      return fx::result::Error(
+          fmt::format("{0} of {1} commands failed: {2}.", failed.size(),
+                      commands.size(), fmt::join(failed, ", ")));
+    }
+    return fx::result::Ok();
+  }
+
+  std::unordered_map<std::string, double> estimate_runtimes(
+      const std::vector<fx::history::entry_t>& entries,
+      uint64_t workspace_hash) {
+    std::unordered_map<std::string, fx::history::sketch::Sketch> sketches;
+    for (const auto& entry : entries) {
+      if (entry.workspace_hash == workspace_hash &&
+          entry.child_wall_us.has_value()) {
+        sketches[entry.command].add(static_cast<double>(*entry.child_wall_us));
+      }
+    }
+
+    std::unordered_map<std::string, double> estimates;
+    for (const auto& [command, sketch] : sketches) {
+      estimates[command] = sketch.quantile(0.5);
+    }
+    return estimates;
+  }
+
+  std::vector<std::size_t> schedule_longest_first(
+      const std::vector<std::string>& commands,
+      const std::unordered_map<std::string, double>& estimates) {
+    std::vector<std::size_t> order(commands.size());
+    for (std::size_t index = 0; index < order.size(); index++) {
+      order[index] = index;
+    }
+
+    const auto estimate = [&](std::size_t index) {
+      const auto found = estimates.find(commands[index]);
+      return found == estimates.end() ? std::optional<double>()
+                                      : std::optional<double>(found->second);
+    };
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t left, std::size_t right) {
+                       const auto left_estimate = estimate(left);
+                       const auto right_estimate = estimate(right);
+                       if (!right_estimate.has_value()) {
+                         return false;
+                       }
+                       return !left_estimate.has_value() ||
+                              *left_estimate > *right_estimate;
+                     });
+    return order;
+  }
+}  // namespace fx::command
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "fx/command/base/base.hpp"
+#include "fx/history/history.hpp"
+#include "fx/result/result.hpp"
+
+namespace fx::command {
+  // Runs several workspace commands concurrently, longest first, each with
+  // its default arguments. The output of a command is printed in one piece
+  // once it exits.
+  class Run : public fx::command::Base {
+   public:
+    Run();
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
+  };
+
+  // The median run time in microseconds of every command in the workspace
+  // that fx supervised at least once.
+  std::unordered_map<std::string, double> estimate_runtimes(
+      const std::vector<fx::history::entry_t>& entries,
+      uint64_t workspace_hash);
+
+  // Indices into `commands`, longest estimate first. Commands without an
+  // estimate go ahead of all others, as they might be the longest.
+  std::vector<std::size_t> schedule_longest_first(
+      const std::vector<std::string>& commands,
+      const std::unordered_map<std::string, double>& estimates);
+}  // namespace fx::command
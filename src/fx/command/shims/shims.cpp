@@ -0,0 +1,231 @@
+#include "shims.hpp"
+#include <fmt/core.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <vector>
+#include "fx/command/forwarder/forwarder.hpp"
+#include "fx/command/list/list.hpp"
+#include "fx/log/log.hpp"
+#include "fx/util/util.hpp"
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+namespace fx::command {
+  namespace {
+    const std::string_view shim_option = "--fx-shim";
+
+    // Older Linux kernels truncate interpreter lines after 127 characters.
+    const std::size_t max_interpreter_line = 127;
+
+    fx::result::Result<std::filesystem::path> executable_path() {
+#ifdef __APPLE__
+      uint32_t size = 0;
+      _NSGetExecutablePath(nullptr, &size);
+      std::string path(size, '\0');
+      if (_NSGetExecutablePath(path.data(), &size) != 0) {
+        return fx::result::Error(std::string("Unable to locate fx."));
+      }
+      path.resize(path.find('\0'));
+#else
+      std::error_code error;
+      const auto path = std::filesystem::read_symlink("/proc/self/exe", error);
+      if (error) {
+        return fx::result::Error(
+            fmt::format("Unable to locate fx: {0}.", error.message()));
+      }
+#endif
+      std::error_code canonical_error;
+      const auto canonical =
+          std::filesystem::canonical(path, canonical_error);
+      return fx::result::Ok(canonical_error ? std::filesystem::path(path)
+                                            : canonical);
+    }
+
+    std::optional<std::string> read_file(const std::filesystem::path& path) {
+      std::ifstream input(path, std::ios::binary);
+      if (!input) {
+        return std::nullopt;
+      }
+      return std::string(std::istreambuf_iterator<char>(input),
+                         std::istreambuf_iterator<char>());
+    }
+  }  // namespace
+
+  std::string shim_name(const std::string& command_name) {
+    std::string name = "fx-" + command_name;
+    std::replace(name.begin(), name.end(), '/', '-');
+    return name;
+  }
+
+  std::string render_shim(const std::filesystem::path& fx_path,
+                          const shim_t& shim) {
+    return fmt::format(
+        "#!{0} {1}\n"
+        "# Generated by fx install-shims, rerun it when commands change.\n"
+        "{2}\n"
+        "{3}\n",
+        fx_path.u8string(), shim_option,
+        shim.workspace_descriptor_path.u8string(), shim.command_name);
+  }
+
+  fx::result::Result<shim_t> parse_shim(std::string_view contents) {
+    std::vector<std::string_view> lines;
+    while (!contents.empty()) {
+      const auto end = contents.find('\n');
+      const auto line = contents.substr(0, end);
+      if (!line.empty() && line[0] != '#') {
+        lines.push_back(line);
+      }
+      contents.remove_prefix(end == std::string_view::npos ? contents.size()
+                                                           : end + 1);
+    }
+    if (lines.size() != 2) {
+      return fx::result::Error(std::string(
+          "Expected the workspace descriptor and the command name."));
+    }
+    return fx::result::Ok(
+        shim_t{std::filesystem::path(lines[0]), std::string(lines[1])});
+  }
+
+  // InstallShims --------------------------------------------------------------
+
+  InstallShims::InstallShims() = default;
+
+  fx::result::Result<void> InstallShims::run(fx::util::arguments_t arguments) {
+    if (arguments.size() != 1) {
+      return fx::result::Error(
+          std::string("Usage: fx install-shims <directory>"));
+    }
+    const std::filesystem::path directory(arguments[0]);
+
+    auto fx_path_result = executable_path();
+    if (fx_path_result.failed()) {
+      return fx::result::Error(std::move(fx_path_result).error());
+    }
+    const auto& fx_path = fx_path_result.value();
+    if (fmt::format("#!{0} {1}", fx_path.u8string(), shim_option).size() >
+        max_interpreter_line) {
+      return fx::result::Error(fmt::format(
+          "The path of fx, {0}, is too long for a shim.", fx_path.u8string()));
+    }
+
+    auto workspace_path_result = fx::util::workspace_descriptor_path();
+    if (workspace_path_result.failed()) {
+      return fx::result::Error(std::move(workspace_path_result).error());
+    }
+    const auto& workspace_path = workspace_path_result.value();
+
+    auto names_result =
+        fx::command::List::command_names(workspace_path);
+    if (names_result.failed()) {
+      return fx::result::Error(std::move(names_result).error());
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+      return fx::result::Error(fmt::format("Unable to create {0}: {1}.",
+                                           directory.u8string(),
+                                           error.message()));
+    }
+
+    std::map<std::string, std::string> shims;
+    for (const auto& command_name : names_result.value()) {
+      const auto name = shim_name(command_name);
+      if (!shims.emplace(name, render_shim(fx_path, {workspace_path,
+                                                     command_name}))
+               .second) {
+        FX_LOG_WARN("Skipping the shim for \"{0}\", {1} is taken.",
+                    command_name, name);
+      }
+    }
+
+    std::size_t added = 0;
+    std::size_t updated = 0;
+    std::size_t removed = 0;
+    for (const auto& [name, contents] : shims) {
+      const auto path = directory / name;
+      const auto existing = read_file(path);
+      if (existing == contents) {
+        continue;
+      }
+      // Replaced at once, so a shim is never run half written.
+      auto write_result = fx::util::write_atomically(
+          path, contents,
+          std::filesystem::perms::owner_all |
+              std::filesystem::perms::group_read |
+              std::filesystem::perms::group_exec |
+              std::filesystem::perms::others_read |
+              std::filesystem::perms::others_exec);
+      if (write_result.failed()) {
+        return write_result;
+      }
+      (existing.has_value() ? updated : added)++;
+    }
+
+    // Shims of this workspace whose command is gone. Anything else in the
+    // directory, including shims of other workspaces, is left alone.
+    const auto interpreter_suffix = fmt::format(" {0}", shim_option);
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+      const auto name = entry.path().filename().u8string();
+      if (name.rfind("fx-", 0) != 0 || shims.count(name) != 0 ||
+          !entry.is_regular_file()) {
+        continue;
+      }
+      const auto contents = read_file(entry.path());
+      if (!contents.has_value() || contents->rfind("#!", 0) != 0) {
+        continue;
+      }
+      const auto interpreter = contents->substr(0, contents->find('\n'));
+      if (interpreter.size() < interpreter_suffix.size() ||
+          interpreter.compare(interpreter.size() - interpreter_suffix.size(),
+                              interpreter_suffix.size(),
+                              interpreter_suffix) != 0) {
+        continue;
+      }
+      const auto shim = parse_shim(*contents);
+      if (shim.ok() &&
+          shim.value().workspace_descriptor_path == workspace_path &&
+          std::filesystem::remove(entry.path(), error)) {
+        removed++;
+      }
+    }
+
+    fmt::print("{0} shims in {1}: {2} added, {3} updated, {4} removed.\n",
+               shims.size(), directory.u8string(), added, updated, removed);
+    return fx::result::Ok();
+  }
+
+  // Shim ----------------------------------------------------------------------
+
+  Shim::Shim() = default;
+
+  fx::result::Result<void> Shim::run(fx::util::arguments_t arguments) {
+    if (arguments.empty()) {
+      return fx::result::Error(fmt::format("Usage: fx {0} <shim> <args...>",
+                                           shim_option));
+    }
+    const std::filesystem::path shim_path(arguments[0]);
+
+    const auto contents = read_file(shim_path);
+    if (!contents.has_value()) {
+      return fx::result::Error(
+          fmt::format("Unable to read shim {0}.", shim_path.u8string()));
+    }
+    auto shim_result = parse_shim(*contents);
+    if (shim_result.failed()) {
+      return fx::result::Error(fmt::format("Invalid shim {0}: {1}",
+                                           shim_path.u8string(),
+                                           shim_result.error()));
+    }
+    auto shim = std::move(shim_result).take();
+
+    fx::command::Forwarder forwarder(shim.command_name,
+                                     shim.workspace_descriptor_path);
+    return forwarder.run(arguments.subspan(1));
+  }
+}  // namespace fx::command
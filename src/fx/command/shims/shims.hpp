@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include "fx/command/base/base.hpp"
+#include "fx/result/result.hpp"
+
+// Per-command launchers, i.e. fx-format, that name their workspace so fx can
+// skip finding it. A shim is a script whose interpreter is fx itself, so
+// running one execs fx directly without a shell in between.
+namespace fx::command {
+  struct shim_t {
+    std::filesystem::path workspace_descriptor_path;
+    std::string command_name;
+  };
+
+  // The file name of the shim for `command_name`, i.e. fx-tools-format for
+  // tools/format.
+  std::string shim_name(const std::string& command_name);
+
+  std::string render_shim(const std::filesystem::path& fx_path,
+                          const shim_t& shim);
+
+  fx::result::Result<shim_t> parse_shim(std::string_view contents);
+
+  // Writes a shim for every listed command of the current workspace into the
+  // directory, only touching shims that changed and removing those of
+  // commands that no longer exist.
+  class InstallShims : public fx::command::Base {
+   public:
+    InstallShims();
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
+  };
+
+  // Runs a shim, given its path and the arguments for the command.
+  class Shim : public fx::command::Base {
+   public:
+    Shim();
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
+  };
+}  // namespace fx::command
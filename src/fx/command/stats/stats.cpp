@@ -0,0 +1,97 @@
+#include "stats.hpp"
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <string>
+#include "fx/cache/cache.hpp"
+#include "fx/history/history.hpp"
+#include "fx/history/sketch/sketch.hpp"
+#include "fx/util/util.hpp"
+
+namespace fx::command {
+  namespace {
+    struct summary_t {
+      uint64_t runs = 0;
+      uint64_t failed = 0;
+      // Only runs fx supervised.
+      fx::history::sketch::Sketch wall;
+      fx::history::sketch::Sketch overhead;
+    };
+
+    std::string duration(const fx::history::sketch::Sketch& sketch,
+                         double quantile) {
+      if (sketch.count() == 0) {
+        return "-";
+      }
+      const double microseconds = sketch.quantile(quantile);
+      if (microseconds < 1e3) {
+        return fmt::format("{0:.0f}µs", microseconds);
+      } else if (microseconds < 1e6) {
+        return fmt::format("{0:.1f}ms", microseconds / 1e3);
+      }
+      return fmt::format("{0:.2f}s", microseconds / 1e6);
+    }
+  }  // namespace
+
+  Stats::Stats() = default;
+
+  fx::result::Result<void> Stats::run(fx::util::arguments_t /*arguments*/) {
+    const auto history_path = fx::history::path(fx::cache::directory());
+    const auto entries = fx::history::read(history_path);
+    fmt::print("{0} — {1} invocations recorded in {2}\n\n",
+               fmt::format(fmt::emphasis::bold, "fx stats"), entries.size(),
+               history_path.u8string());
+
+    std::optional<uint64_t> workspace_hash;
+    const auto workspace_path_result = fx::util::workspace_descriptor_path();
+    if (workspace_path_result.ok()) {
+      const auto& workspace_path = workspace_path_result.value();
+      workspace_hash = fx::history::hash(workspace_path.u8string());
+      fmt::print("[workspace {0}]\n", workspace_path.u8string());
+    } else {
+      fmt::print("[all workspaces]\n");
+    }
+
+    std::map<std::string, summary_t> summaries;
+    for (const auto& entry : entries) {
+      if (workspace_hash.has_value() &&
+          entry.workspace_hash != *workspace_hash) {
+        continue;
+      }
+      auto& summary = summaries[entry.command];
+      summary.runs++;
+      summary.overhead.add(static_cast<double>(entry.fx_overhead_us));
+      if (entry.child_wall_us.has_value()) {
+        summary.wall.add(static_cast<double>(*entry.child_wall_us));
+        if (entry.exit_code != 0 || entry.signal != 0) {
+          summary.failed++;
+        }
+      }
+    }
+
+    if (summaries.empty()) {
+      fmt::print("    No commands recorded yet.\n");
+      return fx::result::Ok();
+    }
+
+    std::size_t width = std::string("command").size();
+    for (const auto& [command, summary] : summaries) {
+      width = std::max(width, command.size());
+    }
+    fmt::print("    {0:<{1}}  {2:>6}  {3:>6}  {4:>8}  {5:>8}  {6:>8}  {7:>8}\n",
+               "command", width, "runs", "failed", "p50", "p95", "p99",
+               "fx p50");
+    for (const auto& [command, summary] : summaries) {
+      fmt::print(
+          "    {0:<{1}}  {2:>6}  {3:>6}  {4:>8}  {5:>8}  {6:>8}  {7:>8}\n",
+          command, width, summary.runs,
+          summary.wall.count() == 0 ? "-" : std::to_string(summary.failed),
+          duration(summary.wall, 0.5), duration(summary.wall, 0.95),
+          duration(summary.wall, 0.99), duration(summary.overhead, 0.5));
+    }
+
+    return fx::result::Ok();
+  }
+}  // namespace fx::command
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "fx/command/base/base.hpp"
+#include "fx/result/result.hpp"
+
+namespace fx::command {
+  class Stats : public fx::command::Base {
+   public:
+    Stats();
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
+  };
+}  // namespace fx::command
@@ -4,8 +4,7 @@
 namespace fx::command {
   Version::Version() = default;
 
-  fx::result::Result<void> Version::run(
-      const std::vector<std::string>& /*arguments*/) {
+  fx::result::Result<void> Version::run(fx::util::arguments_t /*arguments*/) {
     fmt::print("fx-{0}\n", FX_VERSION);
     return fx::result::Ok();
   }
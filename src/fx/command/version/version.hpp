@@ -7,7 +7,6 @@ namespace fx::command {
   class Version : public fx::command::Base {
    public:
     Version();
-    fx::result::Result<void> run(
-        const std::vector<std::string>& arguments) override;
+    fx::result::Result<void> run(fx::util::arguments_t arguments) override;
   };
 }  // namespace fx::command
@@ -1,10 +1,16 @@
 #include "dispatcher.hpp"
 #include <fmt/core.h>
-#include <spdlog/spdlog.h>
+#include <filesystem>
+#include "fx/command/batch/batch.hpp"
 #include "fx/command/forwarder/forwarder.hpp"
 #include "fx/command/help/help.hpp"
 #include "fx/command/list/list.hpp"
+#include "fx/command/run/run.hpp"
+#include "fx/command/shims/shims.hpp"
+#include "fx/command/stats/stats.hpp"
 #include "fx/command/version/version.hpp"
+#include "fx/embedded/embedded.hpp"
+#include "fx/log/log.hpp"
 
 namespace fx::dispatcher {
   // Protocol ------------------------------------------------------------------
@@ -16,12 +22,12 @@ namespace fx::dispatcher {
   void Protocol::dispatch() {
     const auto result = _command->run(_arguments);
     if (result.failed()) {
-      spdlog::error("{0}", result.error());
+      FX_LOG_ERROR("{0}", result.error());
       exit(1);
     }
   }
 
-  const std::vector<std::string>& Protocol::arguments() {
+  fx::util::arguments_t Protocol::arguments() {
     return _arguments;
   }
 
@@ -31,19 +37,47 @@ namespace fx::dispatcher {
 
   // Dispatcher ----------------------------------------------------------------
 
-  Dispatcher::Dispatcher(const std::vector<std::string>& arguments) {
-    if (arguments.empty() || arguments[0] == "list") {
+  // Workspaces may already have commands named like the ones fx added after
+  // list, help and version, and those keep working.
+  static bool is_workspace_command(std::string_view command_name) {
+    if (const auto* embedded = fx::embedded::workspace(); embedded != nullptr) {
+      return fx::embedded::find(*embedded, command_name) != nullptr;
+    }
+    const auto workspace_path = fx::util::workspace_descriptor_path();
+    return workspace_path.ok() &&
+           std::filesystem::exists(workspace_path.value().parent_path() /
+                                   command_name / "command.fx.yaml");
+  }
+
+  Dispatcher::Dispatcher(fx::util::arguments_t arguments) {
+    // Shims run as `fx --fx-shim <shim> <args...>`, checked first as every
+    // command invoked through a shim takes this path.
+    if (!arguments.empty() && arguments[0] == "--fx-shim") {
+      _command = std::make_shared<fx::command::Shim>();
+      _arguments = arguments.subspan(1);
+    } else if (arguments.empty() || arguments[0] == "list") {
       _command = std::make_shared<fx::command::List>();
     } else if (arguments[0] == "help" || arguments[0] == "--help" ||
                arguments[0] == "-h") {
       _command = std::make_shared<fx::command::Help>();
     } else if (arguments[0] == "version") {
       _command = std::make_shared<fx::command::Version>();
+    } else if (arguments[0] == "stats" && !is_workspace_command(arguments[0])) {
+      _command = std::make_shared<fx::command::Stats>();
+    } else if (arguments[0] == "run" && !is_workspace_command(arguments[0])) {
+      _command = std::make_shared<fx::command::Run>();
+      _arguments = arguments.subspan(1);
+    } else if (arguments[0] == "batch" && !is_workspace_command(arguments[0])) {
+      _command = std::make_shared<fx::command::Batch>();
+      _arguments = arguments.subspan(1);
+    } else if (arguments[0] == "install-shims" &&
+               !is_workspace_command(arguments[0])) {
+      _command = std::make_shared<fx::command::InstallShims>();
+      _arguments = arguments.subspan(1);
     } else {
-      const auto& command_name = arguments[0];
-      _command = std::make_shared<fx::command::Forwarder>(command_name);
-      _arguments =
-          std::vector<std::string>{arguments.begin() + 1, arguments.end()};
+      _command =
+          std::make_shared<fx::command::Forwarder>(std::string(arguments[0]));
+      _arguments = arguments.subspan(1);
     }
   }
 }  // namespace fx::dispatcher
@@ -1,9 +1,8 @@
 #pragma once
 
 #include <memory>
-#include <string>
-#include <vector>
 #include "fx/command/base/base.hpp"
+#include "fx/util/util.hpp"
 
 namespace fx::dispatcher {
   // Protocol ------------------------------------------------------------------
@@ -12,13 +11,13 @@ namespace fx::dispatcher {
    public:
     Protocol();
     void dispatch();
-    const std::vector<std::string>& arguments();
+    fx::util::arguments_t arguments();
     std::shared_ptr<fx::command::Base> command();
 
     virtual ~Protocol() = 0;
 
    protected:
-    std::vector<std::string> _arguments;
+    fx::util::arguments_t _arguments;
     std::shared_ptr<fx::command::Base> _command;
   };
 
@@ -26,6 +25,7 @@ namespace fx::dispatcher {
 
   class Dispatcher : public Protocol {
    public:
-    Dispatcher(const std::vector<std::string>& arguments);
+    // Views `arguments`, which must outlive the dispatcher.
+    Dispatcher(fx::util::arguments_t arguments);
   };
 }  // namespace fx::dispatcher
@@ -0,0 +1,35 @@
+#include "embedded.hpp"
+#include <algorithm>
+
+namespace fx::embedded {
+  // Overridden by the generated tables, which are linked with alwayslink.
+  __attribute__((weak)) const workspace_t* workspace() {
+    return nullptr;
+  }
+
+  const command_t* find(const workspace_t& workspace, std::string_view name) {
+    const auto found = std::lower_bound(
+        workspace.commands.begin(), workspace.commands.end(), name,
+        [](const command_t& command, std::string_view value) {
+          return command.name < value;
+        });
+    if (found == workspace.commands.end() || found->name != name) {
+      return nullptr;
+    }
+    return found;
+  }
+
+  fx::cache::v1beta::CommandCacheEntry load(const command_t& command) {
+    fx::cache::v1beta::CommandCacheEntry entry;
+    entry.ParseFromArray(command.entry.data(),
+                         static_cast<int>(command.entry.size()));
+    return entry;
+  }
+
+  fx::cache::v1beta::WorkspaceCacheEntry load(const workspace_t& workspace) {
+    fx::cache::v1beta::WorkspaceCacheEntry entry;
+    entry.ParseFromArray(workspace.entry.data(),
+                         static_cast<int>(workspace.entry.size()));
+    return entry;
+  }
+}  // namespace fx::embedded
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string_view>
+#include "fx/cache/v1beta/cache.pb.h"
+#include "fx/util/util.hpp"
+
+// Descriptors compiled into the binary by the fx_workspace_binary Bazel rule,
+// see tools/workspace_binary. A binary built this way serves its commands from
+// these tables instead of finding and parsing command.fx.yaml files.
+namespace fx::embedded {
+  struct command_t {
+    std::string_view name;
+    std::string_view synopsis;
+    // False for commands below an ignored directory, which can be run but are
+    // not listed.
+    bool listed;
+    // A serialized fx.cache.v1beta.CommandCacheEntry.
+    std::string_view entry;
+  };
+
+  struct workspace_t {
+    // A serialized fx.cache.v1beta.WorkspaceCacheEntry.
+    std::string_view entry;
+    // Sorted by name.
+    fx::util::Span<command_t> commands;
+  };
+
+  // The tables linked into this binary, or nullptr for the stock fx binary.
+  const workspace_t* workspace();
+
+  const command_t* find(const workspace_t& workspace, std::string_view name);
+
+  fx::cache::v1beta::CommandCacheEntry load(const command_t& command);
+
+  fx::cache::v1beta::WorkspaceCacheEntry load(const workspace_t& workspace);
+}  // namespace fx::embedded
@@ -0,0 +1,144 @@
+#include "generator.hpp"
+#include <fmt/core.h>
+#include <algorithm>
+#include "fx/argparse/table/table.hpp"
+#include "fx/cache/v1beta/cache.pb.h"
+#include "fx/parser/parser.hpp"
+
+namespace fx::embedded::generator {
+  namespace {
+    struct command_t {
+      std::string name;
+      std::string synopsis;
+      bool listed;
+      std::string entry;
+    };
+
+    // Mirrors the directories fx list skips while walking the workspace.
+    bool is_listed(const std::filesystem::path& relative_directory,
+                   const std::vector<std::filesystem::path>& ignored) {
+      std::filesystem::path prefix;
+      for (const auto& component : relative_directory) {
+        prefix /= component;
+        if (component.u8string().rfind('.', 0) == 0 ||
+            std::find(ignored.begin(), ignored.end(), prefix) !=
+                ignored.end()) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }  // namespace
+
+  std::string literal(std::string_view bytes, std::size_t width) {
+    std::string result;
+    std::string line = "\"";
+    for (const unsigned char character : bytes) {
+      std::string escaped;
+      if (character == '"' || character == '\\') {
+        escaped = fmt::format("\\{0}", static_cast<char>(character));
+      } else if (character >= ' ' && character <= '~' && character != '?') {
+        escaped = std::string(1, static_cast<char>(character));
+      } else {
+        // Octal escapes stop after three digits, unlike hexadecimal ones, so
+        // they are safe in front of any character.
+        escaped = fmt::format("\\{0:03o}", character);
+      }
+      if (line.size() + escaped.size() + 1 > width) {
+        result += line + "\"\n";
+        line = "\"";
+      }
+      line += escaped;
+    }
+    return result + line + "\"";
+  }
+
+  fx::result::Result<std::string> generate(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::vector<std::filesystem::path>& command_descriptor_paths) {
+    fx::cache::v1beta::WorkspaceCacheEntry workspace_entry;
+    auto workspace_result = fx::parser::parse_descriptor_into(
+        workspace_descriptor_path,
+        workspace_entry.mutable_workspace_descriptor());
+    if (workspace_result.failed()) {
+      return fx::result::Error(fmt::format(
+          "{0}: {1}", workspace_descriptor_path.u8string(),
+          std::move(workspace_result).error()));
+    }
+
+    const auto workspace_directory =
+        workspace_descriptor_path.parent_path().lexically_normal();
+    std::vector<std::filesystem::path> ignored;
+    for (const auto& ignore :
+         workspace_entry.workspace_descriptor().ignore()) {
+      ignored.push_back(std::filesystem::path(ignore).lexically_normal());
+    }
+
+    std::vector<command_t> commands;
+    for (const auto& path : command_descriptor_paths) {
+      const auto relative_directory =
+          path.parent_path().lexically_normal().lexically_relative(
+              workspace_directory);
+      if (relative_directory.empty() || relative_directory == "." ||
+          *relative_directory.begin() == "..") {
+        return fx::result::Error(
+            fmt::format("{0} is not a command of the workspace {1}.",
+                        path.u8string(), workspace_descriptor_path.u8string()));
+      }
+
+      fx::cache::v1beta::CommandCacheEntry entry;
+      auto descriptor_result = fx::parser::parse_descriptor_into(
+          path, entry.mutable_command_descriptor());
+      if (descriptor_result.failed()) {
+        return fx::result::Error(fmt::format(
+            "{0}: {1}", path.u8string(), std::move(descriptor_result).error()));
+      }
+      *entry.mutable_parse_table() =
+          fx::argparse::table::compile(entry.command_descriptor());
+
+      commands.push_back(command_t{relative_directory.generic_u8string(),
+                                   entry.command_descriptor().synopsis(),
+                                   is_listed(relative_directory, ignored),
+                                   entry.SerializeAsString()});
+    }
+    std::sort(commands.begin(), commands.end(),
+              [](const command_t& left, const command_t& right) {
+                return left.name < right.name;
+              });
+
+    std::string source =
+        "// Generated by //src/fx/embedded/generator. Do not edit.\n"
+        "#include \"fx/embedded/embedded.hpp\"\n"
+        "\n"
+        "namespace fx::embedded {\n"
+        "  namespace {\n";
+    const auto view = [](std::string_view bytes) {
+      return fmt::format("std::string_view({0}, {1})", literal(bytes, 76),
+                         bytes.size());
+    };
+    if (!commands.empty()) {
+      source += "    constexpr command_t commands[] = {\n";
+      for (const auto& command : commands) {
+        source += fmt::format("{{\n{0},\n{1},\n{2},\n{3}}},\n",
+                              view(command.name), view(command.synopsis),
+                              command.listed ? "true" : "false",
+                              view(command.entry));
+      }
+      source += "    };\n\n";
+    }
+    source += fmt::format(
+        "    constexpr workspace_t tables{{\n{0},\n{1}}};\n"
+        "  }}  // namespace\n"
+        "\n"
+        "  const workspace_t* workspace() {{\n"
+        "    return &tables;\n"
+        "  }}\n"
+        "}}  // namespace fx::embedded\n",
+        view(workspace_entry.SerializeAsString()),
+        commands.empty()
+            ? std::string("fx::util::Span<command_t>()")
+            : fmt::format("fx::util::Span<command_t>(commands, {0})",
+                          commands.size()));
+    return fx::result::Ok(std::move(source));
+  }
+}  // namespace fx::embedded::generator
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "fx/result/result.hpp"
+
+// Compiles descriptors into C++ tables for fx::embedded. Runs at build time, so
+// invalid descriptors fail the build instead of the invocation.
+namespace fx::embedded::generator {
+  // A C++ string literal holding `bytes`, split over lines of at most `width`
+  // columns.
+  std::string literal(std::string_view bytes, std::size_t width);
+
+  // Returns the source of a translation unit defining
+  // fx::embedded::workspace(). Command names are the descriptor directories
+  // relative to the workspace descriptor's directory.
+  fx::result::Result<std::string> generate(
+      const std::filesystem::path& workspace_descriptor_path,
+      const std::vector<std::filesystem::path>& command_descriptor_paths);
+}  // namespace fx::embedded::generator
@@ -0,0 +1,27 @@
+#include <fmt/core.h>
+#include <fstream>
+#include "fx/embedded/generator/generator.hpp"
+
+// Usage: generator <output.cpp> <workspace.fx.yaml> [<command.fx.yaml>...]
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    fmt::print(stderr,
+               "Usage: {0} <output.cpp> <workspace.fx.yaml> "
+               "[<command.fx.yaml>...]\n",
+               argv[0]);
+    return 1;
+  }
+
+  const std::vector<std::filesystem::path> command_descriptor_paths(
+      argv + 3, argv + argc);
+  const auto source = fx::embedded::generator::generate(
+      argv[2], command_descriptor_paths);
+  if (source.failed()) {
+    fmt::print(stderr, "{0}\n", source.error());
+    return 1;
+  }
+
+  std::ofstream output(argv[1], std::ios::trunc);
+  output << source.value();
+  return output ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#include "history.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "fx/log/log.hpp"
+#include "fx/util/mapping.hpp"
+
+namespace fx::history {
+  namespace {
+    struct header_t {
+      fx::util::layout_t layout;
+      // Sequence number of the next record; slot is sequence % capacity.
+      std::atomic<uint64_t> next;
+      char reserved[32];
+    };
+
+    struct record_t {
+      // Sequence number + 1, stored last so readers can tell a committed
+      // record from one still being written. 0 is an empty slot.
+      std::atomic<uint64_t> committed;
+      int64_t timestamp_us;
+      uint64_t workspace_hash;
+      uint64_t arguments_hash;
+      int64_t fx_overhead_us;
+      // -1 when unknown.
+      int64_t child_wall_us;
+      int64_t max_rss_kib;
+      int32_t exit_code;
+      int32_t signal;
+      char command[64];
+    };
+
+    static_assert(sizeof(header_t) == 64);
+    static_assert(sizeof(record_t) == 128);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    const std::size_t file_size =
+        sizeof(header_t) + capacity * sizeof(record_t);
+
+    const fx::util::layout_t layout = {
+        {'F', 'X', 'H', 'I', 'S', 'T'}, 1, sizeof(record_t), capacity};
+
+    header_t* header(const fx::util::SharedMapping& mapping) {
+      return static_cast<header_t*>(mapping.address());
+    }
+
+    record_t* records(const fx::util::SharedMapping& mapping) {
+      return reinterpret_cast<record_t*>(
+          static_cast<char*>(mapping.address()) + sizeof(header_t));
+    }
+  }  // namespace
+
+  uint64_t hash(std::string_view value, uint64_t seed) {
+    uint64_t result = seed;
+    for (const unsigned char character : value) {
+      result ^= character;
+      result *= 1099511628211ULL;
+    }
+    return result;
+  }
+
+  std::filesystem::path path(const std::filesystem::path& cache_directory) {
+    return cache_directory.empty() ? std::filesystem::path()
+                                   : cache_directory / "history.bin";
+  }
+
+  void append(const std::filesystem::path& history_path, const entry_t& entry) {
+    if (history_path.empty()) {
+      return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(history_path.parent_path(), error);
+
+    const fx::util::SharedMapping mapping(history_path, layout, file_size,
+                                          true);
+    if (mapping.address() == nullptr) {
+      FX_LOG_DEBUG("Unable to map history {0}", history_path.u8string());
+      return;
+    }
+
+    const uint64_t sequence =
+        header(mapping)->next.fetch_add(1, std::memory_order_relaxed);
+    record_t& record = records(mapping)[sequence % capacity];
+    record.committed.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.timestamp_us = entry.timestamp_us;
+    record.workspace_hash = entry.workspace_hash;
+    record.arguments_hash = entry.arguments_hash;
+    record.fx_overhead_us = entry.fx_overhead_us;
+    record.child_wall_us = entry.child_wall_us.value_or(-1);
+    record.max_rss_kib = entry.max_rss_kib;
+    record.exit_code = entry.exit_code;
+    record.signal = entry.signal;
+    std::memset(record.command, 0, sizeof(record.command));
+    std::memcpy(record.command, entry.command.data(),
+                std::min(entry.command.size(), sizeof(record.command) - 1));
+
+    record.committed.store(sequence + 1, std::memory_order_release);
+  }
+
+  std::vector<entry_t> read(const std::filesystem::path& history_path) {
+    std::vector<entry_t> entries;
+    if (history_path.empty()) {
+      return entries;
+    }
+
+    const fx::util::SharedMapping mapping(history_path, layout, file_size,
+                                          false);
+    if (mapping.address() == nullptr) {
+      return entries;
+    }
+
+    const uint64_t next =
+        header(mapping)->next.load(std::memory_order_acquire);
+    const uint64_t first = next > capacity ? next - capacity : 0;
+    entries.reserve(next - first);
+    for (uint64_t sequence = first; sequence < next; sequence++) {
+      const record_t& record = records(mapping)[sequence % capacity];
+      if (record.committed.load(std::memory_order_acquire) != sequence + 1) {
+        continue;
+      }
+
+      entry_t entry;
+      entry.timestamp_us = record.timestamp_us;
+      entry.workspace_hash = record.workspace_hash;
+      entry.command = std::string(
+          record.command, strnlen(record.command, sizeof(record.command)));
+      entry.arguments_hash = record.arguments_hash;
+      entry.fx_overhead_us = record.fx_overhead_us;
+      if (record.child_wall_us >= 0) {
+        entry.child_wall_us = record.child_wall_us;
+      }
+      entry.max_rss_kib = record.max_rss_kib;
+      entry.exit_code = record.exit_code;
+      entry.signal = record.signal;
+
+      // Overwritten while it was copied.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (record.committed.load(std::memory_order_relaxed) != sequence + 1) {
+        continue;
+      }
+      entries.push_back(std::move(entry));
+    }
+    return entries;
+  }
+}  // namespace fx::history
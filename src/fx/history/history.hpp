@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A record of every forwarded command, kept in a fixed-size ring buffer file
+// in the fx cache directory. Appending maps the file and claims a slot with an
+// atomic counter in its header, so concurrent fx processes never block each
+// other and the file never grows.
+namespace fx::history {
+  // Records kept before the oldest is overwritten; 1 MiB of records.
+  static const uint64_t capacity = 8192;
+
+  struct entry_t {
+    // Microseconds since the epoch when fx started forwarding.
+    int64_t timestamp_us = 0;
+    uint64_t workspace_hash = 0;
+    // Truncated to 63 bytes.
+    std::string command;
+    uint64_t arguments_hash = 0;
+    // Time fx spent before handing over to the command.
+    int64_t fx_overhead_us = 0;
+    // Only known when fx supervised the command, see FxWorkspaceDescriptor.
+    std::optional<int64_t> child_wall_us;
+    int64_t max_rss_kib = 0;
+    int exit_code = 0;
+    int signal = 0;
+  };
+
+  // FNV-1a. Pass the previous result as `seed` to hash several values.
+  uint64_t hash(std::string_view value,
+                uint64_t seed = 14695981039346656037ULL);
+
+  // Empty when `cache_directory` is, which disables the history.
+  std::filesystem::path path(const std::filesystem::path& cache_directory);
+
+  // Failing to write the history is never an error, it is only logged.
+  void append(const std::filesystem::path& history_path, const entry_t& entry);
+
+  // Oldest first. Slots being written concurrently are skipped.
+  std::vector<entry_t> read(const std::filesystem::path& history_path);
+}  // namespace fx::history
@@ -0,0 +1,90 @@
+#include "sketch.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace fx::history::sketch {
+  Sketch::Sketch(double relative_accuracy)
+      : _gamma((1 + relative_accuracy) / (1 - relative_accuracy)),
+        _log_gamma(std::log(_gamma)) {}
+
+  int Sketch::bucket(double value) const {
+    return static_cast<int>(std::ceil(std::log(value) / _log_gamma));
+  }
+
+  double Sketch::value(int bucket) const {
+    // The point within (gamma^(bucket-1), gamma^bucket] with the lowest
+    // relative error to both bounds.
+    return 2 * std::pow(_gamma, bucket) / (_gamma + 1);
+  }
+
+  void Sketch::add(double value) {
+    _count++;
+    if (!(value >= min_value)) {
+      _zero_count++;
+      return;
+    }
+
+    const int index = bucket(value);
+    if (_buckets.empty()) {
+      _offset = index;
+      _buckets.push_back(0);
+    } else if (index < _offset) {
+      _buckets.insert(_buckets.begin(), _offset - index, 0);
+      _offset = index;
+    } else if (index >= _offset + static_cast<int>(_buckets.size())) {
+      _buckets.resize(index - _offset + 1, 0);
+    }
+    _buckets[index - _offset]++;
+  }
+
+  void Sketch::merge(const Sketch& other) {
+    _count += other._count;
+    _zero_count += other._zero_count;
+    if (other._buckets.empty()) {
+      return;
+    }
+    if (_buckets.empty()) {
+      _offset = other._offset;
+      _buckets = other._buckets;
+      return;
+    }
+
+    const int first = std::min(_offset, other._offset);
+    const int last =
+        std::max(_offset + static_cast<int>(_buckets.size()),
+                 other._offset + static_cast<int>(other._buckets.size()));
+    std::vector<uint64_t> merged(last - first, 0);
+    for (std::size_t index = 0; index < _buckets.size(); index++) {
+      merged[_offset - first + index] += _buckets[index];
+    }
+    for (std::size_t index = 0; index < other._buckets.size(); index++) {
+      merged[other._offset - first + index] += other._buckets[index];
+    }
+    _offset = first;
+    _buckets = std::move(merged);
+  }
+
+  uint64_t Sketch::count() const {
+    return _count;
+  }
+
+  double Sketch::quantile(double quantile) const {
+    if (_count == 0) {
+      return 0;
+    }
+
+    const auto rank = static_cast<uint64_t>(
+        std::clamp(quantile, 0.0, 1.0) * static_cast<double>(_count - 1));
+    uint64_t seen = _zero_count;
+    if (rank < seen) {
+      return 0;
+    }
+    for (std::size_t index = 0; index < _buckets.size(); index++) {
+      seen += _buckets[index];
+      if (rank < seen) {
+        return value(_offset + static_cast<int>(index));
+      }
+    }
+    return value(_offset + static_cast<int>(_buckets.size()) - 1);
+  }
+}  // namespace fx::history::sketch
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace fx::history::sketch {
+  // A streaming quantile sketch with relative error. Values are counted in
+  // buckets whose bounds grow geometrically, so any quantile is within
+  // `relative_accuracy` of the exact value while memory only grows with the
+  // logarithm of the value range.
+  class Sketch {
+   public:
+    explicit Sketch(double relative_accuracy = 0.01);
+
+    // Values below `min_value` count as zero.
+    void add(double value);
+
+    void merge(const Sketch& other);
+
+    uint64_t count() const;
+
+    // `quantile` in [0, 1]. 0 when empty.
+    double quantile(double quantile) const;
+
+   private:
+    static constexpr double min_value = 1e-9;
+
+    int bucket(double value) const;
+
+    double value(int bucket) const;
+
+    double _gamma;
+    double _log_gamma;
+    uint64_t _count = 0;
+    uint64_t _zero_count = 0;
+    // Counts for buckets [_offset, _offset + _buckets.size()).
+    int _offset = 0;
+    std::vector<uint64_t> _buckets;
+  };
+}  // namespace fx::history::sketch
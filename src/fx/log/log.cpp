@@ -0,0 +1,57 @@
+#include "log.hpp"
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace fx::log {
+  namespace {
+    spdlog::level::level_enum threshold() {
+      static const auto level = parse_level(std::getenv("SPDLOG_LEVEL"));
+      return level;
+    }
+  }  // namespace
+
+  spdlog::level::level_enum parse_level(const char* value) {
+    auto level = spdlog::level::info;
+    if (value == nullptr) {
+      return level;
+    }
+
+    std::string_view entries(value);
+    while (!entries.empty()) {
+      const auto end = std::min(entries.find(','), entries.size());
+      const auto entry = entries.substr(0, end);
+      entries.remove_prefix(std::min(end + 1, entries.size()));
+      if (entry.find('=') != std::string_view::npos) {
+        continue;
+      }
+      const auto parsed = spdlog::level::from_str(std::string(entry));
+      if (parsed != spdlog::level::off || entry == "off") {
+        level = parsed;
+      }
+    }
+    return level;
+  }
+
+  bool enabled(spdlog::level::level_enum level) {
+    return level >= threshold();
+  }
+
+  spdlog::logger& logger() {
+    static auto* const logger = [] {
+      const auto prefix = fmt::format(fmt::emphasis::faint, "fx %H:%M:%S.%e");
+      const auto pid = fmt::format(fg(fmt::terminal_color::magenta), "%P");
+      const auto thread = fmt::format(fmt::emphasis::faint, "~%t");
+      const auto separator = fmt::format(fmt::emphasis::faint, ":");
+      spdlog::set_pattern(fmt::format("{0} %^%5l%$ {1}{2}{3} %v", prefix, pid,
+                                      thread, separator));
+      spdlog::set_level(threshold());
+      return spdlog::default_logger_raw();
+    }();
+    return *logger;
+  }
+}  // namespace fx::log
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/logger.h>
+
+// Logging that costs nothing while it is off. Messages below FX_LOG_LEVEL, an
+// SPDLOG_LEVEL_* value, are compiled out. The others evaluate their arguments
+// and set up the logger only once $SPDLOG_LEVEL enables their level.
+#ifndef FX_LOG_LEVEL
+#define FX_LOG_LEVEL SPDLOG_LEVEL_DEBUG
+#endif
+
+#define FX_LOG(level, ...)                       \
+  do {                                           \
+    if (fx::log::enabled(level)) {               \
+      fx::log::logger().log(level, __VA_ARGS__); \
+    }                                            \
+  } while (false)
+
+#if FX_LOG_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define FX_LOG_DEBUG(...) FX_LOG(spdlog::level::debug, __VA_ARGS__)
+#else
+#define FX_LOG_DEBUG(...) static_cast<void>(0)
+#endif
+
+#if FX_LOG_LEVEL <= SPDLOG_LEVEL_WARN
+#define FX_LOG_WARN(...) FX_LOG(spdlog::level::warn, __VA_ARGS__)
+#else
+#define FX_LOG_WARN(...) static_cast<void>(0)
+#endif
+
+#if FX_LOG_LEVEL <= SPDLOG_LEVEL_ERROR
+#define FX_LOG_ERROR(...) FX_LOG(spdlog::level::err, __VA_ARGS__)
+#else
+#define FX_LOG_ERROR(...) static_cast<void>(0)
+#endif
+
+namespace fx::log {
+  // The level $SPDLOG_LEVEL sets for the default logger, read the way
+  // spdlog::cfg does: the last entry without a logger name wins and unknown
+  // levels are skipped. Info when unset.
+  spdlog::level::level_enum parse_level(const char* value);
+
+  // Whether messages at `level` are printed. Reads $SPDLOG_LEVEL once.
+  bool enabled(spdlog::level::level_enum level);
+
+  // The default logger, given fx's pattern and level on first use.
+  spdlog::logger& logger();
+}  // namespace fx::log
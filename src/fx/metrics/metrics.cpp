@@ -0,0 +1,284 @@
+#include "metrics.hpp"
+#include <fmt/core.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "fx/history/history.hpp"
+#include "fx/log/log.hpp"
+#include "fx/util/mapping.hpp"
+#include "fx/util/util.hpp"
+
+namespace fx::metrics {
+  namespace {
+    // Upper bounds in seconds, wide enough for both fx itself and the
+    // commands it runs. The last bucket is +Inf.
+    const std::array<double, 17> bounds = {
+        0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25,
+        0.5,    1,     2.5,    5,     10,   30,    60,   300};
+
+    const char* const phase_names[PHASE_COUNT] = {"discovery", "parse",
+                                                  "argparse", "child"};
+
+    // Writing the exported file is retried while other processes keep
+    // updating the table, so the newest observations are not overwritten by
+    // an older render.
+    const int export_attempts = 3;
+
+    struct header_t {
+      fx::util::layout_t layout;
+      // Bumped after every observation.
+      std::atomic<uint64_t> generation;
+      char reserved[32];
+    };
+
+    struct histogram_t {
+      // Not cumulative; render() sums them up.
+      std::atomic<uint64_t> buckets[bounds.size() + 1];
+      std::atomic<uint64_t> count;
+      std::atomic<uint64_t> sum_us;
+    };
+
+    struct entry_t {
+      // Hash of the workspace and command, 0 for an empty slot. Claimed with
+      // a compare-and-swap, after which the names are written.
+      std::atomic<uint64_t> key;
+      // Set once the names are written.
+      std::atomic<uint32_t> ready;
+      uint32_t padding;
+      std::atomic<uint64_t> invocations;
+      std::atomic<uint64_t> failures;
+      char workspace[224];
+      char command[64];
+      histogram_t phases[PHASE_COUNT];
+    };
+
+    static_assert(sizeof(header_t) == 64);
+    static_assert(sizeof(entry_t) == 960);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    const std::size_t file_size =
+        sizeof(header_t) + capacity * sizeof(entry_t);
+
+    const fx::util::layout_t layout = {
+        {'F', 'X', 'M', 'E', 'T', 'R'}, 1, sizeof(entry_t), capacity};
+
+    header_t* header(const fx::util::SharedMapping& mapping) {
+      return static_cast<header_t*>(mapping.address());
+    }
+
+    entry_t* slots(const fx::util::SharedMapping& mapping) {
+      return reinterpret_cast<entry_t*>(
+          static_cast<char*>(mapping.address()) + sizeof(header_t));
+    }
+
+    void copy_name(char* destination,
+                   std::size_t size,
+                   const std::string& name) {
+      std::memset(destination, 0, size);
+      std::memcpy(destination, name.data(), std::min(name.size(), size - 1));
+    }
+
+    std::string read_name(const char* source, std::size_t size) {
+      return std::string(source, strnlen(source, size));
+    }
+
+    // Linear probing from the key's slot. nullptr when the table is full.
+    entry_t* find_or_claim(const fx::util::SharedMapping& mapping,
+                           const observation_t& observation) {
+      // The workspace's terminating NUL separates it from the command.
+      const std::string_view workspace(observation.workspace.c_str(),
+                                       observation.workspace.size() + 1);
+      uint64_t key = fx::history::hash(observation.command,
+                                       fx::history::hash(workspace));
+      key = key == 0 ? 1 : key;
+
+      for (uint64_t probe = 0; probe < capacity; probe++) {
+        entry_t& entry = slots(mapping)[(key + probe) % capacity];
+        uint64_t current = entry.key.load(std::memory_order_acquire);
+        if (current == 0 &&
+            entry.key.compare_exchange_strong(current, key,
+                                              std::memory_order_acq_rel)) {
+          copy_name(entry.workspace, sizeof(entry.workspace),
+                    observation.workspace);
+          copy_name(entry.command, sizeof(entry.command), observation.command);
+          entry.ready.store(1, std::memory_order_release);
+          return &entry;
+        }
+        if (current == key) {
+          return &entry;
+        }
+      }
+      return nullptr;
+    }
+
+    void observe(histogram_t& histogram, double seconds) {
+      const std::size_t bucket = static_cast<std::size_t>(
+          std::lower_bound(bounds.begin(), bounds.end(), seconds) -
+          bounds.begin());
+      histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+      histogram.count.fetch_add(1, std::memory_order_relaxed);
+      histogram.sum_us.fetch_add(
+          static_cast<uint64_t>(std::llround(std::max(seconds, 0.0) * 1e6)),
+          std::memory_order_relaxed);
+    }
+
+    std::string escape(const std::string& value) {
+      std::string result;
+      result.reserve(value.size());
+      for (const char character : value) {
+        if (character == '\\') {
+          result += "\\\\";
+        } else if (character == '"') {
+          result += "\\\"";
+        } else if (character == '\n') {
+          result += "\\n";
+        } else {
+          result += character;
+        }
+      }
+      return result;
+    }
+
+    std::string render(const fx::util::SharedMapping& mapping) {
+      std::vector<const entry_t*> entries;
+      std::vector<std::string> labels;
+      for (uint64_t slot = 0; slot < capacity; slot++) {
+        const entry_t& entry = slots(mapping)[slot];
+        if (entry.ready.load(std::memory_order_acquire) == 0) {
+          continue;
+        }
+        entries.push_back(&entry);
+        labels.push_back(fmt::format(
+            "workspace=\"{0}\",command=\"{1}\"",
+            escape(read_name(entry.workspace, sizeof(entry.workspace))),
+            escape(read_name(entry.command, sizeof(entry.command)))));
+      }
+
+      std::string output;
+      output +=
+          "# HELP fx_invocations_total Commands forwarded by fx.\n"
+          "# TYPE fx_invocations_total counter\n";
+      for (std::size_t index = 0; index < entries.size(); index++) {
+        output += fmt::format(
+            "fx_invocations_total{{{0}}} {1}\n", labels[index],
+            entries[index]->invocations.load(std::memory_order_relaxed));
+      }
+
+      output +=
+          "# HELP fx_failures_total Supervised commands that exited with a "
+          "non-zero code or a signal.\n"
+          "# TYPE fx_failures_total counter\n";
+      for (std::size_t index = 0; index < entries.size(); index++) {
+        output += fmt::format(
+            "fx_failures_total{{{0}}} {1}\n", labels[index],
+            entries[index]->failures.load(std::memory_order_relaxed));
+      }
+
+      output +=
+          "# HELP fx_phase_duration_seconds Time spent in each phase of a "
+          "forwarded command; child is the command itself.\n"
+          "# TYPE fx_phase_duration_seconds histogram\n";
+      for (std::size_t index = 0; index < entries.size(); index++) {
+        for (std::size_t phase = 0; phase < PHASE_COUNT; phase++) {
+          const histogram_t& histogram = entries[index]->phases[phase];
+          const std::string phase_labels = fmt::format(
+              "{0},phase=\"{1}\"", labels[index], phase_names[phase]);
+
+          uint64_t cumulative = 0;
+          for (std::size_t bucket = 0; bucket <= bounds.size(); bucket++) {
+            cumulative +=
+                histogram.buckets[bucket].load(std::memory_order_relaxed);
+            const std::string bound = bucket < bounds.size()
+                                          ? fmt::format("{0}", bounds[bucket])
+                                          : std::string("+Inf");
+            output += fmt::format(
+                "fx_phase_duration_seconds_bucket{{{0},le=\"{1}\"}} {2}\n",
+                phase_labels, bound, cumulative);
+          }
+          output += fmt::format(
+              "fx_phase_duration_seconds_sum{{{0}}} {1}\n", phase_labels,
+              static_cast<double>(
+                  histogram.sum_us.load(std::memory_order_relaxed)) /
+                  1e6);
+          output += fmt::format("fx_phase_duration_seconds_count{{{0}}} {1}\n",
+                                phase_labels, cumulative);
+        }
+      }
+      return output;
+    }
+  }  // namespace
+
+  std::filesystem::path table_path(
+      const std::filesystem::path& cache_directory) {
+    return cache_directory.empty() ? std::filesystem::path()
+                                   : cache_directory / "metrics.bin";
+  }
+
+  std::filesystem::path export_path() {
+    const char* value = std::getenv("FX_METRICS_FILE");
+    return value == nullptr ? std::filesystem::path()
+                            : std::filesystem::path(value);
+  }
+
+  void record(const std::filesystem::path& table,
+              const std::filesystem::path& output_path,
+              const observation_t& observation) {
+    if (table.empty() || output_path.empty()) {
+      return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(table.parent_path(), error);
+
+    const fx::util::SharedMapping mapping(table, layout, file_size, true);
+    if (mapping.address() == nullptr) {
+      FX_LOG_DEBUG("Unable to map metrics {0}", table.u8string());
+      return;
+    }
+
+    entry_t* entry = find_or_claim(mapping, observation);
+    if (entry == nullptr) {
+      FX_LOG_DEBUG("Metrics table {0} is full", table.u8string());
+      return;
+    }
+    entry->invocations.fetch_add(1, std::memory_order_relaxed);
+    if (observation.failed) {
+      entry->failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (std::size_t phase = 0; phase < PHASE_COUNT; phase++) {
+      if (observation.seconds[phase].has_value()) {
+        observe(entry->phases[phase], *observation.seconds[phase]);
+      }
+    }
+    header(mapping)->generation.fetch_add(1, std::memory_order_release);
+
+    for (int attempt = 0; attempt < export_attempts; attempt++) {
+      const uint64_t generation =
+          header(mapping)->generation.load(std::memory_order_acquire);
+      if (const auto result =
+              fx::util::write_atomically(output_path, render(mapping));
+          result.failed()) {
+        FX_LOG_DEBUG("Unable to export metrics: {0}", result.error());
+        return;
+      }
+      // Whoever bumps the generation after this check renders after it too.
+      if (header(mapping)->generation.load(std::memory_order_acquire) ==
+          generation) {
+        return;
+      }
+    }
+  }
+
+  std::string render(const std::filesystem::path& table) {
+    if (table.empty()) {
+      return std::string();
+    }
+    const fx::util::SharedMapping mapping(table, layout, file_size, false);
+    if (mapping.address() == nullptr) {
+      return std::string();
+    }
+    return render(mapping);
+  }
+}  // namespace fx::metrics
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// Per-command counters and latency histograms, exported in the Prometheus
+// text format for node_exporter's textfile collector. Every fx process adds
+// its observation to a shared table in the cache directory with atomic
+// increments, then rewrites the exported file from the table with a rename,
+// so concurrent processes never block each other.
+namespace fx::metrics {
+  // Commands tracked before new ones are dropped.
+  static const uint64_t capacity = 256;
+
+  enum phase_t : std::size_t {
+    // Finding the workspace descriptor.
+    PHASE_DISCOVERY,
+    // Loading the command and workspace descriptors.
+    PHASE_PARSE,
+    // Parsing the command arguments.
+    PHASE_ARGPARSE,
+    // The command itself, only known when fx supervised it.
+    PHASE_CHILD,
+    PHASE_COUNT,
+  };
+
+  struct observation_t {
+    // Truncated to 223 bytes.
+    std::string workspace;
+    // Truncated to 63 bytes.
+    std::string command;
+    std::array<std::optional<double>, PHASE_COUNT> seconds;
+    // Only known when fx supervised the command.
+    bool failed = false;
+  };
+
+  // Empty when `cache_directory` is, which disables the metrics.
+  std::filesystem::path table_path(
+      const std::filesystem::path& cache_directory);
+
+  // The file to export to, from $FX_METRICS_FILE. Empty when unset.
+  std::filesystem::path export_path();
+
+  // Adds `observation` to the table and rewrites `output_path` from it. Does
+  // nothing when `output_path` is empty, so fx only maps the table when
+  // metrics are exported. Failing to record metrics is never an error, it is
+  // only logged.
+  void record(const std::filesystem::path& table,
+              const std::filesystem::path& output_path,
+              const observation_t& observation);
+
+  // The table in the Prometheus text format.
+  std::string render(const std::filesystem::path& table);
+}  // namespace fx::metrics
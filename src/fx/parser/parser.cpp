@@ -1,44 +1,74 @@
 #include "parser.hpp"
 #include <fmt/core.h>
 #include "fx/parser/validator/validator.hpp"
+#include "fx/parser/yaml_reader/yaml_reader.hpp"
 #include "fx/parser/yaml_to_json/yaml_to_json.hpp"
+#include "fx/util/mapping.hpp"
 
 namespace fx::parser {
   template <typename D>
   fx::result::Result<D> parse_descriptor(
       const std::filesystem::path& descriptor_path) {
-    YAML::Node yaml;
-    try {
-      yaml = YAML::LoadFile(descriptor_path);
-    } catch (...) {
-      return fx::result::Error(
-          fmt::format("Unable to read {0}.", descriptor_path.u8string()));
-    }
+    D descriptor;
+    return parse_descriptor_into(descriptor_path, &descriptor).map([&]() {
+      return std::move(descriptor);
+    });
+  }
 
+  template <typename D>
+  fx::result::Result<D*> parse_descriptor(
+      const std::filesystem::path& descriptor_path,
+      google::protobuf::Arena* arena) {
+    D* descriptor = google::protobuf::Arena::CreateMessage<D>(arena);
+    return parse_descriptor_into(descriptor_path, descriptor).map([&]() {
+      return descriptor;
+    });
+  }
+
+  template <typename D>
+  fx::result::Result<void> parse_descriptor_into(
+      const std::filesystem::path& descriptor_path, D* descriptor) {
     nlohmann::json json;
-    const auto json_result = fx::parser::yaml_to_json::convert(yaml, json);
-    if (json_result.failed()) {
-      return fx::result::Error(fmt::format("Invalid descriptor: {0}. {1}",
-                                           descriptor_path.u8string(),
-                                           json_result.error()));
+    const fx::util::FileMapping mapping(descriptor_path);
+    if (auto fast_json = mapping.ok() ? fx::parser::yaml_reader::read(
+                                            mapping.contents())
+                                      : std::nullopt;
+        fast_json.has_value()) {
+      json = std::move(*fast_json);
+    } else {
+      YAML::Node yaml;
+      try {
+        yaml = YAML::LoadFile(descriptor_path);
+      } catch (...) {
+        return fx::result::Error(
+            fmt::format("Unable to read {0}.", descriptor_path.u8string()));
+      }
+
+      const auto json_result = fx::parser::yaml_to_json::convert(yaml, json);
+      if (json_result.failed()) {
+        return fx::result::Error(fmt::format("Invalid descriptor: {0}. {1}",
+                                             descriptor_path.u8string(),
+                                             json_result.error()));
+      }
     }
 
-    const auto descriptor_result = json_to_descriptor<D>(json);
-    if (descriptor_result.failed()) {
+    const auto status = google::protobuf::util::JsonStringToMessage(
+        json.dump(), descriptor, {});
+    if (!status.ok()) {
       return fx::result::Error(fmt::format("Invalid descriptor: {0}. {1}",
                                            descriptor_path.u8string(),
-                                           descriptor_result.error()));
+                                           status.ToString()));
     }
 
     const auto validation_result =
-        fx::parser::validator::validate_descriptor(descriptor_result.value());
+        fx::parser::validator::validate_descriptor(*descriptor);
     if (validation_result.failed()) {
       return fx::result::Error(fmt::format("Invalid descriptor: {0}. {1}",
                                            descriptor_path.u8string(),
                                            validation_result.error()));
     }
 
-    return fx::result::Ok(descriptor_result.value());
+    return fx::result::Ok();
   }
 
   template <typename D>
@@ -51,6 +81,20 @@ namespace fx::parser {
       return fx::result::Error(status.ToString());
     }
 
+    return fx::result::Ok(std::move(descriptor));
+  }
+
+  template <typename D>
+  fx::result::Result<D*> json_to_descriptor(const nlohmann::json& json,
+                                            google::protobuf::Arena* arena) {
+    D* descriptor = google::protobuf::Arena::CreateMessage<D>(arena);
+    const auto status = google::protobuf::util::JsonStringToMessage(
+        json.dump(), descriptor, {});
+
+    if (!status.ok()) {
+      return fx::result::Error(status.ToString());
+    }
+
     return fx::result::Ok(descriptor);
   }
 
@@ -60,9 +104,45 @@ namespace fx::parser {
         descriptor_path);
   }
 
+  fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor*>
+  parse_workspace_descriptor(const std::filesystem::path& descriptor_path,
+                             google::protobuf::Arena* arena) {
+    return parse_descriptor<fx::descriptor::v1beta::FxWorkspaceDescriptor>(
+        descriptor_path, arena);
+  }
+
   fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor>
   parse_command_descriptor(const std::filesystem::path& descriptor_path) {
     return parse_descriptor<fx::descriptor::v1beta::FxCommandDescriptor>(
         descriptor_path);
   }
+
+  fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor*>
+  parse_command_descriptor(const std::filesystem::path& descriptor_path,
+                           google::protobuf::Arena* arena) {
+    return parse_descriptor<fx::descriptor::v1beta::FxCommandDescriptor>(
+        descriptor_path, arena);
+  }
+
+  template fx::result::Result<void> parse_descriptor_into(
+      const std::filesystem::path& descriptor_path,
+      fx::descriptor::v1beta::FxWorkspaceDescriptor* descriptor);
+
+  template fx::result::Result<void> parse_descriptor_into(
+      const std::filesystem::path& descriptor_path,
+      fx::descriptor::v1beta::FxCommandDescriptor* descriptor);
+
+  template fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor>
+  json_to_descriptor(const nlohmann::json& json);
+
+  template fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor>
+  json_to_descriptor(const nlohmann::json& json);
+
+  template fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor*>
+  json_to_descriptor(const nlohmann::json& json,
+                     google::protobuf::Arena* arena);
+
+  template fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor*>
+  json_to_descriptor(const nlohmann::json& json,
+                     google::protobuf::Arena* arena);
 }  // namespace fx::parser
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <google/protobuf/arena.h>
 #include <google/protobuf/util/json_util.h>
 #include <yaml-cpp/yaml.h>
 #include <filesystem>
@@ -12,12 +13,35 @@ namespace fx::parser {
   fx::result::Result<D> parse_descriptor(
       const std::filesystem::path& descriptor_path);
 
+  // Parses the descriptor into a message owned by `arena`. The returned
+  // pointer lives as long as the arena, or until the arena is reset.
+  template <typename D>
+  fx::result::Result<D*> parse_descriptor(
+      const std::filesystem::path& descriptor_path,
+      google::protobuf::Arena* arena);
+
+  template <typename D>
+  fx::result::Result<void> parse_descriptor_into(
+      const std::filesystem::path& descriptor_path, D* descriptor);
+
   template <typename D>
   fx::result::Result<D> json_to_descriptor(const nlohmann::json& json);
 
+  template <typename D>
+  fx::result::Result<D*> json_to_descriptor(const nlohmann::json& json,
+                                            google::protobuf::Arena* arena);
+
   fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor>
   parse_workspace_descriptor(const std::filesystem::path& descriptor_path);
 
+  fx::result::Result<fx::descriptor::v1beta::FxWorkspaceDescriptor*>
+  parse_workspace_descriptor(const std::filesystem::path& descriptor_path,
+                             google::protobuf::Arena* arena);
+
   fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor>
   parse_command_descriptor(const std::filesystem::path& descriptor_path);
+
+  fx::result::Result<fx::descriptor::v1beta::FxCommandDescriptor*>
+  parse_command_descriptor(const std::filesystem::path& descriptor_path,
+                           google::protobuf::Arena* arena);
 }  // namespace fx::parser
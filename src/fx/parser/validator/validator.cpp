@@ -1,6 +1,7 @@
 #include "validator.hpp"
 #include <fmt/core.h>
 #include <fmt/ranges.h>
+#include <filesystem>
 #include "fx/util/util.hpp"
 
 namespace fx::parser::validator {
@@ -15,6 +16,13 @@ namespace fx::parser::validator {
           descriptor.descriptor_version(), supported_version));
     }
 
+    if (descriptor.has_shell() &&
+        !std::filesystem::path(descriptor.shell()).is_absolute()) {
+      error_messages.emplace_back(fmt::format(
+          "Workspace shell \"{0}\" must be an absolute path.",
+          descriptor.shell()));
+    }
+
     if (!error_messages.empty()) {
       return fx::result::Error(
           fmt::format("{0}", fmt::join(error_messages, " ")));
@@ -55,9 +63,41 @@ namespace fx::parser::validator {
       error_messages.emplace_back("Command synopsis cannot be empty.");
     }
 
-    if (descriptor.runtime().run().empty()) {
+    if (descriptor.runtime().has_plugin()) {
+      if (!descriptor.runtime().run().empty()) {
+        error_messages.emplace_back(
+            "Runtime run and plugin cannot both be set.");
+      }
+      if (descriptor.runtime().plugin().empty()) {
+        error_messages.emplace_back("Runtime plugin cannot be empty.");
+      }
+    } else if (descriptor.runtime().run().empty()) {
       error_messages.emplace_back("Runtime run cannot be empty.");
     }
+
+    validate_environment(descriptor.runtime().environment(), error_messages);
+  }
+
+  void validate_environment(
+      const fx::descriptor::v1beta::EnvironmentDescriptor& descriptor,
+      std::vector<std::string>& error_messages) {
+    const auto validate_patterns = [&](const auto& patterns,
+                                       const std::string& field) {
+      for (int index = 0; index < patterns.size(); index++) {
+        const auto& pattern = patterns[index];
+        const auto wildcard = pattern.find('*');
+        if (pattern.empty() || pattern.find('=') != std::string::npos ||
+            (wildcard != std::string::npos && wildcard != pattern.size() - 1)) {
+          error_messages.emplace_back(
+              fmt::format("Runtime environment {0}[index:{1}] \"{2}\" is not "
+                          "a valid variable pattern.",
+                          field, index, pattern));
+        }
+      }
+    };
+
+    validate_patterns(descriptor.allow(), "allow");
+    validate_patterns(descriptor.deny(), "deny");
   }
 
   void validate_options(const google::protobuf::RepeatedPtrField<
@@ -104,6 +144,12 @@ namespace fx::parser::validator {
       error_messages.emplace_back(fmt::format(
           R"({0} name cannot be named "help" (reserved).)", error_prefix));
     }
+
+    if (fx::util::lower(descriptor.name()).rfind("fx-", 0) == 0) {
+      error_messages.emplace_back(
+          fmt::format(R"({0} "{1}" name cannot start with "fx-" (reserved).)",
+                      error_prefix, descriptor.name()));
+    }
   }
 
   void validate_short_name(
@@ -24,6 +24,10 @@ namespace fx::parser::validator {
       const fx::descriptor::v1beta::FxCommandDescriptor& descriptor,
       std::vector<std::string>& error_messages);
 
+  void validate_environment(
+      const fx::descriptor::v1beta::EnvironmentDescriptor& descriptor,
+      std::vector<std::string>& error_messages);
+
   void validate_options(const google::protobuf::RepeatedPtrField<
                             fx::descriptor::v1beta::OptionDescriptor>& options,
                         std::vector<std::string>& error_messages);
@@ -0,0 +1,610 @@
+#include "yaml_reader.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace fx::parser::yaml_reader {
+  namespace {
+    // Absent for YAML nulls, which yaml_to_json drops.
+    using node_t = std::optional<nlohmann::json>;
+
+    struct line_t {
+      std::string_view raw;
+      // Column of the content. Rewritten for the content after "- ", which
+      // starts a node at that column.
+      int indent;
+      std::string_view content;
+    };
+
+    // Characters that start something other than a plain scalar.
+    bool is_indicator(char character) {
+      return std::strchr("-?:,[]{}#&*!|>'\"%@`", character) != nullptr;
+    }
+
+    // Plain scalars may also start with a "-" that is not a sequence entry.
+    bool starts_plain(std::string_view text) {
+      return !is_indicator(text[0]) ||
+             (text[0] == '-' && text.size() > 1 &&
+              std::strchr(" ,[]{}", text[1]) == nullptr);
+    }
+
+    bool is_blank(std::string_view content) {
+      return content.empty() || content[0] == '#';
+    }
+
+    bool is_sequence_entry(std::string_view content) {
+      return !content.empty() && content[0] == '-' &&
+             (content.size() == 1 || content[1] == ' ');
+    }
+
+    std::string_view trim_left(std::string_view text) {
+      const auto start = text.find_first_not_of(' ');
+      return start == std::string_view::npos ? std::string_view()
+                                             : text.substr(start);
+    }
+
+    std::string_view trim_right(std::string_view text) {
+      const auto end = text.find_last_not_of(' ');
+      return end == std::string_view::npos ? std::string_view()
+                                           : text.substr(0, end + 1);
+    }
+
+    // Nothing, or a comment, follows a node on its line.
+    bool is_end_of_line(std::string_view rest) {
+      if (rest.empty()) {
+        return true;
+      }
+      const auto trimmed = trim_left(rest);
+      return trimmed.empty() || (trimmed[0] == '#' && trimmed != rest);
+    }
+
+    bool is_null(std::string_view plain) {
+      return plain.empty() || plain == "~" || plain == "null" ||
+             plain == "Null" || plain == "NULL";
+    }
+
+    // yaml-cpp's convert<bool>: y, yes, true and on or their opposites, in
+    // lower case, upper case or capitalized.
+    std::optional<bool> to_bool(std::string_view text) {
+      const auto all = [](std::string_view part, char first, char last) {
+        return std::all_of(part.begin(), part.end(), [&](char character) {
+          return first <= character && character <= last;
+        });
+      };
+      if (text.empty() || text.size() > 5 ||
+          !(all(text, 'a', 'z') ||
+            (all(text.substr(0, 1), 'A', 'Z') &&
+             (all(text.substr(1), 'a', 'z') ||
+              all(text.substr(1), 'A', 'Z'))))) {
+        return std::nullopt;
+      }
+
+      std::string lower(text);
+      for (auto& character : lower) {
+        character = static_cast<char>(character | 0x20);
+      }
+      if (lower == "y" || lower == "yes" || lower == "true" || lower == "on") {
+        return true;
+      }
+      if (lower == "n" || lower == "no" || lower == "false" ||
+          lower == "off") {
+        return false;
+      }
+      return std::nullopt;
+    }
+
+    bool is_digits(std::string_view text) {
+      return !text.empty() &&
+             std::all_of(text.begin(), text.end(), [](char character) {
+               return '0' <= character && character <= '9';
+             });
+    }
+
+    // yaml_to_json tries bool, int64, double and then string, decoding the
+    // numbers with std::istream. Only unambiguous decimal numbers are decoded
+    // here; octal, hex, exponents, infinities and the like fall back.
+    bool scalar(std::string_view text, bool plain, node_t& node) {
+      if (plain && is_null(text)) {
+        node.reset();
+        return true;
+      }
+      if (const auto value = to_bool(text); value.has_value()) {
+        node = *value;
+        return true;
+      }
+
+      const auto unsigned_text =
+          !text.empty() && text[0] == '-' ? text.substr(1) : text;
+      const auto dot = unsigned_text.find('.');
+      if (is_digits(unsigned_text) &&
+          (unsigned_text.size() == 1 || unsigned_text[0] != '0')) {
+        int64_t value = 0;
+        const auto [end, error] =
+            std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc() || end != text.data() + text.size()) {
+          return false;
+        }
+        node = value;
+        return true;
+      }
+      if (dot != std::string_view::npos &&
+          is_digits(unsigned_text.substr(0, dot)) &&
+          is_digits(unsigned_text.substr(dot + 1))) {
+        node = std::strtod(std::string(text).c_str(), nullptr);
+        return true;
+      }
+
+      if (!unsigned_text.empty() &&
+          (std::strchr("0123456789.+", unsigned_text[0]) != nullptr)) {
+        return false;
+      }
+      std::string lower(text);
+      std::transform(lower.begin(), lower.end(), lower.begin(),
+                     [](unsigned char character) {
+                       return static_cast<char>(std::tolower(character));
+                     });
+      if (lower == "inf" || lower == "infinity" || lower == "nan") {
+        return false;
+      }
+
+      node = std::string(text);
+      return true;
+    }
+
+    // Reads a quoted scalar at the start of `text` and advances past it.
+    bool quoted(std::string_view& text, node_t& node) {
+      const char quote = text[0];
+      std::string value;
+      std::size_t index = 1;
+      while (true) {
+        if (index >= text.size()) {
+          return false;
+        }
+        const char character = text[index];
+        if (character == quote) {
+          if (quote == '\'' && index + 1 < text.size() &&
+              text[index + 1] == '\'') {
+            value += '\'';
+            index += 2;
+            continue;
+          }
+          break;
+        }
+        if (quote == '"' && character == '\\') {
+          if (index + 1 >= text.size()) {
+            return false;
+          }
+          switch (text[index + 1]) {
+            case '\\':
+            case '"':
+            case '/':
+              value += text[index + 1];
+              break;
+            case 'n':
+              value += '\n';
+              break;
+            case 't':
+              value += '\t';
+              break;
+            default:
+              return false;
+          }
+          index += 2;
+          continue;
+        }
+        value += character;
+        index++;
+      }
+
+      text.remove_prefix(index + 1);
+      return scalar(value, false, node);
+    }
+
+    // Reads a flow node at the start of `text` and advances past it.
+    bool flow(std::string_view& text, node_t& node) {
+      text = trim_left(text);
+      if (text.empty()) {
+        return false;
+      }
+
+      if (text[0] == '[') {
+        auto array = nlohmann::json::array();
+        text = trim_left(text.substr(1));
+        if (!text.empty() && text[0] == ']') {
+          text.remove_prefix(1);
+          node = std::move(array);
+          return true;
+        }
+        while (true) {
+          node_t item;
+          if (!flow(text, item)) {
+            return false;
+          }
+          if (item.has_value()) {
+            array.emplace_back(std::move(*item));
+          }
+          text = trim_left(text);
+          if (text.empty()) {
+            return false;
+          }
+          text.remove_prefix(1);
+          if (text.data()[-1] == ']') {
+            break;
+          }
+          if (text.data()[-1] != ',' || trim_left(text).substr(0, 1) == "]") {
+            return false;
+          }
+        }
+        node = std::move(array);
+        return true;
+      }
+
+      if (text[0] == '{') {
+        auto object = nlohmann::json::object();
+        text = trim_left(text.substr(1));
+        if (!text.empty() && text[0] == '}') {
+          text.remove_prefix(1);
+          node = std::move(object);
+          return true;
+        }
+        while (true) {
+          const auto colon = text.find(": ");
+          if (colon == std::string_view::npos) {
+            return false;
+          }
+          const auto key = trim_right(trim_left(text.substr(0, colon)));
+          if (key.empty() || is_indicator(key[0]) || is_null(key) ||
+              key.find_first_of(",[]{}#:?") != std::string_view::npos) {
+            return false;
+          }
+          text.remove_prefix(colon + 2);
+          if (const auto value = trim_left(text);
+              value.empty() || value[0] == ',' || value[0] == '}') {
+            return false;
+          }
+          node_t value;
+          if (!flow(text, value)) {
+            return false;
+          }
+          if (value.has_value()) {
+            object[std::string(key)] = std::move(*value);
+          }
+          text = trim_left(text);
+          if (text.empty()) {
+            return false;
+          }
+          text.remove_prefix(1);
+          if (text.data()[-1] == '}') {
+            break;
+          }
+          if (text.data()[-1] != ',' || trim_left(text).substr(0, 1) == "}") {
+            return false;
+          }
+        }
+        node = std::move(object);
+        return true;
+      }
+
+      if (text[0] == '"' || text[0] == '\'') {
+        return quoted(text, node);
+      }
+      if (!starts_plain(text)) {
+        return false;
+      }
+      // yaml-cpp also rejects "?" inside flow scalars.
+      const auto end = std::min(text.find_first_of(",[]{}#:?"), text.size());
+      if (end < text.size() && std::strchr(",]}", text[end]) == nullptr) {
+        return false;
+      }
+      const auto plain = trim_right(text.substr(0, end));
+      text.remove_prefix(end);
+      return scalar(plain, true, node);
+    }
+
+    class Reader {
+     public:
+      explicit Reader(std::string_view yaml) {
+        while (!yaml.empty()) {
+          const auto* newline = static_cast<const char*>(
+              std::memchr(yaml.data(), '\n', yaml.size()));
+          const auto size = newline == nullptr
+                                ? yaml.size()
+                                : static_cast<std::size_t>(newline -
+                                                           yaml.data());
+          const auto raw = yaml.substr(0, size);
+          const auto indent = std::min(raw.find_first_not_of(' '), raw.size());
+          _lines.push_back(
+              line_t{raw, static_cast<int>(indent), raw.substr(indent)});
+          yaml.remove_prefix(std::min(size + 1, yaml.size()));
+        }
+      }
+
+      std::optional<nlohmann::json> read() {
+        if (const auto* line = peek(); line != nullptr && line->indent == 0) {
+          if (line->content[0] == '%') {
+            return std::nullopt;
+          }
+          if (line->content.substr(0, 3) == "---") {
+            if (!is_end_of_line(line->content.substr(3))) {
+              return std::nullopt;
+            }
+            _index++;
+          }
+        }
+
+        const auto* line = peek();
+        node_t root;
+        if (line == nullptr || !block(line->indent, -1, root) ||
+            peek() != nullptr || !root.has_value() ||
+            !(root->is_object() || root->is_array())) {
+          return std::nullopt;
+        }
+        return root;
+      }
+
+     private:
+      // The next line with content, skipping blank and comment lines.
+      line_t* peek() {
+        while (_index < _lines.size() && is_blank(_lines[_index].content)) {
+          _index++;
+        }
+        return _index < _lines.size() ? &_lines[_index] : nullptr;
+      }
+
+      // A node on the lines after its key or "-", or a null when none is
+      // indented past the parent. Values of maps may also be sequences at
+      // the indentation of their key.
+      bool nested(int parent_indent, bool indentless, node_t& node) {
+        const auto* line = peek();
+        if (line != nullptr && line->indent > parent_indent) {
+          return block(line->indent, parent_indent, node);
+        }
+        if (line != nullptr && indentless && line->indent == parent_indent &&
+            is_sequence_entry(line->content)) {
+          return sequence(line->indent, node);
+        }
+        node.reset();
+        return true;
+      }
+
+      // A node starting on the next line, at `indent`.
+      bool block(int indent, int parent_indent, node_t& node) {
+        auto* line = peek();
+        if (is_sequence_entry(line->content)) {
+          return sequence(indent, node);
+        }
+        if (key(line->content).has_value()) {
+          return map(indent, node);
+        }
+        _index++;
+        return inline_node(line->content, parent_indent, node);
+      }
+
+      // The key and the rest of a "key: value" line.
+      static std::optional<std::pair<std::string_view, std::string_view>> key(
+          std::string_view content) {
+        if (is_indicator(content[0])) {
+          return std::nullopt;
+        }
+        for (std::size_t index = 1; index < content.size(); index++) {
+          if (content[index] == ':' &&
+              (index + 1 == content.size() || content[index + 1] == ' ')) {
+            return std::make_pair(trim_right(content.substr(0, index)),
+                                  trim_left(content.substr(index + 1)));
+          }
+          if (content[index] == '#' && content[index - 1] == ' ') {
+            break;
+          }
+        }
+        return std::nullopt;
+      }
+
+      bool map(int indent, node_t& node) {
+        auto object = nlohmann::json::object();
+        while (const auto* line = peek()) {
+          if (line->indent < indent) {
+            break;
+          }
+          const auto entry = key(line->content);
+          if (line->indent > indent || !entry.has_value() ||
+              is_null(entry->first)) {
+            return false;
+          }
+          _index++;
+
+          node_t value;
+          if (is_blank(entry->second)
+                  ? !nested(indent, true, value)
+                  : !inline_node(entry->second, indent, value)) {
+            return false;
+          }
+          if (value.has_value()) {
+            object[std::string(entry->first)] = std::move(*value);
+          }
+        }
+        node = std::move(object);
+        return true;
+      }
+
+      bool sequence(int indent, node_t& node) {
+        auto array = nlohmann::json::array();
+        while (auto* line = peek()) {
+          if (line->indent < indent) {
+            break;
+          }
+          if (line->indent > indent) {
+            return false;
+          }
+          if (!is_sequence_entry(line->content)) {
+            break;
+          }
+
+          const auto rest = trim_left(line->content.substr(1));
+          node_t item;
+          if (is_blank(rest)) {
+            _index++;
+            if (!nested(indent, false, item)) {
+              return false;
+            }
+          } else {
+            line->indent = static_cast<int>(rest.data() - line->raw.data());
+            line->content = rest;
+            if (!block(line->indent, indent, item)) {
+              return false;
+            }
+          }
+          if (item.has_value()) {
+            array.emplace_back(std::move(*item));
+          }
+        }
+        node = std::move(array);
+        return true;
+      }
+
+      // A node that starts on an already consumed line, after a key, a "-"
+      // or nothing. No line after it may be indented past the parent.
+      bool inline_node(std::string_view text, int parent_indent,
+                       node_t& node) {
+        if (text[0] == '|' || text[0] == '>') {
+          if (!block_scalar(text, parent_indent, node)) {
+            return false;
+          }
+        } else if (text[0] == '[' || text[0] == '{' || text[0] == '"' ||
+                   text[0] == '\'') {
+          if (!flow(text, node) || !is_end_of_line(text)) {
+            return false;
+          }
+        } else {
+          if (!starts_plain(text)) {
+            return false;
+          }
+          const auto end = text.find(" #");
+          const auto plain = trim_right(text.substr(0, end));
+          if (plain.find(": ") != std::string_view::npos ||
+              plain.back() == ':' || !scalar(plain, true, node)) {
+            return false;
+          }
+        }
+
+        const auto* line = peek();
+        return line == nullptr || line->indent <= parent_indent;
+      }
+
+      // A literal or folded scalar with clipped or stripped line breaks, and
+      // without an explicit indentation, leading blank lines or lines
+      // indented past the others in folded scalars.
+      bool block_scalar(std::string_view header, int parent_indent,
+                        node_t& node) {
+        const bool literal = header[0] == '|';
+        header.remove_prefix(1);
+        const bool strip = !header.empty() && header[0] == '-';
+        if (strip) {
+          header.remove_prefix(1);
+        }
+        if (!header.empty() && (header[0] != ' ' || !is_end_of_line(header))) {
+          return false;
+        }
+
+        std::string value;
+        std::size_t indent = 0;
+        std::size_t blank_lines = 0;
+        auto index = _index;
+        for (; index < _lines.size(); index++) {
+          const auto raw = _lines[index].raw;
+          const auto spaces = std::min(raw.find_first_not_of(' '), raw.size());
+          if (spaces == raw.size()) {
+            if (indent == 0 || spaces > indent) {
+              return false;
+            }
+            blank_lines++;
+            continue;
+          }
+          if (indent == 0) {
+            if (static_cast<int>(spaces) <= parent_indent) {
+              return false;
+            }
+            indent = spaces;
+          } else if (spaces < indent) {
+            break;
+          } else if (literal) {
+            value.append(blank_lines + 1, '\n');
+          } else if (blank_lines == 0) {
+            value += ' ';
+          } else {
+            value.append(blank_lines, '\n');
+          }
+          if (!literal && spaces > indent) {
+            return false;
+          }
+          value.append(raw.substr(indent));
+          blank_lines = 0;
+          _index = index + 1;
+        }
+        if (indent == 0) {
+          return false;
+        }
+
+        if (!strip) {
+          value += '\n';
+        }
+        node = std::move(value);
+        return true;
+      }
+
+      std::vector<line_t> _lines;
+      std::size_t _index = 0;
+    };
+  }  // namespace
+
+  std::optional<nlohmann::json> read(std::string_view yaml) {
+    if (yaml.substr(0, 3) == "\xEF\xBB\xBF" || has_unsupported_bytes(yaml)) {
+      return std::nullopt;
+    }
+    return Reader(yaml).read();
+  }
+
+  bool has_unsupported_bytes(std::string_view yaml) {
+    std::size_t index = 0;
+#if defined(__SSE2__)
+    const auto tab = _mm_set1_epi8('\t');
+    const auto carriage_return = _mm_set1_epi8('\r');
+    for (; index + 16 <= yaml.size(); index += 16) {
+      const auto chunk = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(yaml.data() + index));
+      const auto matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, tab),
+                                        _mm_cmpeq_epi8(chunk, carriage_return));
+      if (_mm_movemask_epi8(matches) != 0) {
+        return true;
+      }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const auto tab = vdupq_n_u8('\t');
+    const auto carriage_return = vdupq_n_u8('\r');
+    for (; index + 16 <= yaml.size(); index += 16) {
+      const auto chunk =
+          vld1q_u8(reinterpret_cast<const uint8_t*>(yaml.data() + index));
+      const auto matches = vorrq_u8(vceqq_u8(chunk, tab),
+                                    vceqq_u8(chunk, carriage_return));
+      if (vmaxvq_u8(matches) != 0) {
+        return true;
+      }
+    }
+#endif
+    for (; index < yaml.size(); index++) {
+      if (yaml[index] == '\t' || yaml[index] == '\r') {
+        return true;
+      }
+    }
+    return false;
+  }
+}  // namespace fx::parser::yaml_reader
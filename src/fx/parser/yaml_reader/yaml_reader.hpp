@@ -0,0 +1,19 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string_view>
+
+// A fast path for the YAML that descriptors are written in: block maps and
+// sequences, single line flow collections, and plain, quoted, literal and
+// folded scalars. The result equals yaml_to_json::convert of what yaml-cpp
+// loads. Anything else, including invalid YAML, returns nothing so that the
+// caller falls back to yaml-cpp, which knows the rest and reports errors.
+namespace fx::parser::yaml_reader {
+  std::optional<nlohmann::json> read(std::string_view yaml);
+
+  // Whether `yaml` has a tab or a carriage return, which make indentation and
+  // line breaks ambiguous and are left to yaml-cpp. Vectorized on SSE2 and
+  // NEON.
+  bool has_unsupported_bytes(std::string_view yaml);
+}  // namespace fx::parser::yaml_reader
@@ -208,6 +208,7 @@
 
 #include <string>
 #include <type_traits>
+#include <utility>
 
 namespace fx::result {
   namespace types {
@@ -260,11 +261,11 @@ namespace fx::result {
     Storage() : _initialized(false) {}
 
     void construct(types::Ok<T> ok) {
-      new (&_storage) T(ok.value);
+      new (&_storage) T(std::move(ok.value));
       _initialized = true;
     }
     void construct(types::Err<E> err) {
-      new (&_storage) E(err.value);
+      new (&_storage) E(std::move(err.value));
       _initialized = true;
     }
 
@@ -313,7 +314,7 @@ namespace fx::result {
     }
 
     void construct(types::Err<E> err) {
-      new (&_storage) E(err.value);
+      new (&_storage) E(std::move(err.value));
       _initialized = true;
     }
 
@@ -388,6 +389,21 @@ namespace fx::result {
     }
   };
 
+  template <typename T, typename E>
+  struct Result;
+
+  namespace detail {
+    template <typename F, typename T>
+    struct invoke_result {
+      typedef typename std::invoke_result<F, T&&>::type type;
+    };
+
+    template <typename F>
+    struct invoke_result<F, void> {
+      typedef typename std::invoke_result<F>::type type;
+    };
+  }  // namespace detail
+
   template <typename T, typename E = std::string>
   struct Result {
     static_assert(!std::is_same<E, void>::value,
@@ -438,15 +454,94 @@ namespace fx::result {
     }
 
     template <typename U = T>
-    typename std::enable_if<!std::is_same<U, void>::value, U>::type value()
-        const {
+    typename std::enable_if<!std::is_same<U, void>::value, const U&>::type
+    value() const& {
+      return _storage.template get<U>();
+    }
+
+    template <typename U = T>
+    typename std::enable_if<!std::is_same<U, void>::value, U&>::type
+    value() & {
       return _storage.template get<U>();
     }
 
-    E error() const {
+    template <typename U = T>
+    typename std::enable_if<!std::is_same<U, void>::value, U>::type
+    value() && {
+      return std::move(_storage.template get<U>());
+    }
+
+    // Moves the value out, leaving this result holding a moved-from value.
+    template <typename U = T>
+    typename std::enable_if<!std::is_same<U, void>::value, U>::type
+    take() && {
+      return std::move(_storage.template get<U>());
+    }
+
+    const E& error() const& {
       return _storage.template get<E>();
     }
 
+    E& error() & {
+      return _storage.template get<E>();
+    }
+
+    E error() && {
+      return std::move(_storage.template get<E>());
+    }
+
+    // Calls `function` with the value and wraps what it returns. Errors are
+    // passed through untouched.
+    template <typename F>
+    Result<typename detail::invoke_result<F, T>::type, E> map(F&& function) && {
+      typedef typename detail::invoke_result<F, T>::type R;
+      if (!_ok) {
+        return types::Err<E>(std::move(_storage.template get<E>()));
+      }
+
+      if constexpr (std::is_void<T>::value && std::is_void<R>::value) {
+        function();
+        return types::Ok<void>();
+      } else if constexpr (std::is_void<T>::value) {
+        return types::Ok<R>(function());
+      } else if constexpr (std::is_void<R>::value) {
+        function(std::move(_storage.template get<T>()));
+        return types::Ok<void>();
+      } else {
+        return types::Ok<R>(function(std::move(_storage.template get<T>())));
+      }
+    }
+
+    // Like map, but `function` returns a Result itself, which is returned as
+    // is.
+    template <typename F>
+    typename detail::invoke_result<F, T>::type and_then(F&& function) && {
+      if (!_ok) {
+        return types::Err<E>(std::move(_storage.template get<E>()));
+      }
+
+      if constexpr (std::is_void<T>::value) {
+        return function();
+      } else {
+        return function(std::move(_storage.template get<T>()));
+      }
+    }
+
+    template <typename F>
+    Result<T, typename std::invoke_result<F, E&&>::type> map_error(
+        F&& function) && {
+      typedef typename std::invoke_result<F, E&&>::type R;
+      if (!_ok) {
+        return types::Err<R>(function(std::move(_storage.template get<E>())));
+      }
+
+      if constexpr (std::is_void<T>::value) {
+        return types::Ok<void>();
+      } else {
+        return types::Ok<T>(std::move(_storage.template get<T>()));
+      }
+    }
+
    private:
     bool _ok;
     Storage<T, E> _storage;
@@ -0,0 +1,194 @@
+#include "suggest.hpp"
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+#include <algorithm>
+#include <utility>
+
+namespace fx::suggest {
+  namespace {
+    struct match_t {
+      std::size_t distance;
+      std::string word;
+
+      bool operator<(const match_t& other) const {
+        return std::tie(distance, word) < std::tie(other.distance, other.word);
+      }
+    };
+
+    // Walks the trie depth first, extending one row of the Wagner-Fischer
+    // matrix per edge. Rows are shared by every word with the same prefix, and
+    // a subtree is skipped once no cell of its row is within max_distance.
+    class Search {
+     public:
+      Search(const fx::suggest::v1beta::Trie& trie, std::string_view word,
+             std::size_t max_distance)
+          : _trie(trie), _word(word), _max_distance(max_distance) {}
+
+      std::vector<match_t> run() {
+        const std::size_t width = _word.size() + 1;
+        _rows.resize(width);
+        for (std::size_t column = 0; column < width; column++) {
+          _rows[column] = column;
+        }
+        visit(0, 0);
+        return std::move(_matches);
+      }
+
+     private:
+      void visit(uint32_t node, std::size_t depth) {
+        const std::size_t width = _word.size() + 1;
+        const auto end = _trie.child_offsets(static_cast<int>(node) + 1);
+        for (auto child = _trie.child_offsets(static_cast<int>(node));
+             child < end; child++) {
+          const char label = _trie.labels()[child];
+          _rows.resize((depth + 2) * width);
+          const std::size_t* previous = &_rows[depth * width];
+          std::size_t* row = &_rows[(depth + 1) * width];
+
+          row[0] = previous[0] + 1;
+          std::size_t lowest = row[0];
+          for (std::size_t column = 1; column < width; column++) {
+            row[column] = std::min(
+                {previous[column] + 1, row[column - 1] + 1,
+                 previous[column - 1] + (_word[column - 1] == label ? 0 : 1)});
+            lowest = std::min(lowest, row[column]);
+          }
+          if (lowest > _max_distance) {
+            continue;
+          }
+
+          _prefix.push_back(label);
+          if (_trie.terminal(static_cast<int>(child)) &&
+              row[width - 1] <= _max_distance) {
+            _matches.push_back(match_t{row[width - 1], _prefix});
+          }
+          visit(child, depth + 1);
+          _prefix.pop_back();
+        }
+      }
+
+      const fx::suggest::v1beta::Trie& _trie;
+      std::string_view _word;
+      std::size_t _max_distance;
+      // One row per depth, the row of depth d at d * (word size + 1).
+      std::vector<std::size_t> _rows;
+      std::string _prefix;
+      std::vector<match_t> _matches;
+    };
+
+    // The trie may come from a cache file written by anything, so it is
+    // checked before it is walked: every child comes after its parent, and
+    // the children of each node are a range of existing nodes.
+    bool is_valid(const fx::suggest::v1beta::Trie& trie) {
+      const auto nodes = static_cast<uint32_t>(trie.terminal_size());
+      if (nodes == 0 || trie.child_offsets_size() != trie.terminal_size() + 1 ||
+          trie.labels().size() != nodes || trie.child_offsets(0) != 1 ||
+          trie.child_offsets(trie.terminal_size()) != nodes) {
+        return false;
+      }
+      for (uint32_t node = 1; node <= nodes; node++) {
+        const auto begin = trie.child_offsets(static_cast<int>(node));
+        if (begin < trie.child_offsets(static_cast<int>(node) - 1) ||
+            (node < nodes && begin <= node)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }  // namespace
+
+  std::size_t distance(std::string_view left, std::string_view right) {
+    std::vector<std::size_t> row(right.size() + 1);
+    for (std::size_t column = 0; column <= right.size(); column++) {
+      row[column] = column;
+    }
+    for (std::size_t line = 1; line <= left.size(); line++) {
+      std::size_t diagonal = row[0];
+      row[0] = line;
+      for (std::size_t column = 1; column <= right.size(); column++) {
+        const std::size_t above = row[column];
+        row[column] = std::min(
+            {above + 1, row[column - 1] + 1,
+             diagonal + (left[line - 1] == right[column - 1] ? 0 : 1)});
+        diagonal = above;
+      }
+    }
+    return row[right.size()];
+  }
+
+  fx::suggest::v1beta::Trie build(std::vector<std::string> words) {
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    // Each node covers the sorted words sharing its prefix, so its children
+    // are the runs of equal bytes right after the prefix.
+    struct range_t {
+      std::size_t begin;
+      std::size_t end;
+      std::size_t depth;
+    };
+    std::vector<range_t> nodes{{0, words.size(), 0}};
+    fx::suggest::v1beta::Trie trie;
+    std::string labels(1, '\0');
+    for (std::size_t node = 0; node < nodes.size(); node++) {
+      const auto [begin, end, depth] = nodes[node];
+      const bool terminal = begin < end && words[begin].size() == depth;
+      trie.add_terminal(terminal);
+      trie.add_child_offsets(static_cast<uint32_t>(nodes.size()));
+
+      for (auto child = terminal ? begin + 1 : begin; child < end;) {
+        const char label = words[child][depth];
+        auto child_end = child;
+        while (child_end < end && words[child_end][depth] == label) {
+          child_end++;
+        }
+        nodes.push_back(range_t{child, child_end, depth + 1});
+        labels.push_back(label);
+        child = child_end;
+      }
+    }
+    trie.add_child_offsets(static_cast<uint32_t>(nodes.size()));
+    trie.set_labels(std::move(labels));
+    return trie;
+  }
+
+  std::vector<std::string> search(const fx::suggest::v1beta::Trie& trie,
+                                  std::string_view word,
+                                  std::size_t max_distance,
+                                  std::size_t limit) {
+    if (!is_valid(trie)) {
+      return {};
+    }
+
+    auto matches = Search(trie, word, max_distance).run();
+    std::sort(matches.begin(), matches.end());
+    std::vector<std::string> words;
+    for (std::size_t index = 0; index < matches.size() && index < limit;
+         index++) {
+      words.push_back(std::move(matches[index].word));
+    }
+    return words;
+  }
+
+  std::vector<std::string> suggest(const fx::suggest::v1beta::Trie& trie,
+                                   std::string_view word) {
+    return search(trie, word, word.size() < 3 ? 1 : 2, 3);
+  }
+
+  std::string did_you_mean(const std::vector<std::string>& suggestions) {
+    if (suggestions.empty()) {
+      return std::string();
+    }
+    std::vector<std::string> quoted;
+    for (const auto& suggestion : suggestions) {
+      quoted.push_back(fmt::format("\"{0}\"", suggestion));
+    }
+    if (quoted.size() == 1) {
+      return fmt::format(" Did you mean {0}?", quoted.back());
+    }
+    const auto last = quoted.back();
+    quoted.pop_back();
+    return fmt::format(" Did you mean {0} or {1}?", fmt::join(quoted, ", "),
+                       last);
+  }
+}  // namespace fx::suggest
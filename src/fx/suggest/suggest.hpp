@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "fx/suggest/v1beta/suggest.pb.h"
+
+// "Did you mean" suggestions for misspelled command and option names.
+namespace fx::suggest {
+  // The Levenshtein distance between the words, in bytes.
+  std::size_t distance(std::string_view left, std::string_view right);
+
+  fx::suggest::v1beta::Trie build(std::vector<std::string> words);
+
+  // Up to `limit` words within `max_distance` of `word`, closest first and
+  // alphabetical among equally close words.
+  std::vector<std::string> search(const fx::suggest::v1beta::Trie& trie,
+                                  std::string_view word,
+                                  std::size_t max_distance,
+                                  std::size_t limit);
+
+  // Up to three words within an edit distance of 2 of `word`, or of 1 for
+  // words shorter than 3 bytes, which would otherwise match almost anything.
+  std::vector<std::string> suggest(const fx::suggest::v1beta::Trie& trie,
+                                   std::string_view word);
+
+  // " Did you mean "a"?", " Did you mean "a" or "b"?" and so on, or nothing
+  // without suggestions. Meant to be appended to an error message.
+  std::string did_you_mean(const std::vector<std::string>& suggestions);
+}  // namespace fx::suggest
@@ -0,0 +1,148 @@
+#include "mapping.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace fx::util {
+  namespace {
+    // Puts a file of `size` bytes that starts with `layout` at `path`, zero
+    // filled otherwise. It is built under a temporary name and then linked
+    // into place, or renamed over whatever is there when `replace`, so no
+    // process ever maps it half made, and files other processes have mapped
+    // are never resized.
+    bool create(const std::filesystem::path& path,
+                const layout_t& layout,
+                std::size_t size,
+                bool replace) {
+      auto temporary = path;
+      temporary += ".tmp." + std::to_string(getpid());
+      const int descriptor =
+          ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                 0644);
+      if (descriptor < 0) {
+        return false;
+      }
+      const bool written =
+          ftruncate(descriptor, size) == 0 &&
+          pwrite(descriptor, &layout, sizeof(layout), 0) ==
+              static_cast<ssize_t>(sizeof(layout));
+      ::close(descriptor);
+
+      bool placed = false;
+      if (written && replace) {
+        placed = ::rename(temporary.c_str(), path.c_str()) == 0;
+      } else if (written) {
+        // Losing the race to another creator is fine: theirs is just as new.
+        placed = ::link(temporary.c_str(), path.c_str()) == 0 ||
+                 errno == EEXIST;
+      }
+      if (!placed || !replace) {
+        ::unlink(temporary.c_str());
+      }
+      return placed;
+    }
+
+    // `path` mapped when it has `size` bytes and starts with `layout`.
+    void* map(const std::filesystem::path& path,
+              const layout_t& layout,
+              std::size_t size,
+              bool writable) {
+      const int descriptor = ::open(
+          path.c_str(), writable ? O_RDWR | O_CLOEXEC : O_RDONLY | O_CLOEXEC);
+      if (descriptor < 0) {
+        return nullptr;
+      }
+
+      struct stat status {};
+      void* address = MAP_FAILED;
+      if (fstat(descriptor, &status) == 0 &&
+          static_cast<std::size_t>(status.st_size) == size) {
+        address = mmap(nullptr, size,
+                       writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                       MAP_SHARED, descriptor, 0);
+      }
+      ::close(descriptor);
+      if (address == MAP_FAILED) {
+        return nullptr;
+      }
+      if (std::memcmp(address, &layout, sizeof(layout)) != 0) {
+        munmap(address, size);
+        return nullptr;
+      }
+      return address;
+    }
+  }  // namespace
+
+  SharedMapping::SharedMapping(const std::filesystem::path& path,
+                               const layout_t& layout,
+                               std::size_t size,
+                               bool writable)
+      : _size(size) {
+    _address = map(path, layout, size, writable);
+    // Missing, or written by another layout that processes may still have
+    // mapped.
+    if (_address == nullptr && writable &&
+        create(path, layout, size, ::access(path.c_str(), F_OK) == 0)) {
+      _address = map(path, layout, size, writable);
+    }
+  }
+
+  SharedMapping::~SharedMapping() {
+    if (_address != nullptr) {
+      munmap(_address, _size);
+    }
+  }
+
+  void* SharedMapping::address() const {
+    return _address;
+  }
+
+  FileMapping::FileMapping(const std::filesystem::path& path) {
+    const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0) {
+      return;
+    }
+
+    struct stat status {};
+    if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+      ::close(descriptor);
+      return;
+    }
+    _size = static_cast<std::size_t>(status.st_size);
+    // mmap rejects empty lengths.
+    if (_size == 0) {
+      ::close(descriptor);
+      _ok = true;
+      return;
+    }
+
+    void* address =
+        mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (address != MAP_FAILED) {
+      _address = address;
+      _ok = true;
+    }
+  }
+
+  FileMapping::~FileMapping() {
+    if (_address != nullptr) {
+      munmap(_address, _size);
+    }
+  }
+
+  bool FileMapping::ok() const {
+    return _ok;
+  }
+
+  std::string_view FileMapping::contents() const {
+    if (_address == nullptr) {
+      return std::string_view();
+    }
+    return std::string_view(static_cast<const char*>(_address), _size);
+  }
+}  // namespace fx::util
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace fx::util {
+  // Identifies what a SharedMapping holds. Stored at the start of the file,
+  // ahead of the rest of its owner's header.
+  struct layout_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t capacity;
+  };
+
+  // A file of exactly `size` bytes that starts with `layout`, mapped shared
+  // so concurrent processes see each other's writes. A writable mapping
+  // creates the file, and replaces one with another size or layout by a new
+  // file instead of resizing it under the processes that have it mapped.
+  // Unmapped when it goes out of scope.
+  class SharedMapping {
+   public:
+    SharedMapping(const std::filesystem::path& path,
+                  const layout_t& layout,
+                  std::size_t size,
+                  bool writable);
+    ~SharedMapping();
+
+    SharedMapping(const SharedMapping&) = delete;
+    SharedMapping& operator=(const SharedMapping&) = delete;
+
+    // nullptr when the file could not be opened or mapped, or holds another
+    // layout.
+    void* address() const;
+
+   private:
+    void* _address = nullptr;
+    std::size_t _size;
+  };
+
+  // A whole file mapped read-only and private, to read small files without
+  // copying them. Unmapped when it goes out of scope.
+  class FileMapping {
+   public:
+    explicit FileMapping(const std::filesystem::path& path);
+    ~FileMapping();
+
+    FileMapping(const FileMapping&) = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+
+    // False when the file could not be opened or mapped.
+    bool ok() const;
+
+    std::string_view contents() const;
+
+   private:
+    void* _address = nullptr;
+    std::size_t _size = 0;
+    bool _ok = false;
+  };
+}  // namespace fx::util
@@ -1,6 +1,8 @@
 #include "util.hpp"
+#include <fmt/core.h>
+#include <unistd.h>
 #include <algorithm>
-#include <cstring>
+#include <fstream>
 
 namespace fx::util {
   bool icompare(std::string const& left, std::string const& right) {
@@ -45,16 +47,41 @@ namespace fx::util {
     return fx::result::Ok(workspace);
   }
 
-  char** c_vector_string(const std::vector<std::string>& strings) {
-    char** result = new char*[strings.size() + 1];
+  double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  }
 
-    for (int i = 0; i < strings.size(); ++i) {
-      result[i] = new char[strings[i].size() + 1];
-      std::memcpy(result[i], strings[i].c_str(), strings[i].size() + 1);
+  fx::result::Result<void> write_atomically(
+      const std::filesystem::path& path,
+      std::string_view contents,
+      std::filesystem::perms permissions) {
+    const auto temporary_path =
+        path.parent_path() /
+        fmt::format(".{0}.{1}.tmp", path.filename().u8string(), getpid());
+    std::error_code error;
+    {
+      std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+      output.write(contents.data(),
+                   static_cast<std::streamsize>(contents.size()));
+      if (!output) {
+        std::filesystem::remove(temporary_path, error);
+        return fx::result::Error(
+            fmt::format("Unable to write {0}.", temporary_path.u8string()));
+      }
     }
 
-    result[strings.size()] = nullptr;
-
-    return result;
+    std::filesystem::permissions(temporary_path, permissions, error);
+    if (!error) {
+      std::filesystem::rename(temporary_path, path, error);
+    }
+    if (error) {
+      std::error_code remove_error;
+      std::filesystem::remove(temporary_path, remove_error);
+      return fx::result::Error(fmt::format(
+          "Unable to write {0}: {1}.", path.u8string(), error.message()));
+    }
+    return fx::result::Ok();
   }
 }  // namespace fx::util
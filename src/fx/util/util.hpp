@@ -1,7 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <filesystem>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "fx/result/result.hpp"
 
@@ -13,5 +17,67 @@ namespace fx::util {
 
   fx::result::Result<std::filesystem::path> workspace_descriptor_path();
 
-  char** c_vector_string(const std::vector<std::string>& strings);
+  double seconds_since(std::chrono::steady_clock::time_point start);
+
+  // Replaces `path` with `contents` through a temporary file in the same
+  // directory and a rename, so readers see either the old file or the new
+  // one and never part of either.
+  fx::result::Result<void> write_atomically(
+      const std::filesystem::path& path,
+      std::string_view contents,
+      std::filesystem::perms permissions =
+          std::filesystem::perms::owner_read |
+          std::filesystem::perms::owner_write |
+          std::filesystem::perms::group_read |
+          std::filesystem::perms::others_read);
+
+  // A read-only view over contiguous elements, standing in for std::span
+  // until the tree moves to C++20.
+  template <typename T>
+  class Span {
+   public:
+    typedef const T* iterator;
+
+    constexpr Span() = default;
+
+    constexpr Span(const T* data, std::size_t size)
+        : _data(data), _size(size) {}
+
+    Span(const std::vector<T>& values) : Span(values.data(), values.size()) {}
+
+    // Like any view of a temporary, only valid for the full expression.
+    constexpr Span(std::initializer_list<T> values)
+        : Span(values.begin(), values.size()) {}
+
+    constexpr iterator begin() const {
+      return _data;
+    }
+
+    constexpr iterator end() const {
+      return _data + _size;
+    }
+
+    constexpr std::size_t size() const {
+      return _size;
+    }
+
+    constexpr bool empty() const {
+      return _size == 0;
+    }
+
+    constexpr const T& operator[](std::size_t index) const {
+      return _data[index];
+    }
+
+    constexpr Span subspan(std::size_t offset) const {
+      return offset >= _size ? Span() : Span(_data + offset, _size - offset);
+    }
+
+   private:
+    const T* _data = nullptr;
+    std::size_t _size = 0;
+  };
+
+  // Command line arguments, viewing argv itself.
+  typedef Span<std::string_view> arguments_t;
 }  // namespace fx::util
@@ -10,7 +10,9 @@ struct Parse : testing::Test {
       const fx::descriptor::v1beta::FxCommandDescriptor &descriptor,
       const std::vector<std::string> &arguments,
       const nlohmann::json &expected) {
-    const auto result = fx::argparse::parse(arguments, descriptor);
+    const std::vector<std::string_view> views(arguments.begin(),
+                                              arguments.end());
+    const auto result = fx::argparse::parse(views, descriptor);
     ASSERT_TRUE(result.ok()) << result.error();
     EXPECT_EQ(expected, result.value());
   }
@@ -19,7 +21,9 @@ struct Parse : testing::Test {
       const fx::descriptor::v1beta::FxCommandDescriptor &descriptor,
       const std::vector<std::string> &arguments,
       const std::string &expected_messge) {
-    const auto result = fx::argparse::parse(arguments, descriptor);
+    const std::vector<std::string_view> views(arguments.begin(),
+                                              arguments.end());
+    const auto result = fx::argparse::parse(views, descriptor);
     ASSERT_TRUE(result.failed());
     EXPECT_EQ(expected_messge, result.error());
   }
@@ -608,6 +612,54 @@ TEST_F(Parse, OverloadScalarStringOptionType) {
                     "[argparse] Unrecognized token: --string-test");
 };
 
+TEST_F(Parse, MisspelledOptionSuggestion) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "verbose", "short_name": "v", "bool_value": {}},
+        {"name": "version", "bool_value": {}}
+      ]
+    }
+  )"_json);
+
+  expect_parse_fail(
+      descriptor, {"--verbos"},
+      "[argparse] Unrecognized token: --verbos. Did you mean "
+      "\"--verbose\"?");
+  expect_parse_fail(
+      descriptor, {"-V"},
+      "[argparse] Unrecognized token: -V. Did you mean \"-v\"?");
+  expect_parse_fail(
+      descriptor, {"--vrebose=true"},
+      "[argparse] Unrecognized token: --vrebose=true. Did you mean "
+      "\"--verbose\"?");
+};
+
+TEST_F(Parse, OptionShapedTokensBeforeStringArgument) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "name", "string_value": {}}
+      ],
+      "arguments": [
+        {"name": "target", "string_value": {"list": true}}
+      ]
+    }
+  )"_json);
+
+  expect_parse_fail(descriptor, {"--typo", "a"},
+                    "[argparse] Unrecognized token: --typo");
+  expect_parse_fail(descriptor, {"--name=a", "--name=b"},
+                    "[argparse] Unrecognized token: --name=b");
+  expect_parse_fail(descriptor, {"a", "-x"},
+                    "[argparse] Unrecognized token: -x");
+  expect_parse_eq(descriptor, {"-1", "-.5", "a"},
+                  R"({"help": {"user_set": false, "value": false},
+                      "name": {"user_set": false, "value": ""},
+                      "target": {"user_set": true,
+                                 "value": ["-1", "-.5", "a"]}})"_json);
+};
+
 TEST_F(Parse, OverloadScalarIntArgumentType) {
   const auto descriptor = fx::test::helper::command_descriptor(R"(
     {
@@ -713,6 +765,186 @@ TEST_F(Parse, InvalidDoubleArgumentType) {
                     "[argparse] Unable to convert 'test' to destination type");
 };
 
+TEST_F(Parse, IntOptionOutOfRange) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "int-test", "int_value": {}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--int-test",
+                                           "9223372036854775808"};
+
+  expect_parse_fail(
+      descriptor, arguments,
+      "[argparse] Value '9223372036854775808' is out of range.");
+};
+
+TEST_F(Parse, DoubleOptionOutOfRange) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "double-test", "double_value": {}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--double-test=1e400"};
+
+  expect_parse_fail(descriptor, arguments,
+                    "[argparse] Value '1e400' is out of range.");
+};
+
+TEST_F(Parse, IntOptionDoubleSign) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "int-test", "int_value": {}}
+      ]
+    }
+  )"_json);
+
+  for (const std::string value : {"+-5", "++5"}) {
+    const std::vector<std::string> arguments{"--int-test=" + value};
+
+    expect_parse_fail(descriptor, arguments,
+                      "[argparse] Unable to convert '" + value +
+                          "' to destination type");
+  }
+};
+
+TEST_F(Parse, DoubleOptionDoubleSign) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "double-test", "double_value": {}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--double-test=+-1.5"};
+
+  expect_parse_fail(descriptor, arguments,
+                    "[argparse] Unable to convert '+-1.5' to destination type");
+};
+
+TEST_F(Parse, DoubleOptionNotFinite) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "double-test", "double_value": {}}
+      ]
+    }
+  )"_json);
+
+  for (const std::string value : {"inf", "+inf", "nan", "infinity"}) {
+    const std::vector<std::string> arguments{"--double-test=" + value};
+
+    expect_parse_fail(descriptor, arguments,
+                      "[argparse] Unable to convert '" + value +
+                          "' to destination type");
+  }
+};
+
+TEST_F(Parse, DoubleListNotFinite) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "double-test", "double_value": {"list": true}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--double-test=1,nan"};
+
+  expect_parse_fail(descriptor, arguments,
+                    "[argparse] Unable to convert 'nan' to destination type");
+};
+
+TEST_F(Parse, PackedIntListOption) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "int-test", "int_value": {"list": true, "default": 7}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--int-test=1,-2,+3",
+                                           "--int-test", "4,5"};
+
+  expect_parse_eq(descriptor, arguments, R"({
+    "int-test": {"user_set": true, "value": [1, -2, 3, 4, 5]},
+    "help": {"user_set": false,"value": false}
+  })"_json);
+};
+
+TEST_F(Parse, PackedDoubleListOption) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "double-test", "double_value": {"list": true}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--double-test=1.5,-2,3e2"};
+
+  expect_parse_eq(descriptor, arguments, R"({
+    "double-test": {"user_set": true, "value": [1.5, -2.0, 300.0]},
+    "help": {"user_set": false,"value": false}
+  })"_json);
+};
+
+TEST_F(Parse, PackedIntListInvalidElement) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "int-test", "int_value": {"list": true}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--int-test=1,,3"};
+
+  expect_parse_fail(descriptor, arguments,
+                    "[argparse] Unable to convert '' to destination type");
+};
+
+TEST_F(Parse, PackedIntListInvalidChoice) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "int-test", "int_value": {"list": true, "choices": [1, 2]}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--int-test=1,905,2"};
+
+  expect_parse_fail(descriptor, arguments,
+                    "[argparse] Value '905' not expected.");
+};
+
+TEST_F(Parse, PackedStringListIsNotSplit) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "string-test", "string_value": {"list": true}}
+      ]
+    }
+  )"_json);
+
+  const std::vector<std::string> arguments{"--string-test=a,b"};
+
+  expect_parse_eq(descriptor, arguments, R"({
+    "string-test": {"user_set": true, "value": ["a,b"]},
+    "help": {"user_set": false,"value": false}
+  })"_json);
+};
+
 TEST_F(Parse, RequiredIntOptionWithoutUserInput) {
   const auto descriptor = fx::test::helper::command_descriptor(R"(
     {
@@ -0,0 +1,200 @@
+#include "fx/argparse/stream/stream.hpp"
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fx/argparse/argparse.hpp"
+#include "test/helper/helper.hpp"
+
+// TokenStream -----------------------------------------------------------------
+
+struct TokenStream : testing::Test {
+  std::filesystem::path root;
+
+  void SetUp() override {
+    root = std::filesystem::temp_directory_path() /
+           ("fx_stream_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(root);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(root);
+  }
+
+  std::string write_file(const std::string& name,
+                         const std::string& contents) {
+    const auto path = root / name;
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    return path.u8string();
+  }
+
+  // Feeds `contents` through a pipe, as a shell would for stdin.
+  static std::vector<std::string> read_all(
+      const std::vector<std::string>& arguments, const std::string& contents) {
+    int fds[2];
+    EXPECT_EQ(0, pipe(fds));
+    std::thread writer([&]() {
+      size_t written = 0;
+      while (written < contents.size()) {
+        const auto count = write(fds[1], contents.data() + written,
+                                 contents.size() - written);
+        if (count <= 0) {
+          break;
+        }
+        written += static_cast<size_t>(count);
+      }
+      close(fds[1]);
+    });
+
+    std::vector<std::string> tokens;
+    {
+      const std::vector<std::string_view> views(arguments.begin(),
+                                                arguments.end());
+      fx::argparse::stream::TokenStream stream(views, fds[0]);
+      for (;;) {
+        auto token = stream.next();
+        EXPECT_TRUE(token.ok()) << token.error();
+        if (token.failed() || !token.value().has_value()) {
+          break;
+        }
+        tokens.emplace_back(*token.value());
+      }
+    }
+    writer.join();
+    close(fds[0]);
+    return tokens;
+  }
+};
+
+TEST_F(TokenStream, PlainArguments) {
+  EXPECT_EQ((std::vector<std::string>{"--verbose", "a", "@"}),
+            read_all({"--verbose", "a", "@"}, ""));
+}
+
+TEST_F(TokenStream, NewlineResponseFile) {
+  const auto path = write_file("args", "--jobs\r\n8\n\nb c\n");
+
+  EXPECT_EQ((std::vector<std::string>{"a", "--jobs", "8", "b c", "d"}),
+            read_all({"a", "@" + path, "d"}, ""));
+}
+
+TEST_F(TokenStream, NulResponseFile) {
+  const auto path = write_file("args", std::string("a\nb\0\0c\0", 7));
+
+  EXPECT_EQ((std::vector<std::string>{"a\nb", "", "c"}),
+            read_all({"@" + path}, ""));
+}
+
+TEST_F(TokenStream, EmptyResponseFile) {
+  const auto path = write_file("args", "");
+
+  EXPECT_EQ((std::vector<std::string>{"a"}), read_all({"@" + path, "a"}, ""));
+}
+
+TEST_F(TokenStream, MissingResponseFile) {
+  const auto path = (root / "missing").u8string();
+  const std::string argument = "@" + path;
+  const std::vector<std::string_view> arguments{argument};
+
+  fx::argparse::stream::TokenStream stream(arguments);
+  const auto actual = stream.next();
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(fmt::format("Unable to read arguments from {0}: No such file or "
+                        "directory.",
+                        path),
+            actual.error());
+}
+
+TEST_F(TokenStream, DirectoryResponseFile) {
+  const std::string argument = "@" + root.u8string();
+  const std::vector<std::string_view> arguments{argument};
+
+  fx::argparse::stream::TokenStream stream(arguments);
+  const auto actual = stream.next();
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(fmt::format("Unable to read arguments from {0}: Is a directory.",
+                        root.u8string()),
+            actual.error());
+}
+
+TEST_F(TokenStream, EscapedAt) {
+  const auto path = write_file("args", "x\n");
+
+  EXPECT_EQ((std::vector<std::string>{"@" + path, "@@b", "@"}),
+            read_all({"@@" + path, "@@@b", "@"}, ""));
+}
+
+TEST_F(TokenStream, ResponseFileTokensAreLiteral) {
+  const auto inner = write_file("inner", "x\n");
+  const auto outer = write_file("outer", "@" + inner + "\n--args-from-stdin\n");
+
+  EXPECT_EQ((std::vector<std::string>{"@" + inner, "--args-from-stdin"}),
+            read_all({"@" + outer}, "ignored\n"));
+}
+
+TEST_F(TokenStream, ArgsFromStdin) {
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c", "d"}),
+            read_all({"a", "--args-from-stdin", "d"}, "b\nc"));
+}
+
+TEST_F(TokenStream, ArgsFromStdinOnlyOnce) {
+  EXPECT_EQ((std::vector<std::string>{"b"}),
+            read_all({"--args-from-stdin", "--args-from-stdin"}, "b\n"));
+}
+
+TEST_F(TokenStream, ArgsFromStdinAcrossReads) {
+  // Large enough to span several reads, so tokens are split between them.
+  std::string contents;
+  std::vector<std::string> expected;
+  for (int index = 0; index < 50000; index++) {
+    expected.emplace_back(fmt::format("src/path/to/file-{0}.cpp", index));
+    contents += expected.back();
+    contents.push_back('\0');
+  }
+
+  EXPECT_EQ(expected, read_all({"--args-from-stdin"}, contents));
+}
+
+// Parse -----------------------------------------------------------------------
+
+TEST_F(TokenStream, ParseListFromResponseFile) {
+  const auto path = write_file("args", "--ids=1,2\n--ids\n3\nx.cpp\ny.cpp\n");
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "ids", "int_value": {"list": true}}
+      ],
+      "arguments": [
+        {"name": "files", "string_value": {"list": true}}
+      ]
+    }
+  )"_json);
+
+  const auto result = fx::argparse::parse({"@" + path}, descriptor);
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ(R"({
+    "ids": {"user_set": true, "value": [1, 2, 3]},
+    "files": {"user_set": true, "value": ["x.cpp", "y.cpp"]},
+    "help": {"user_set": false,"value": false}
+  })"_json,
+            result.value());
+}
+
+TEST_F(TokenStream, ParseMissingValueAtEndOfResponseFile) {
+  const auto path = write_file("args", "-i\n");
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {
+      "options": [
+        {"name": "ids", "short_name": "i", "int_value": {"list": true}}
+      ]
+    }
+  )"_json);
+
+  const auto result = fx::argparse::parse({"@" + path}, descriptor);
+  ASSERT_TRUE(result.failed());
+  EXPECT_EQ("[argparse] Expected argument following -i", result.error());
+}
@@ -0,0 +1,126 @@
+#include "fx/argparse/table/table.hpp"
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include "test/helper/helper.hpp"
+
+// FindOption ------------------------------------------------------------------
+
+TEST(FindOption, LongAndShortNames) {
+  const auto table = fx::argparse::table::compile(
+      fx::test::helper::command_descriptor(R"(
+        {
+          "options": [
+            {"name": "verbose", "short_name": "v", "bool_value": {}},
+            {"name": "jobs", "short_name": "j", "int_value": {}},
+            {"name": "language", "string_value": {}}
+          ]
+        }
+      )"_json));
+
+  EXPECT_EQ(0u, fx::argparse::table::find_option(table, "--verbose"));
+  EXPECT_EQ(0u, fx::argparse::table::find_option(table, "-v"));
+  EXPECT_EQ(1u, fx::argparse::table::find_option(table, "--jobs"));
+  EXPECT_EQ(1u, fx::argparse::table::find_option(table, "-j"));
+  EXPECT_EQ(2u, fx::argparse::table::find_option(table, "--language"));
+}
+
+TEST(FindOption, UnknownKey) {
+  const auto table = fx::argparse::table::compile(
+      fx::test::helper::command_descriptor(R"(
+        {
+          "options": [
+            {"name": "verbose", "short_name": "v", "bool_value": {}}
+          ]
+        }
+      )"_json));
+
+  EXPECT_FALSE(fx::argparse::table::find_option(table, "--v").has_value());
+  EXPECT_FALSE(fx::argparse::table::find_option(table, "-verbose").has_value());
+  EXPECT_FALSE(fx::argparse::table::find_option(table, "verbose").has_value());
+  EXPECT_FALSE(fx::argparse::table::find_option(table, "").has_value());
+}
+
+TEST(FindOption, NoOptions) {
+  const auto table = fx::argparse::table::compile(
+      fx::test::helper::command_descriptor(R"({})"_json));
+
+  EXPECT_FALSE(
+      fx::argparse::table::find_option(table, "--verbose").has_value());
+}
+
+TEST(FindOption, ManyOptions) {
+  auto json = R"({"options": []})"_json;
+  for (int index = 0; index < 1000; index++) {
+    json["options"].push_back({{"name", fmt::format("option-{0}", index)},
+                               {"short_name", fmt::format("o{0}", index)},
+                               {"bool_value", nlohmann::json::object()}});
+  }
+  const auto table = fx::argparse::table::compile(
+      fx::test::helper::command_descriptor(json));
+
+  ASSERT_EQ(2000, table.option_index().keys_size());
+  for (uint32_t index = 0; index < 1000; index++) {
+    EXPECT_EQ(index, fx::argparse::table::find_option(
+                         table, fmt::format("--option-{0}", index)));
+    EXPECT_EQ(index, fx::argparse::table::find_option(
+                         table, fmt::format("-o{0}", index)));
+  }
+  EXPECT_FALSE(
+      fx::argparse::table::find_option(table, "--option-1000").has_value());
+}
+
+TEST(FindOption, EmptyIndexScans) {
+  auto table = fx::argparse::table::compile(
+      fx::test::helper::command_descriptor(R"(
+        {
+          "options": [
+            {"name": "verbose", "short_name": "v", "bool_value": {}}
+          ]
+        }
+      )"_json));
+  table.clear_option_index();
+
+  EXPECT_EQ(0u, fx::argparse::table::find_option(table, "--verbose"));
+  EXPECT_EQ(0u, fx::argparse::table::find_option(table, "-v"));
+  EXPECT_FALSE(fx::argparse::table::find_option(table, "--v").has_value());
+}
+
+// IsStringChoice --------------------------------------------------------------
+
+TEST(IsStringChoice, SmallSetIsSearched) {
+  const auto table = fx::argparse::table::compile(
+      fx::test::helper::command_descriptor(R"(
+        {
+          "options": [
+            {"name": "language", "string_value": {"choices": ["go", "cpp"]}}
+          ]
+        }
+      )"_json));
+  const auto& spec = table.options(0);
+
+  EXPECT_TRUE(spec.string_choice_index().slots().empty());
+  EXPECT_TRUE(fx::argparse::table::is_string_choice(spec, "cpp"));
+  EXPECT_TRUE(fx::argparse::table::is_string_choice(spec, "go"));
+  EXPECT_FALSE(fx::argparse::table::is_string_choice(spec, "java"));
+}
+
+TEST(IsStringChoice, LargeSetIsHashed) {
+  auto json = R"({"options": [{"name": "service", "string_value": {}}]})"_json;
+  for (int index = 0; index < 5000; index++) {
+    json["options"][0]["string_value"]["choices"].push_back(
+        fmt::format("service-{0}", index));
+  }
+  const auto table = fx::argparse::table::compile(
+      fx::test::helper::command_descriptor(json));
+  const auto& spec = table.options(0);
+
+  ASSERT_EQ(5000, spec.string_choice_index().slots_size());
+  for (int index = 0; index < 5000; index++) {
+    EXPECT_TRUE(fx::argparse::table::is_string_choice(
+        spec, fmt::format("service-{0}", index)));
+  }
+  EXPECT_FALSE(fx::argparse::table::is_string_choice(spec, "service-5000"));
+  EXPECT_FALSE(fx::argparse::table::is_string_choice(spec, ""));
+}
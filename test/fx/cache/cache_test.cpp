@@ -0,0 +1,213 @@
+#include "fx/cache/cache.hpp"
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "fx/argparse/table/table.hpp"
+#include "fx/result/result.hpp"
+#include "fx/suggest/suggest.hpp"
+
+// LoadCommand -----------------------------------------------------------------
+
+struct LoadCommand : testing::Test {
+  std::filesystem::path root;
+  std::filesystem::path cache_directory;
+  std::filesystem::path descriptor_path;
+
+  void SetUp() override {
+    root = std::filesystem::temp_directory_path() /
+           ("fx_cache_test_" + std::to_string(getpid()));
+    cache_directory = root / "cache";
+    descriptor_path = root / "hello" / "command.fx.yaml";
+    std::filesystem::create_directories(descriptor_path.parent_path());
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(root);
+  }
+
+  void write_descriptor(const std::string& run,
+                        const std::string& extra = "") {
+    std::ofstream(descriptor_path, std::ios::trunc)
+        << "descriptor_version: v1beta\nsynopsis: test\nruntime:\n  run: "
+        << run << "\n"
+        << extra;
+  }
+};
+
+TEST_F(LoadCommand, StoresEntryOnMiss) {
+  write_descriptor("echo",
+                   "options:\n  - name: verbose\n    description: test\n"
+                   "    bool_value: {}\n");
+
+  const auto result = fx::cache::load_command(descriptor_path, cache_directory);
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ("echo", result.value().command_descriptor().runtime().run());
+  ASSERT_EQ(1, result.value().parse_table().options_size());
+  EXPECT_TRUE(fx::argparse::table::find_option(result.value().parse_table(),
+                                               "--verbose")
+                  .has_value());
+  EXPECT_TRUE(std::filesystem::exists(
+      fx::cache::command_entry_path(cache_directory, descriptor_path)));
+}
+
+TEST_F(LoadCommand, UsesStoredEntry) {
+  write_descriptor("echo");
+  ASSERT_TRUE(fx::cache::load_command(descriptor_path, cache_directory).ok());
+
+  // Corrupt the stored entry's descriptor; a hit must return it untouched.
+  const auto entry_path =
+      fx::cache::command_entry_path(cache_directory, descriptor_path);
+  fx::cache::v1beta::CommandCacheEntry entry;
+  {
+    std::ifstream input(entry_path, std::ios::binary);
+    ASSERT_TRUE(entry.ParseFromIstream(&input));
+  }
+  entry.mutable_command_descriptor()->mutable_runtime()->set_run("cached");
+  {
+    std::ofstream output(entry_path, std::ios::binary | std::ios::trunc);
+    ASSERT_TRUE(entry.SerializeToOstream(&output));
+  }
+
+  const auto result = fx::cache::load_command(descriptor_path, cache_directory);
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ("cached", result.value().command_descriptor().runtime().run());
+}
+
+TEST_F(LoadCommand, ReparsesStaleEntry) {
+  write_descriptor("echo");
+  ASSERT_TRUE(fx::cache::load_command(descriptor_path, cache_directory).ok());
+
+  write_descriptor("printf");
+  const auto mtime = std::filesystem::last_write_time(descriptor_path);
+  std::filesystem::last_write_time(descriptor_path,
+                                   mtime + std::chrono::hours(1));
+
+  const auto result = fx::cache::load_command(descriptor_path, cache_directory);
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ("printf", result.value().command_descriptor().runtime().run());
+}
+
+TEST_F(LoadCommand, ReparsesEntryOfOtherSchema) {
+  write_descriptor("echo");
+  ASSERT_TRUE(fx::cache::load_command(descriptor_path, cache_directory).ok());
+
+  const auto entry_path =
+      fx::cache::command_entry_path(cache_directory, descriptor_path);
+  fx::cache::v1beta::CommandCacheEntry entry;
+  {
+    std::ifstream input(entry_path, std::ios::binary);
+    ASSERT_TRUE(entry.ParseFromIstream(&input));
+  }
+  EXPECT_NE(0u, entry.schema_version());
+  entry.set_schema_version(0);
+  entry.mutable_command_descriptor()->mutable_runtime()->set_run("cached");
+  {
+    std::ofstream output(entry_path, std::ios::binary | std::ios::trunc);
+    ASSERT_TRUE(entry.SerializeToOstream(&output));
+  }
+
+  const auto result = fx::cache::load_command(descriptor_path, cache_directory);
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ("echo", result.value().command_descriptor().runtime().run());
+}
+
+TEST_F(LoadCommand, InvalidDescriptor) {
+  write_descriptor("[");
+
+  const auto result = fx::cache::load_command(descriptor_path, cache_directory);
+  ASSERT_TRUE(result.failed());
+  EXPECT_FALSE(std::filesystem::exists(
+      fx::cache::command_entry_path(cache_directory, descriptor_path)));
+}
+
+TEST_F(LoadCommand, UnwritableCacheDirectory) {
+  write_descriptor("echo");
+  std::ofstream(root / "file") << "not a directory";
+
+  const auto result =
+      fx::cache::load_command(descriptor_path, root / "file" / "cache");
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ("echo", result.value().command_descriptor().runtime().run());
+}
+
+TEST_F(LoadCommand, StoresHelpPages) {
+  write_descriptor("echo");
+  int renders = 0;
+  const auto load = [&](const std::string& command_name, uint32_t width) {
+    return fx::cache::load_help_page(descriptor_path, cache_directory,
+                                     command_name, width, [&] {
+                                       return fmt::format("page {0}",
+                                                          ++renders);
+                                     });
+  };
+
+  EXPECT_EQ("page 1", load("hello", 80));
+  EXPECT_EQ("page 1", load("hello", 80));
+  EXPECT_EQ("page 2", load("hello", 100));
+  EXPECT_EQ("page 3", load("other", 80));
+
+  // Changing the descriptor drops its pages.
+  write_descriptor("printf");
+  const auto mtime = std::filesystem::last_write_time(descriptor_path);
+  std::filesystem::last_write_time(descriptor_path,
+                                   mtime + std::chrono::hours(1));
+  EXPECT_EQ("page 4", load("hello", 80));
+}
+
+// LoadWorkspace ---------------------------------------------------------------
+
+using LoadWorkspace = LoadCommand;
+
+TEST_F(LoadWorkspace, StoresEntryOnMiss) {
+  const auto workspace_path = root / "workspace.fx.yaml";
+  std::ofstream(workspace_path)
+      << "descriptor_version: v1beta\nshell: /bin/bash\n";
+
+  const auto result = fx::cache::load_workspace(workspace_path, cache_directory);
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ("/bin/bash", result.value().workspace_descriptor().shell());
+  EXPECT_TRUE(std::filesystem::exists(
+      fx::cache::workspace_entry_path(cache_directory, workspace_path)));
+}
+
+// CommandIndex ----------------------------------------------------------------
+
+using CommandIndex = LoadCommand;
+
+TEST_F(CommandIndex, RoundTrip) {
+  const auto workspace_path = root / "workspace.fx.yaml";
+  EXPECT_FALSE(
+      fx::cache::load_command_index(workspace_path, cache_directory)
+          .has_value());
+
+  fx::cache::store_command_index(workspace_path, cache_directory,
+                                 {"hello", "world"});
+
+  const auto index =
+      fx::cache::load_command_index(workspace_path, cache_directory);
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(std::vector<std::string>{"hello"},
+            fx::suggest::suggest(index->trie(), "helo"));
+}
+
+TEST_F(CommandIndex, IgnoresOtherWorkspace) {
+  const auto index_path =
+      fx::cache::command_index_path(cache_directory, root / "a.fx.yaml");
+  fx::cache::store_command_index(root / "a.fx.yaml", cache_directory,
+                                 {"hello"});
+
+  // Simulate a hash collision by moving the entry to the other workspace.
+  const auto other_path =
+      fx::cache::command_index_path(cache_directory, root / "b.fx.yaml");
+  std::filesystem::create_directories(other_path.parent_path());
+  std::filesystem::rename(index_path, other_path);
+
+  EXPECT_FALSE(
+      fx::cache::load_command_index(root / "b.fx.yaml", cache_directory)
+          .has_value());
+}
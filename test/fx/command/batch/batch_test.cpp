@@ -0,0 +1,128 @@
+#include "fx/command/batch/batch.hpp"
+#include <gtest/gtest.h>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include "test/helper/workspace/workspace.hpp"
+
+// SplitInvocation -------------------------------------------------------------
+
+TEST(SplitInvocation, Words) {
+  const auto actual =
+      fx::command::split_invocation("  format  -l\tbazel  src/main.cpp ");
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  const std::vector<std::string> expected{"format", "-l", "bazel",
+                                          "src/main.cpp"};
+  EXPECT_EQ(expected, actual.value());
+}
+
+TEST(SplitInvocation, Quotes) {
+  const auto actual = fx::command::split_invocation(
+      R"(test 'a b' "c \"d\" \n" e\ f '' g"h"'i')");
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  const std::vector<std::string> expected{"test", "a b", "c \"d\" \\n",
+                                          "e f",  "",    "ghi"};
+  EXPECT_EQ(expected, actual.value());
+}
+
+TEST(SplitInvocation, Unterminated) {
+  for (const auto& invocation : {"test 'a", "test \"a", "test a\\"}) {
+    EXPECT_TRUE(fx::command::split_invocation(invocation).failed())
+        << invocation;
+  }
+}
+
+// Batch -----------------------------------------------------------------------
+
+struct Batch : fx::test::helper::Workspace {
+  Batch() : Workspace("shell: /bin/sh\n") {}
+
+  void SetUp() override {
+    Workspace::SetUp();
+    const std::string options =
+        "  - name: label\n"
+        "    description: test\n"
+        "    string_value: {}\n";
+    command("echo", "sh -c 'echo \\\"$0\\\"'", options);
+    command("fail", "sh -c 'exit 3'", options);
+    command("read", "sh -c 'cat \\\"$FX_ARGUMENTS_FILE\\\"'", options);
+  }
+
+  // Results by index.
+  static std::map<int, nlohmann::json> results(const std::string& output) {
+    std::map<int, nlohmann::json> results;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+      const auto result = nlohmann::json::parse(line);
+      results[result["index"].get<int>()] = result;
+    }
+    return results;
+  }
+};
+
+TEST_F(Batch, UnknownOption) {
+  std::istringstream input("");
+  const auto actual = fx::command::Batch(input).run({"--fast"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Unknown option \"--fast\".", actual.error());
+}
+
+TEST_F(Batch, ReportsEveryInvocation) {
+  std::istringstream input(
+      "echo\n"
+      "\n"
+      "fail\n"
+      "missing\n"
+      "echo --unknown\n");
+
+  testing::internal::CaptureStdout();
+  const auto actual = fx::command::Batch(input).run({"-j", "2"});
+  const auto output = testing::internal::GetCapturedStdout();
+
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("3 of 4 invocations failed.", actual.error());
+
+  const auto parsed = results(output);
+  ASSERT_EQ(4u, parsed.size());
+  EXPECT_EQ(0, parsed.at(0)["exit_code"]);
+  EXPECT_EQ(R"(["echo"])"_json, parsed.at(0)["invocation"]);
+  EXPECT_NE(std::string::npos,
+            parsed.at(0)["output"].get<std::string>().find("\"help\""));
+  EXPECT_TRUE(parsed.at(0)["wall_seconds"].is_number());
+  EXPECT_EQ(3, parsed.at(1)["exit_code"]);
+  EXPECT_EQ("Unknown command \"missing\".", parsed.at(2)["error"]);
+  EXPECT_TRUE(parsed.at(3).contains("error"));
+}
+
+TEST_F(Batch, NullDelimited) {
+  std::istringstream input(std::string("echo --label\n'a b'\0echo\0", 24));
+
+  testing::internal::CaptureStdout();
+  const auto actual = fx::command::Batch(input).run({"--null"});
+  const auto output = testing::internal::GetCapturedStdout();
+
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  const auto parsed = results(output);
+  ASSERT_EQ(2u, parsed.size());
+  EXPECT_EQ(R"(["echo", "--label", "a b"])"_json,
+            parsed.at(0)["invocation"]);
+}
+
+TEST_F(Batch, PassesLongArgumentsInFile) {
+  // More than the 128 KiB one argument can take on Linux.
+  const std::string label(256 * 1024, 'x');
+  std::istringstream input("read --label " + label + "\n");
+
+  testing::internal::CaptureStdout();
+  const auto actual = fx::command::Batch(input).run({});
+  const auto output = testing::internal::GetCapturedStdout();
+
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  const auto parsed = results(output);
+  ASSERT_EQ(1u, parsed.size());
+  EXPECT_EQ(0, parsed.at(0)["exit_code"]);
+  const auto arguments =
+      nlohmann::json::parse(parsed.at(0)["output"].get<std::string>());
+  EXPECT_EQ(label, arguments["label"]["value"]);
+}
@@ -0,0 +1,42 @@
+#include "fx/command/forwarder/counters/counters.hpp"
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Counters --------------------------------------------------------------------
+
+TEST(Counters, AvailableOrExplained) {
+  fx::command::forwarder::counters::Counters counters;
+  EXPECT_NE(counters.available(), !counters.error().empty());
+}
+
+TEST(Counters, CountsChildren) {
+  fx::command::forwarder::counters::Counters counters;
+  if (!counters.available()) {
+    GTEST_SKIP() << counters.error();
+  }
+
+  counters.start();
+  const pid_t pid = fork();
+  if (pid == 0) {
+    volatile uint64_t sum = 0;
+    for (uint64_t index = 0; index < 10000000; index++) {
+      sum += index;
+    }
+    _exit(0);
+  }
+  waitpid(pid, nullptr, 0);
+  counters.stop();
+
+  const auto sample = counters.read();
+  EXPECT_GT(sample.instructions, 10000000u);
+  EXPECT_GT(sample.cycles, 0u);
+  EXPECT_GT(sample.instructions_per_cycle(), 0);
+}
+
+TEST(Counters, UnavailableReadsZero) {
+  const fx::command::forwarder::counters::sample_t sample;
+  EXPECT_EQ(0, sample.instructions_per_cycle());
+  EXPECT_EQ(0, sample.branch_miss_rate());
+  EXPECT_EQ(0, sample.cache_miss_rate());
+}
@@ -0,0 +1,179 @@
+#include "fx/command/forwarder/exec/exec.hpp"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "test/helper/allocations/allocations.hpp"
+
+// CStringArray ----------------------------------------------------------------
+
+TEST(CStringArray, Empty) {
+  const fx::command::forwarder::exec::CStringArray array;
+  EXPECT_EQ(0u, array.size());
+  EXPECT_EQ(nullptr, array.data()[0]);
+}
+
+TEST(CStringArray, PushBack) {
+  fx::command::forwarder::exec::CStringArray array;
+  array.push_back("/bin/sh");
+  array.push_back("");
+  array.push_back(std::string(10000, 'x'));
+
+  ASSERT_EQ(3u, array.size());
+  EXPECT_STREQ("/bin/sh", array.data()[0]);
+  EXPECT_STREQ("", array.data()[1]);
+  EXPECT_EQ(std::string(10000, 'x'), array.data()[2]);
+  EXPECT_EQ(nullptr, array.data()[3]);
+}
+
+TEST(CStringArray, PackAllocatesOnce) {
+  const std::vector<std::string> small{"a"};
+  std::vector<std::string> large;
+  for (int index = 0; index < 10000; index++) {
+    large.emplace_back("FX_TEST_VARIABLE_" + std::to_string(index) + "=value");
+  }
+
+  const auto small_start = fx::test::helper::allocations();
+  const auto small_array = fx::command::forwarder::exec::pack(small);
+  const auto small_allocations =
+      fx::test::helper::allocations() - small_start;
+
+  const auto large_start = fx::test::helper::allocations();
+  const auto large_array = fx::command::forwarder::exec::pack(large);
+  const auto large_allocations =
+      fx::test::helper::allocations() - large_start;
+
+  // The strings share one block, whatever their number.
+  EXPECT_EQ(small_allocations, large_allocations);
+  ASSERT_EQ(large.size(), large_array.size());
+  for (size_t index = 0; index < large.size(); index++) {
+    EXPECT_EQ(large[index], large_array.data()[index]);
+  }
+  EXPECT_EQ(nullptr, large_array.data()[large.size()]);
+}
+
+// Environment -----------------------------------------------------------------
+
+TEST(Environment, BorrowsInheritedEntries) {
+  char path[] = "PATH=/bin";
+  char home[] = "HOME=/home/fx";
+  char* const inherited[] = {path, home, nullptr};
+
+  const auto array = fx::command::forwarder::exec::environment(
+      inherited, fx::descriptor::v1beta::EnvironmentDescriptor(),
+      {"FX_WORKSPACE_DIRECTORY=/ws"});
+
+  ASSERT_EQ(3u, array.size());
+  EXPECT_STREQ("FX_WORKSPACE_DIRECTORY=/ws", array.data()[0]);
+  EXPECT_EQ(path, array.data()[1]);
+  EXPECT_EQ(home, array.data()[2]);
+  EXPECT_EQ(nullptr, array.data()[3]);
+}
+
+TEST(Environment, OverridesInheritedEntries) {
+  char workspace[] = "FX_WORKSPACE_DIRECTORY=/stale";
+  char workspace_prefix[] = "FX_WORKSPACE_DIRECTORY_OTHER=1";
+  char* const inherited[] = {workspace, workspace_prefix, nullptr};
+
+  const auto array = fx::command::forwarder::exec::environment(
+      inherited, fx::descriptor::v1beta::EnvironmentDescriptor(),
+      {"FX_WORKSPACE_DIRECTORY=/ws"});
+
+  ASSERT_EQ(2u, array.size());
+  EXPECT_STREQ("FX_WORKSPACE_DIRECTORY=/ws", array.data()[0]);
+  EXPECT_EQ(workspace_prefix, array.data()[1]);
+}
+
+TEST(Environment, AllowAndDeny) {
+  char path[] = "PATH=/bin";
+  char home[] = "HOME=/home/fx";
+  char lang[] = "LC_ALL=C";
+  char time[] = "LC_TIME=C";
+  char secret[] = "AWS_SECRET_ACCESS_KEY=hunter2";
+  char* const inherited[] = {path, home, lang, time, secret, nullptr};
+
+  fx::descriptor::v1beta::EnvironmentDescriptor descriptor;
+  descriptor.add_allow("PATH");
+  descriptor.add_allow("LC_*");
+  descriptor.add_allow("AWS_*");
+  descriptor.add_deny("LC_TIME");
+  descriptor.add_deny("AWS_SECRET_*");
+
+  const auto array =
+      fx::command::forwarder::exec::environment(inherited, descriptor, {});
+
+  ASSERT_EQ(2u, array.size());
+  EXPECT_EQ(path, array.data()[0]);
+  EXPECT_EQ(lang, array.data()[1]);
+}
+
+TEST(Environment, DenyAll) {
+  char path[] = "PATH=/bin";
+  char* const inherited[] = {path, nullptr};
+
+  fx::descriptor::v1beta::EnvironmentDescriptor descriptor;
+  descriptor.add_deny("*");
+
+  const auto array = fx::command::forwarder::exec::environment(
+      inherited, descriptor, {"FX_WORKSPACE_DIRECTORY=/ws"});
+
+  ASSERT_EQ(1u, array.size());
+  EXPECT_STREQ("FX_WORKSPACE_DIRECTORY=/ws", array.data()[0]);
+}
+
+// CheckLimits -----------------------------------------------------------------
+
+TEST(CheckLimits, AcceptsOrdinaryCommandLines) {
+  const auto argv = fx::command::forwarder::exec::pack(
+      {"/bin/sh", "-l", "-c", "echo '" + std::string(64 * 1024, 'x') + "'"});
+  const auto envp = fx::command::forwarder::exec::pack({"HOME=/root"});
+
+  const auto actual = fx::command::forwarder::exec::check_limits(argv, envp);
+  EXPECT_TRUE(actual.ok()) << actual.error();
+}
+
+TEST(CheckLimits, RejectsOversizedCommandLines) {
+  const auto envp = fx::command::forwarder::exec::pack({"HOME=/root"});
+  // Too long for one argument on Linux, and for ARG_MAX everywhere else.
+  const auto argv = fx::command::forwarder::exec::pack(
+      {"/bin/sh", "-l", "-c", std::string(16 * 1024 * 1024, 'x')});
+
+  const auto actual = fx::command::forwarder::exec::check_limits(argv, envp);
+  ASSERT_TRUE(actual.failed());
+#ifdef __linux__
+  EXPECT_EQ(0u, actual.error().find("An argument of 16384 KiB exceeds the "
+                                    "system limit of 128 KiB."));
+#endif
+}
+
+#ifdef __linux__
+TEST(CheckLimits, RejectsOversizedEnvironmentVariables) {
+  const auto argv = fx::command::forwarder::exec::pack({"/bin/sh"});
+  const auto envp = fx::command::forwarder::exec::pack(
+      {"HOME=/root", "FX_TEST_HUGE=" + std::string(256 * 1024, 'x')});
+
+  const auto actual = fx::command::forwarder::exec::check_limits(argv, envp);
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("The environment variable FX_TEST_HUGE of 256 KiB exceeds the "
+            "system limit of 128 KiB.",
+            actual.error());
+}
+
+TEST(FitsInArgument, MaxArgStrlen) {
+  EXPECT_TRUE(fx::command::forwarder::exec::fits_in_argument(128 * 1024 - 1));
+  EXPECT_FALSE(fx::command::forwarder::exec::fits_in_argument(128 * 1024));
+}
+#endif
+
+// InheritedFile ---------------------------------------------------------------
+
+TEST(InheritedFile, ReadsBackContents) {
+  const std::string contents(200 * 1024, 'x');
+
+  const auto actual = fx::command::forwarder::exec::inherited_file(contents);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(0u, actual.value().u8string().find("/dev/fd/"));
+  std::ifstream file(actual.value());
+  EXPECT_EQ(contents, std::string(std::istreambuf_iterator<char>(file), {}));
+}
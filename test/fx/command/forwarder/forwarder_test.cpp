@@ -3,12 +3,16 @@
 #include <gmock/gmock.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include "fx/cache/cache.hpp"
 #include "fx/result/result.hpp"
 #include "test/helper/helper.hpp"
+#include "test/helper/workspace/workspace.hpp"
 
 class TestForwarder : public fx::command::Forwarder {
  public:
@@ -23,7 +27,7 @@ class TestForwarder : public fx::command::Forwarder {
               (override));
   MOCK_METHOD(fx::result::Result<void>, execute_command,
               (const std::vector<std::string>& arguments,
-               const std::vector<std::string>& envvars),
+               const fx::command::forwarder::exec::CStringArray& envvars),
               (override));
 };
 
@@ -104,6 +108,90 @@ TEST(Run, ExecuteCommand) {
   ASSERT_TRUE(actual.ok());
 }
 
+TEST(Run, UnknownFxOption) {
+  const auto forwarder = std::make_unique<TestForwarder>("test");
+
+  const auto actual = forwarder->run({"--fx-fake", "--flag"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Unknown fx option \"--fx-fake\".", actual.error());
+}
+
+TEST(Run, ConsumesFxOptions) {
+  const auto forwarder =
+      std::make_unique<TestForwarder>("example/FoundValidCommandDescriptor");
+  EXPECT_CALL(*forwarder, find_workspace_descriptor_path())
+      .Times(1)
+      .WillRepeatedly(testing::Return(fx::result::Ok(
+          std::filesystem::current_path() /
+          std::filesystem::path(
+              "test/fx/command/forwarder/__data__/workpace.fx.yaml"))));
+  EXPECT_CALL(*forwarder, execute_command(testing::_, testing::_))
+      .Times(1)
+      .WillRepeatedly(testing::Return(fx::result::Ok()));
+
+  const auto actual =
+      forwarder->run({"--fx-profile", "--fx-profile=profile.json"});
+  ASSERT_TRUE(actual.ok()) << actual.error();
+}
+
+TEST(Run, InvalidShard) {
+  const auto forwarder = std::make_unique<TestForwarder>("test");
+
+  const auto actual = forwarder->run({"--fx-shard=3/2"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(
+      "Invalid shard \"3/2\", expected <index>/<count> with 1 <= index <= "
+      "count <= 65536.",
+      actual.error());
+}
+
+TEST(Run, ShardWithoutListArgument) {
+  const auto forwarder =
+      std::make_unique<TestForwarder>("example/FoundValidCommandDescriptor");
+  EXPECT_CALL(*forwarder, find_workspace_descriptor_path())
+      .Times(1)
+      .WillRepeatedly(testing::Return(fx::result::Ok(
+          std::filesystem::current_path() /
+          std::filesystem::path(
+              "test/fx/command/forwarder/__data__/workpace.fx.yaml"))));
+
+  const auto actual = forwarder->run({"--fx-shard=1/2"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("--fx-shard requires the command to have a list argument.",
+            actual.error());
+}
+
+TEST(Run, WorkspacePinnedShell) {
+  class PinnedForwarder : public fx::command::Forwarder {
+   public:
+    PinnedForwarder() : fx::command::Forwarder("hello") {}
+
+    MOCK_METHOD(fx::result::Result<std::filesystem::path>,
+                find_workspace_descriptor_path, (), (override));
+    MOCK_METHOD(fx::result::Result<void>, execute_command,
+                (const std::vector<std::string>& arguments,
+                 const fx::command::forwarder::exec::CStringArray& envvars),
+                (override));
+  };
+
+  const auto forwarder = std::make_unique<PinnedForwarder>();
+  EXPECT_CALL(*forwarder, find_workspace_descriptor_path())
+      .Times(1)
+      .WillRepeatedly(testing::Return(fx::result::Ok(
+          std::filesystem::current_path() /
+          std::filesystem::path(
+              "test/fx/command/forwarder/__data__/pinned/workspace.fx.yaml"))));
+  EXPECT_CALL(*forwarder,
+              execute_command(testing::ElementsAre("/bin/pinned-sh", "-l", "-c",
+                                                   testing::_),
+                              testing::_))
+      .Times(1)
+      .WillRepeatedly(testing::Return(fx::result::Ok()));
+
+  const auto actual = forwarder->run({});
+  ASSERT_TRUE(actual.ok()) << actual.error();
+}
+
 // ParseCommandDescriptor ------------------------------------------------------
 
 TEST(ParseCommandDescriptor, FoundValidCommandDescriptor) {
@@ -162,6 +250,192 @@ TEST(ParseCommandDescriptor, CommandDescriptorNotFound) {
             actual.error());
 }
 
+TEST(ParseCommandDescriptor, SuggestsSimilarCommand) {
+  auto workspace_path =
+      std::filesystem::current_path() /
+      std::filesystem::path(
+          "test/fx/command/forwarder/__data__/workpace.fx.yaml");
+
+  const auto forwarder = std::make_unique<fx::command::Forwarder>(
+      "example/FoundValidComandDescriptor");
+  const auto actual = forwarder->parse_command_descriptor(workspace_path);
+
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(
+      "Unknown command \"example/FoundValidComandDescriptor\". Did you mean "
+      "\"example/FoundValidCommandDescriptor\"?",
+      actual.error());
+}
+
+// RunSharded ------------------------------------------------------------------
+
+struct RunSharded : fx::test::helper::Workspace {
+  std::unique_ptr<TestForwarder> forwarder;
+  // The invocation and FX_SHARD_TIMINGS_FILE the command was executed with.
+  std::string invocation;
+  std::string timings_file;
+
+  void SetUp() override {
+    Workspace::SetUp();
+    std::filesystem::create_directories(root / "test");
+    std::ofstream(root / "test" / "command.fx.yaml")
+        << "descriptor_version: v1beta\n"
+        << "synopsis: test\n"
+        << "arguments:\n"
+        << "  - name: targets\n"
+        << "    description: test\n"
+        << "    string_value:\n"
+        << "      list: true\n"
+        << "runtime:\n"
+        << "  run: echo\n";
+
+    forwarder = std::make_unique<TestForwarder>("test");
+    ON_CALL(*forwarder, find_workspace_descriptor_path())
+        .WillByDefault(testing::Return(
+            fx::result::Ok(root / "workspace.fx.yaml")));
+    ON_CALL(*forwarder, shell()).WillByDefault(testing::Return("/bin/sh"));
+    ON_CALL(*forwarder, execute_command(testing::_, testing::_))
+        .WillByDefault(
+            [&](const std::vector<std::string>& arguments,
+                const fx::command::forwarder::exec::CStringArray& envvars) {
+              invocation = arguments.back();
+              const std::string_view name("FX_SHARD_TIMINGS_FILE=");
+              for (auto* variable = envvars.data(); *variable != nullptr;
+                   variable++) {
+                if (std::string_view(*variable).substr(0, name.size()) ==
+                    name) {
+                  timings_file = *variable + name.size();
+                }
+              }
+              return fx::result::Result<void>(fx::result::Ok());
+            });
+  }
+};
+
+TEST_F(RunSharded, CollectsTimingsInCache) {
+  const auto actual = forwarder->run({"--fx-shard=1/2", "a", "b"});
+  ASSERT_TRUE(actual.ok()) << actual.error();
+
+  const auto collected =
+      fx::command::forwarder::shard::collected_timings_path(
+          root / "cache", root / "workspace.fx.yaml", "test");
+  EXPECT_EQ(
+      fx::command::forwarder::shard::pending_timings_path(collected).u8string(),
+      timings_file);
+  EXPECT_TRUE(std::filesystem::is_directory(collected.parent_path()));
+  // Nothing is written to the workspace.
+  EXPECT_EQ(1, std::distance(std::filesystem::directory_iterator(root / "test"),
+                             std::filesystem::directory_iterator()));
+}
+
+TEST_F(RunSharded, ReadsCommittedTimings) {
+  std::ofstream(root / "test" / "shard-timings.tsv") << "a\t10\nb\t1\nc\t1\n";
+
+  ASSERT_TRUE(forwarder->run({"--fx-shard=1/2", "a", "b", "c"}).ok());
+  EXPECT_THAT(invocation, testing::HasSubstr("\"value\":[\"a\"]"));
+}
+
+TEST_F(RunSharded, ReadsGivenTimings) {
+  std::ofstream(root / "test" / "shard-timings.tsv") << "c\t10\n";
+  std::ofstream(root / "timings.tsv") << "a\t10\nb\t1\nc\t1\n";
+
+  ASSERT_TRUE(forwarder
+                  ->run({"--fx-shard=1/2", "--fx-shard-timings=timings.tsv",
+                         "a", "b", "c"})
+                  .ok());
+  EXPECT_THAT(invocation, testing::HasSubstr("\"value\":[\"a\"]"));
+}
+
+TEST_F(RunSharded, MissingGivenTimings) {
+  const auto actual = forwarder->run(
+      {"--fx-shard=1/2", "--fx-shard-timings=missing.tsv", "a", "b"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Unable to read shard timings missing.tsv.", actual.error());
+}
+
+TEST_F(RunSharded, TimingsWithoutShard) {
+  const auto actual = forwarder->run({"--fx-shard-timings=timings.tsv", "a"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("--fx-shard-timings requires --fx-shard.", actual.error());
+}
+
+// UnknownCommand --------------------------------------------------------------
+
+struct UnknownCommand : fx::test::helper::Workspace {
+  std::string error(const std::string& command_name) const {
+    fx::command::Forwarder forwarder(command_name);
+    const auto actual =
+        forwarder.parse_command_descriptor(root / "workspace.fx.yaml");
+    return actual.failed() ? actual.error() : std::string();
+  }
+};
+
+TEST_F(UnknownCommand, RebuildsStaleIndex) {
+  fx::cache::store_command_index(root / "workspace.fx.yaml",
+                                 fx::cache::directory(), {"build"});
+  command("deploy", "echo");
+
+  EXPECT_EQ("Unknown command \"deplyo\". Did you mean \"deploy\"?",
+            error("deplyo"));
+  EXPECT_EQ("Unknown command \"biuld\".", error("biuld"));
+}
+
+TEST_F(UnknownCommand, SkipsRemovedCommands) {
+  fx::cache::store_command_index(root / "workspace.fx.yaml",
+                                 fx::cache::directory(), {"deploy"});
+
+  EXPECT_EQ("Unknown command \"deplyo\".", error("deplyo"));
+}
+
+// ExecutePlugin ---------------------------------------------------------------
+
+struct ExecutePlugin : fx::test::helper::Workspace {
+  const std::filesystem::path plugin =
+      std::filesystem::current_path() /
+      "test/fx/command/forwarder/libtest_plugin.so";
+
+  void SetUp() override {
+    Workspace::SetUp();
+    if (!std::filesystem::exists(plugin)) {
+      GTEST_SKIP() << "test plugin not built";
+    }
+    std::filesystem::create_directories(root / "hello");
+    std::ofstream(root / "hello" / "command.fx.yaml")
+        << "descriptor_version: v1beta\n"
+        << "synopsis: test\n"
+        << "runtime:\n"
+        << "  plugin: " << plugin.u8string() << "\n"
+        << "  environment:\n"
+        << "    deny: [FX_TEST_DENIED]\n";
+  }
+};
+
+TEST_F(ExecutePlugin, AppliesCommandEnvironment) {
+  setenv("FX_TEST_DENIED", "1", 1);
+  fx::command::Forwarder forwarder("hello");
+
+  testing::internal::CaptureStdout();
+  const auto actual = forwarder.run({});
+  const auto output = testing::internal::GetCapturedStdout();
+
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(fmt::format("hello {0}\nFX_WORKSPACE_DIRECTORY={0}\n",
+                        root.u8string()),
+            output);
+  EXPECT_STREQ("1", std::getenv("FX_TEST_DENIED"));
+  unsetenv("FX_TEST_DENIED");
+}
+
+TEST_F(ExecutePlugin, RejectsProfile) {
+  fx::command::Forwarder forwarder("hello");
+
+  const auto actual = forwarder.run({"--fx-profile"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(
+      "--fx-profile is not supported for \"hello\", which runs as a plugin.",
+      actual.error());
+}
+
 // ParseCommandArguments -------------------------------------------------------
 
 TEST(ParseCommandArguments, ReturnsJson) {
@@ -170,7 +444,7 @@ TEST(ParseCommandArguments, ReturnsJson) {
       {"name": "bool-test", "description": "test", "bool_value": {}}
     ]
   })"_json);
-  const std::vector<std::string> arguments{"--bool-test"};
+  const std::vector<std::string_view> arguments{"--bool-test"};
   const auto expected = R"({
     "bool-test": {"user_set": true, "value": true},
     "help": {"user_set": false,"value": false}
@@ -188,7 +462,7 @@ TEST(ParseCommandArguments, ReturnsError) {
       {"name": "bool-test", "description": "test", "bool_value": {}}
     ]
   })"_json);
-  const std::vector<std::string> arguments{"--fake-flag"};
+  const std::vector<std::string_view> arguments{"--fake-flag"};
 
   const auto forwarder = std::make_unique<fx::command::Forwarder>("test");
   const auto actual = forwarder->parse_command_arguments(descriptor, arguments);
@@ -228,7 +502,44 @@ TEST(CollateExecutionArguments, ReturnsExecutionCommands) {
   const auto actual =
       forwarder->collate_execution_arguments(descriptor, arguments);
 
-  EXPECT_EQ(expected, actual);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(expected, actual.value());
+}
+
+TEST(CollateExecutionArguments, PassesLongArgumentsInFile) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"({
+    "runtime": {"run": "python3 example.py"}
+  })"_json);
+  // More than MAX_ARG_STRLEN, and than a quarter of ARG_MAX elsewhere.
+  nlohmann::json arguments;
+  arguments["files"]["value"] = std::vector<std::string>(
+      16 * 1024, "src/path/to/a/file/in/the/workspace.cpp");
+  arguments["files"]["user_set"] = true;
+  const std::vector<std::string> expected{"/bin/tuna", "-l", "-c",
+                                          "python3 example.py"};
+
+  const auto forwarder = std::make_unique<TestForwarder>("test");
+  EXPECT_CALL(*forwarder, shell())
+      .Times(1)
+      .WillRepeatedly(testing::Return("/bin/tuna"));
+
+  const auto actual =
+      forwarder->collate_execution_arguments(descriptor, arguments);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(expected, actual.value());
+
+  const auto envvars = forwarder->collate_enviornment_variables(
+      descriptor, "test/path/workspace.yaml");
+  const std::string prefix = "FX_ARGUMENTS_FILE=";
+  const auto found =
+      std::find_if(envvars.data(), envvars.data() + envvars.size(),
+                   [&](const char* entry) {
+                     return std::string_view(entry).substr(
+                                0, prefix.size()) == prefix;
+                   });
+  ASSERT_NE(envvars.data() + envvars.size(), found);
+  std::ifstream file(std::string(*found).substr(prefix.size()));
+  EXPECT_EQ(arguments, nlohmann::json::parse(file));
 }
 
 // CollateEnviornmentVariables -------------------------------------------------
@@ -243,8 +554,35 @@ TEST(CollateEnviornmentVariables, ContainsWorkspaceAndExistingEnvvar) {
                                           "FX_TEST_EXAMPLE_TWO=YYZ"};
 
   const auto forwarder = std::make_unique<fx::command::Forwarder>("test");
-  const auto actual =
-      forwarder->collate_enviornment_variables(test_workspace_path);
+  const auto envvars = forwarder->collate_enviornment_variables(
+      fx::descriptor::v1beta::FxCommandDescriptor(), test_workspace_path);
+  const std::vector<std::string> actual{envvars.data(),
+                                        envvars.data() + envvars.size()};
 
   EXPECT_THAT(actual, testing::IsSupersetOf(expected));
 }
+
+TEST(CollateEnviornmentVariables, FiltersByDescriptor) {
+  const auto test_workspace_path =
+      std::filesystem::path("test/path/workspace.yaml");
+  setenv("FX_TEST_EXAMPLE_ONE", "416", 1);
+  setenv("FX_TEST_EXAMPLE_TWO", "YYZ", 1);
+  setenv("FX_WORKSPACE_DIRECTORY", "stale", 1);
+  const auto descriptor = fx::test::helper::command_descriptor(R"({
+    "runtime": {
+      "run": "test-run",
+      "environment": {"allow": ["FX_TEST_*"], "deny": ["FX_TEST_EXAMPLE_TWO"]}
+    }
+  })"_json);
+  const std::vector<std::string> expected{"FX_WORKSPACE_DIRECTORY=test/path",
+                                          "FX_TEST_EXAMPLE_ONE=416"};
+
+  const auto forwarder = std::make_unique<fx::command::Forwarder>("test");
+  const auto envvars =
+      forwarder->collate_enviornment_variables(descriptor, test_workspace_path);
+  const std::vector<std::string> actual{envvars.data(),
+                                        envvars.data() + envvars.size()};
+  unsetenv("FX_WORKSPACE_DIRECTORY");
+
+  EXPECT_THAT(actual, testing::UnorderedElementsAreArray(expected));
+}
@@ -0,0 +1,89 @@
+#include "fx/command/forwarder/help/help.hpp"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string>
+#include "test/helper/helper.hpp"
+
+// Wrap ------------------------------------------------------------------------
+
+TEST(Wrap, ReflowsWords) {
+  EXPECT_EQ("  aaa bbb\n  ccc",
+            fx::command::forwarder::help::wrap("aaa bbb ccc", 2, 10));
+  EXPECT_EQ("  aaa bbb\n  ccc",
+            fx::command::forwarder::help::wrap("aaa\n  bbb\tccc ", 2, 10));
+}
+
+TEST(Wrap, SeparatesParagraphs) {
+  EXPECT_EQ("a b\n\nc",
+            fx::command::forwarder::help::wrap("\na\nb\n \n\n\nc\n\n", 0, 80));
+}
+
+TEST(Wrap, KeepsLongWordsWhole) {
+  EXPECT_EQ(" a\n abcdefghij\n b",
+            fx::command::forwarder::help::wrap("a abcdefghij b", 1, 8));
+}
+
+TEST(Wrap, CountsCodePoints) {
+  EXPECT_EQ("· · ·", fx::command::forwarder::help::wrap("· · ·", 0, 5));
+}
+
+TEST(Wrap, Empty) {
+  EXPECT_EQ("", fx::command::forwarder::help::wrap("", 4, 80));
+  EXPECT_EQ("", fx::command::forwarder::help::wrap(" \n\n ", 4, 80));
+}
+
+// Width -----------------------------------------------------------------------
+
+TEST(Width, Columns) {
+  setenv("COLUMNS", "120", 1);
+  EXPECT_EQ(120u, fx::command::forwarder::help::width());
+
+  setenv("COLUMNS", "10", 1);
+  EXPECT_EQ(40u, fx::command::forwarder::help::width());
+  unsetenv("COLUMNS");
+}
+
+// Usage -----------------------------------------------------------------------
+
+TEST(Usage, OptionsAndArguments) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"({
+    "options": [
+      {"name": "verbose", "short_name": "v", "bool_value": {}},
+      {"name": "ids", "int_value": {"list": true, "required": true}}
+    ],
+    "arguments": [
+      {"name": "target", "string_value": {"required": true}},
+      {"name": "rest", "string_value": {"list": true}}
+    ]
+  })"_json);
+
+  EXPECT_EQ("fx test [-v|--verbose] --ids=<ids...> target [rest...]",
+            fx::command::forwarder::help::usage("test", descriptor));
+}
+
+// Render ----------------------------------------------------------------------
+
+TEST(Render, FollowsWidth) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"({
+    "synopsis": "test",
+    "description": "one two three four five six seven eight nine ten",
+    "options": [
+      {"name": "level", "description": "the level",
+       "int_value": {"default": 2, "choices": [1, 2, 3]}}
+    ]
+  })"_json);
+
+  const auto narrow =
+      fx::command::forwarder::help::render("test", descriptor, 40);
+  EXPECT_NE(std::string::npos,
+            narrow.find("\none two three four five six seven eight\nnine "
+                        "ten\n\n"));
+  EXPECT_NE(std::string::npos,
+            narrow.find("\n   --level · int · optional\n\n      the level\n\n"
+                        "      Default: 2 | Choices: 1, 2, 3\n\n"));
+
+  const auto wide =
+      fx::command::forwarder::help::render("test", descriptor, 100);
+  EXPECT_NE(std::string::npos,
+            wide.find("\none two three four five six seven eight nine ten\n"));
+}
@@ -0,0 +1,130 @@
+#include "fx/command/forwarder/plugin/plugin.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace {
+  fx::descriptor::v1beta::FxCommandDescriptor descriptor() {
+    fx::descriptor::v1beta::FxCommandDescriptor descriptor;
+    auto* verbose = descriptor.add_options();
+    verbose->set_name("verbose");
+    verbose->mutable_bool_value();
+    auto* level = descriptor.add_options();
+    level->set_name("level");
+    level->mutable_int_value();
+    auto* files = descriptor.add_arguments();
+    files->set_name("files");
+    files->mutable_string_value()->set_list(true);
+    return descriptor;
+  }
+
+  const nlohmann::json arguments = nlohmann::json::parse(R"({
+    "verbose": {"user_set": true, "value": true},
+    "level": {"user_set": false, "value": 2},
+    "files": {"user_set": true, "value": ["a", "b c"]}
+  })");
+
+  std::filesystem::path test_plugin() {
+    return std::filesystem::current_path() /
+           "test/fx/command/forwarder/libtest_plugin.so";
+  }
+}  // namespace
+
+// Arguments -------------------------------------------------------------------
+
+TEST(Arguments, ConvertsByDescriptorType) {
+  const fx::command::forwarder::plugin::Arguments actual(descriptor(),
+                                                         arguments);
+  ASSERT_EQ(3u, actual.size());
+
+  EXPECT_STREQ("verbose", actual.data()[0].name);
+  EXPECT_EQ(FX_PLUGIN_BOOL, actual.data()[0].type);
+  EXPECT_EQ(1, actual.data()[0].user_set);
+  ASSERT_EQ(1u, actual.data()[0].count);
+  EXPECT_EQ(1, actual.data()[0].ints[0]);
+
+  EXPECT_STREQ("level", actual.data()[1].name);
+  EXPECT_EQ(FX_PLUGIN_INT, actual.data()[1].type);
+  EXPECT_EQ(0, actual.data()[1].user_set);
+  EXPECT_EQ(0, actual.data()[1].list);
+  ASSERT_EQ(1u, actual.data()[1].count);
+  EXPECT_EQ(2, actual.data()[1].ints[0]);
+
+  EXPECT_STREQ("files", actual.data()[2].name);
+  EXPECT_EQ(FX_PLUGIN_STRING, actual.data()[2].type);
+  EXPECT_EQ(1, actual.data()[2].list);
+  ASSERT_EQ(2u, actual.data()[2].count);
+  EXPECT_STREQ("a", actual.data()[2].strings[0]);
+  EXPECT_STREQ("b c", actual.data()[2].strings[1]);
+}
+
+TEST(Arguments, SkipsMissing) {
+  const fx::command::forwarder::plugin::Arguments actual(
+      descriptor(), nlohmann::json::object());
+  EXPECT_EQ(0u, actual.size());
+}
+
+// Path ------------------------------------------------------------------------
+
+TEST(Path, RelativeToCommandDirectory) {
+  EXPECT_EQ(std::filesystem::path("/ws/hello/lib/hello.so"),
+            fx::command::forwarder::plugin::path("/ws/workspace.fx.yaml",
+                                                 "hello", "lib/hello.so"));
+  EXPECT_EQ(std::filesystem::path("/opt/hello.so"),
+            fx::command::forwarder::plugin::path("/ws/workspace.fx.yaml",
+                                                 "hello", "/opt/hello.so"));
+}
+
+// Run -------------------------------------------------------------------------
+
+TEST(Run, CallsEntryPoint) {
+  if (!std::filesystem::exists(test_plugin())) {
+    GTEST_SKIP() << "test plugin not built";
+  }
+
+  const fx::command::forwarder::plugin::Arguments plugin_arguments(
+      descriptor(), arguments);
+  char* buffer = nullptr;
+  std::size_t size = 0;
+  FILE* out = open_memstream(&buffer, &size);
+  fx_plugin_context_t context{};
+  context.abi_version = FX_PLUGIN_ABI_VERSION;
+  context.command = "hello";
+  context.workspace_directory = "/ws";
+  context.argument_count = plugin_arguments.size();
+  context.arguments = plugin_arguments.data();
+  context.in = stdin;
+  context.out = out;
+  context.err = stderr;
+
+  const auto actual = fx::command::forwarder::plugin::run(test_plugin(),
+                                                          context);
+  std::fclose(out);
+  const std::string output(buffer, size);
+  std::free(buffer);
+
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(0, actual.value());
+  EXPECT_EQ(
+      "hello /ws\n"
+      "verbose user_set=1: 1\n"
+      "level user_set=0: 2\n"
+      "files user_set=1: a b c\n",
+      output);
+}
+
+TEST(Run, MissingLibrary) {
+  const auto actual = fx::command::forwarder::plugin::run(
+      "/nonexistent/libplugin.so", fx_plugin_context_t{});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(0u, actual.error().find("Unable to load plugin: "));
+}
+
+TEST(Run, MissingEntryPoint) {
+  const auto actual =
+      fx::command::forwarder::plugin::run("libm.so.6", fx_plugin_context_t{});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Plugin \"libm.so.6\" does not export fx_plugin_main_v1.",
+            actual.error());
+}
@@ -0,0 +1,207 @@
+#include "fx/command/forwarder/shard/shard.hpp"
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "test/helper/helper.hpp"
+
+// Parse -----------------------------------------------------------------------
+
+TEST(Parse, Valid) {
+  const auto actual = fx::command::forwarder::shard::parse("2/3");
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(1u, actual.value().index);
+  EXPECT_EQ(3u, actual.value().count);
+}
+
+TEST(Parse, Invalid) {
+  for (const auto& value : {"", "1", "0/2", "3/2", "1/", "/2", "a/b", "1/2x",
+                            "1/65537", "1/4294967295"}) {
+    EXPECT_TRUE(fx::command::forwarder::shard::parse(value).failed())
+        << value;
+  }
+}
+
+// Select ----------------------------------------------------------------------
+
+TEST(Select, StableHashPartitions) {
+  std::vector<std::string> items;
+  for (int index = 0; index < 100; index++) {
+    items.push_back("//target:" + std::to_string(index));
+  }
+
+  std::set<std::size_t> seen;
+  for (uint32_t index = 0; index < 3; index++) {
+    const auto selected =
+        fx::command::forwarder::shard::select(items, {}, {index, 3});
+    EXPECT_FALSE(selected.empty());
+    for (const auto item : selected) {
+      EXPECT_TRUE(seen.insert(item).second) << items[item];
+    }
+  }
+  EXPECT_EQ(items.size(), seen.size());
+}
+
+TEST(Select, BalancesByCost) {
+  const std::vector<std::string> items{"e", "d", "c", "b", "a"};
+  const std::unordered_map<std::string, double> timings{
+      {"a", 10}, {"b", 7}, {"c", 5}, {"d", 4}};
+
+  // a, then b and e (the median), then c and d onto the least loaded shard.
+  const std::vector<std::size_t> first{2, 4};
+  const std::vector<std::size_t> second{0, 1, 3};
+  EXPECT_EQ(first,
+            fx::command::forwarder::shard::select(items, timings, {0, 2}));
+  EXPECT_EQ(second,
+            fx::command::forwarder::shard::select(items, timings, {1, 2}));
+}
+
+TEST(Select, MoreShardsThanItems) {
+  const std::vector<std::string> items{"a", "b"};
+  const std::unordered_map<std::string, double> timings{{"a", 1}, {"b", 2}};
+  const uint32_t count = fx::command::forwarder::shard::max_count;
+
+  EXPECT_EQ(std::vector<std::size_t>{1},
+            fx::command::forwarder::shard::select(items, timings, {0, count}));
+  EXPECT_EQ(std::vector<std::size_t>{0},
+            fx::command::forwarder::shard::select(items, timings, {1, count}));
+  EXPECT_TRUE(fx::command::forwarder::shard::select(items, timings,
+                                                    {count - 1, count})
+                  .empty());
+}
+
+// Apply -----------------------------------------------------------------------
+
+TEST(Apply, ReplacesListArgument) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"({
+    "arguments": [
+      {"name": "mode", "string_value": {}},
+      {"name": "files", "string_value": {"list": true}}
+    ]
+  })"_json);
+  const std::unordered_map<std::string, double> timings{
+      {"x", 1}, {"y", 1}, {"z", 10}};
+  auto arguments = R"({
+    "mode": {"user_set": true, "value": "fast"},
+    "files": {"user_set": true, "value": ["x", "y", "z"]}
+  })"_json;
+
+  const auto actual = fx::command::forwarder::shard::apply(
+      descriptor, timings, {1, 2}, arguments);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(R"(["x","y"])"_json, arguments["files"]["value"]);
+  EXPECT_EQ("fast", arguments["mode"]["value"]);
+}
+
+TEST(Apply, RequiresListArgument) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"({
+    "arguments": [{"name": "mode", "string_value": {}}]
+  })"_json);
+  auto arguments = R"({"mode": {"user_set": true, "value": "fast"}})"_json;
+
+  const auto actual = fx::command::forwarder::shard::apply(descriptor, {},
+                                                           {0, 2}, arguments);
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("--fx-shard requires the command to have a list argument.",
+            actual.error());
+}
+
+// LoadTimings -----------------------------------------------------------------
+
+struct LoadTimings : testing::Test {
+  std::filesystem::path timings_path;
+
+  void SetUp() override {
+    timings_path = std::filesystem::temp_directory_path() /
+                   ("fx_shard_test_" + std::to_string(getpid()) + ".tsv");
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(timings_path);
+  }
+};
+
+TEST_F(LoadTimings, Missing) {
+  EXPECT_TRUE(
+      fx::command::forwarder::shard::load_timings(timings_path).empty());
+}
+
+TEST_F(LoadTimings, LastLineWins) {
+  std::ofstream(timings_path) << "a\t1.5\n"
+                              << "b with\ttab\t2\n"
+                              << "a\t3\n"
+                              << "malformed\n"
+                              << "c\t-1\n"
+                              << "d\tslow\n";
+
+  const std::unordered_map<std::string, double> expected{{"a", 3},
+                                                         {"b with\ttab", 2}};
+  EXPECT_EQ(expected,
+            fx::command::forwarder::shard::load_timings(timings_path));
+}
+
+TEST_F(LoadTimings, DoesNotRewrite) {
+  {
+    std::ofstream output(timings_path);
+    for (int index = 0; index < 100; index++) {
+      output << "a\t" << index << "\n";
+    }
+  }
+  const auto size = std::filesystem::file_size(timings_path);
+
+  const std::unordered_map<std::string, double> expected{{"a", 99}};
+  EXPECT_EQ(expected,
+            fx::command::forwarder::shard::load_timings(timings_path));
+  EXPECT_EQ(size, std::filesystem::file_size(timings_path));
+}
+
+// MergeTimings ----------------------------------------------------------------
+
+using MergeTimings = LoadTimings;
+
+TEST_F(MergeTimings, NothingPending) {
+  ASSERT_TRUE(fx::command::forwarder::shard::merge_timings(timings_path).ok());
+  EXPECT_FALSE(std::filesystem::exists(timings_path));
+}
+
+TEST_F(MergeTimings, CompactsIntoTimingsFile) {
+  std::ofstream(timings_path) << "b\t2\na\t1\na\t1.5\n";
+  const auto pending_path =
+      fx::command::forwarder::shard::pending_timings_path(timings_path);
+  std::ofstream(pending_path) << "c\t3\na\t4\n";
+
+  const auto actual =
+      fx::command::forwarder::shard::merge_timings(timings_path);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_FALSE(std::filesystem::exists(pending_path));
+
+  std::ifstream input(timings_path);
+  std::stringstream contents;
+  contents << input.rdbuf();
+  EXPECT_EQ("a\t4\nb\t2\nc\t3\n", contents.str());
+}
+
+TEST_F(MergeTimings, ConcurrentMerges) {
+  const int processes = 8;
+  for (int process = 0; process < processes; process++) {
+    if (fork() == 0) {
+      std::ofstream(
+          fx::command::forwarder::shard::pending_timings_path(timings_path))
+          << "item " << process << "\t" << process << "\n";
+      _exit(fx::command::forwarder::shard::merge_timings(timings_path).ok()
+                ? 0
+                : 1);
+    }
+  }
+  for (int process = 0; process < processes; process++) {
+    int status = 0;
+    wait(&status);
+    EXPECT_EQ(0, status);
+  }
+
+  EXPECT_EQ(static_cast<std::size_t>(processes),
+            fx::command::forwarder::shard::load_timings(timings_path).size());
+}
@@ -0,0 +1,94 @@
+#include "fx/command/forwarder/shell/shell.hpp"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include "fx/cache/v1beta/cache.pb.h"
+
+// Resolve ---------------------------------------------------------------------
+
+struct Resolve : testing::Test {
+  std::filesystem::path cache_directory;
+  std::string shell;
+
+  void SetUp() override {
+    cache_directory = std::filesystem::temp_directory_path() /
+                      ("fx_shell_test_" + std::to_string(getpid()));
+    if (const char* value = std::getenv("SHELL"); value != nullptr) {
+      shell = value;
+    }
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(cache_directory);
+    if (shell.empty()) {
+      unsetenv("SHELL");
+    } else {
+      setenv("SHELL", shell.c_str(), 1);
+    }
+  }
+
+  void write_entry(const std::string& cached_shell, int64_t resolved_at) {
+    fx::cache::v1beta::ShellCacheEntry entry;
+    entry.set_uid(geteuid());
+    entry.set_shell(cached_shell);
+    entry.set_resolved_at(resolved_at);
+
+    const auto path =
+        fx::command::forwarder::shell::entry_path(cache_directory, geteuid());
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    ASSERT_TRUE(entry.SerializeToOstream(&output));
+  }
+
+  fx::cache::v1beta::ShellCacheEntry read_entry() {
+    fx::cache::v1beta::ShellCacheEntry entry;
+    std::ifstream input(
+        fx::command::forwarder::shell::entry_path(cache_directory, geteuid()),
+        std::ios::binary);
+    entry.ParseFromIstream(&input);
+    return entry;
+  }
+};
+
+TEST_F(Resolve, PrefersEnvironment) {
+  setenv("SHELL", "/bin/tuna", 1);
+  write_entry("/bin/sh", time(nullptr));
+
+  EXPECT_EQ("/bin/tuna",
+            fx::command::forwarder::shell::resolve(cache_directory));
+}
+
+TEST_F(Resolve, UsesCachedShell) {
+  unsetenv("SHELL");
+  // Any executable works; the user database is not consulted.
+  write_entry("/bin/sh", time(nullptr));
+
+  EXPECT_EQ("/bin/sh", fx::command::forwarder::shell::resolve(cache_directory));
+}
+
+TEST_F(Resolve, CachesLookedUpShell) {
+  unsetenv("SHELL");
+
+  const auto actual = fx::command::forwarder::shell::resolve(cache_directory);
+  EXPECT_FALSE(actual.empty());
+  EXPECT_EQ(actual, read_entry().shell());
+}
+
+TEST_F(Resolve, IgnoresStaleEntry) {
+  unsetenv("SHELL");
+  write_entry("/bin/sh", 0);
+
+  fx::command::forwarder::shell::resolve(cache_directory);
+  EXPECT_NE(0, read_entry().resolved_at());
+}
+
+TEST_F(Resolve, IgnoresMissingShell) {
+  unsetenv("SHELL");
+  write_entry("/fx/does/not/exist", time(nullptr));
+
+  EXPECT_NE("/fx/does/not/exist",
+            fx::command::forwarder::shell::resolve(cache_directory));
+}
@@ -0,0 +1,79 @@
+#include "fx/command/forwarder/supervise/supervise.hpp"
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fx/command/forwarder/exec/exec.hpp"
+
+extern char** environ;
+
+namespace {
+  fx::result::Result<fx::command::forwarder::supervise::report_t> run_shell(
+      const std::string& script) {
+    const auto argv =
+        fx::command::forwarder::exec::pack({"/bin/sh", "-c", script});
+    return fx::command::forwarder::supervise::run(argv.data(), environ);
+  }
+}  // namespace
+
+// Supervise -------------------------------------------------------------------
+
+TEST(Supervise, ExitCode) {
+  const auto actual = run_shell("exit 3");
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(3, actual.value().exit_code);
+  EXPECT_EQ(0, actual.value().signal);
+  EXPECT_GT(actual.value().wall_seconds, 0);
+  EXPECT_GT(actual.value().max_rss_kib, 0);
+}
+
+TEST(Supervise, Signal) {
+  const auto actual = run_shell("kill -KILL $$");
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(SIGKILL, actual.value().signal);
+}
+
+TEST(Supervise, ForwardsSignals) {
+  std::thread sender([] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    kill(getpid(), SIGTERM);
+  });
+  const auto actual = run_shell("exec sleep 10");
+  sender.join();
+
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(SIGTERM, actual.value().signal);
+  EXPECT_LT(actual.value().wall_seconds, 10);
+}
+
+TEST(Supervise, MissingExecutable) {
+  const auto argv = fx::command::forwarder::exec::pack({"/fx/does/not/exist"});
+  const auto actual =
+      fx::command::forwarder::supervise::run(argv.data(), environ);
+  // glibc reports exec failures from posix_spawn, other libcs exit with 127.
+  EXPECT_TRUE(actual.failed() || actual.value().exit_code == 127);
+}
+
+// ToJson ----------------------------------------------------------------------
+
+TEST(ToJson, ExitCodeOrSignal) {
+  fx::command::forwarder::supervise::report_t report;
+  report.exit_code = 2;
+  report.max_rss_kib = 416;
+
+  const auto exited =
+      fx::command::forwarder::supervise::to_json("test", report);
+  EXPECT_EQ("test", exited["command"]);
+  EXPECT_EQ(2, exited["exit_code"]);
+  EXPECT_EQ(416, exited["max_rss_kib"]);
+  EXPECT_FALSE(exited.contains("signal"));
+
+  report.signal = SIGTERM;
+  const auto killed =
+      fx::command::forwarder::supervise::to_json("test", report);
+  EXPECT_EQ(SIGTERM, killed["signal"]);
+  EXPECT_FALSE(killed.contains("exit_code"));
+}
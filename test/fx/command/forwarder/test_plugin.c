@@ -0,0 +1,39 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include "fx/command/forwarder/plugin/fx_plugin.h"
+
+/* Prints what it was called with, one argument per line, then the variables
+ * the forwarder tests look for when they are set. */
+int fx_plugin_main_v1(const fx_plugin_context_t* context) {
+  fprintf(context->out, "%s %s\n", context->command,
+          context->workspace_directory);
+  for (size_t index = 0; index < context->argument_count; index++) {
+    const fx_plugin_argument_t* argument = &context->arguments[index];
+    fprintf(context->out, "%s user_set=%d:", argument->name,
+            argument->user_set);
+    for (size_t value = 0; value < argument->count; value++) {
+      switch (argument->type) {
+        case FX_PLUGIN_BOOL:
+        case FX_PLUGIN_INT:
+          fprintf(context->out, " %" PRId64, argument->ints[value]);
+          break;
+        case FX_PLUGIN_DOUBLE:
+          fprintf(context->out, " %g", argument->doubles[value]);
+          break;
+        case FX_PLUGIN_STRING:
+          fprintf(context->out, " %s", argument->strings[value]);
+          break;
+      }
+    }
+    fprintf(context->out, "\n");
+  }
+  const char* const variables[] = {"FX_WORKSPACE_DIRECTORY", "FX_TEST_DENIED"};
+  for (size_t index = 0; index < sizeof(variables) / sizeof(*variables);
+       index++) {
+    const char* value = getenv(variables[index]);
+    if (value != NULL) {
+      fprintf(context->out, "%s=%s\n", variables[index], value);
+    }
+  }
+  return 0;
+}
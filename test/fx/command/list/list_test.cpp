@@ -0,0 +1,76 @@
+#include "fx/command/list/list.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include "test/helper/workspace/workspace.hpp"
+
+using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::UnorderedElementsAre;
+
+// List ------------------------------------------------------------------------
+
+struct List : fx::test::helper::Workspace {
+  void SetUp() override {
+    Workspace::SetUp();
+    command("build", "echo");
+    command("build/docs", "echo");
+    command("build-all", "echo");
+    command("tools/lint/strict", "echo");
+    command("tools/format", "echo");
+  }
+
+  static std::string list() {
+    testing::internal::CaptureStdout();
+    const auto result = fx::command::List().run({});
+    const auto output = testing::internal::GetCapturedStdout();
+    EXPECT_TRUE(result.ok()) << result.error();
+    return output;
+  }
+
+  // The commands fx list prints for the workspace, in order.
+  static std::vector<std::string> listed() {
+    const auto output = list();
+    std::vector<std::string> names;
+    std::istringstream lines(output.substr(output.find("\n[workspace /")));
+    std::string line;
+    while (std::getline(lines, line)) {
+      if (line.rfind("    ", 0) == 0) {
+        names.push_back(line.substr(4, line.find(" - ") - 4));
+      }
+    }
+    return names;
+  }
+};
+
+TEST_F(List, SortedAcrossNestedDirectories) {
+  EXPECT_THAT(listed(), ElementsAre("build", "build-all", "build/docs",
+                                    "tools/format", "tools/lint/strict"));
+}
+
+TEST_F(List, SkipsSymlinkedDirectories) {
+  std::filesystem::create_directory_symlink(root / "tools", root / "linked");
+
+  EXPECT_THAT(listed(), Not(Contains(HasSubstr("linked"))));
+  const auto names =
+      fx::command::List::command_names(root / "workspace.fx.yaml");
+  ASSERT_TRUE(names.ok()) << names.error();
+  EXPECT_THAT(names.value(),
+              UnorderedElementsAre("build", "build/docs", "build-all",
+                                   "tools/format", "tools/lint/strict"));
+}
+
+TEST_F(List, WarnsAboutShadowedCommands) {
+  EXPECT_THAT(list(), Not(HasSubstr("shadowed")));
+
+  // Workspace commands take precedence over the ones fx added later.
+  command("stats", "echo");
+  EXPECT_THAT(list(), Not(HasSubstr("shadowed")));
+
+  command("version", "echo");
+  const auto output = list();
+  EXPECT_THAT(output, HasSubstr("    version - test\n"));
+  EXPECT_THAT(output, HasSubstr("\"version\" is shadowed by fx version"));
+}
@@ -0,0 +1,115 @@
+#include "fx/command/run/run.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "fx/history/history.hpp"
+#include "test/helper/workspace/workspace.hpp"
+
+using ::testing::HasSubstr;
+
+namespace {
+  fx::history::entry_t entry(const std::string& command,
+                             uint64_t workspace_hash,
+                             std::optional<int64_t> child_wall_us) {
+    fx::history::entry_t entry;
+    entry.command = command;
+    entry.workspace_hash = workspace_hash;
+    entry.child_wall_us = child_wall_us;
+    return entry;
+  }
+}  // namespace
+
+// EstimateRuntimes ------------------------------------------------------------
+
+TEST(EstimateRuntimes, MedianOfSupervisedRuns) {
+  const std::vector<fx::history::entry_t> entries{
+      entry("test", 1, 100),
+      entry("test", 1, 300),
+      entry("test", 1, 200),
+      entry("test", 2, 9000),
+      entry("lint", 1, std::nullopt),
+      entry("build", 1, 5000),
+  };
+
+  const auto actual = fx::command::estimate_runtimes(entries, 1);
+  ASSERT_EQ(2u, actual.size());
+  EXPECT_NEAR(200, actual.at("test"), 2);
+  EXPECT_NEAR(5000, actual.at("build"), 50);
+}
+
+// ScheduleLongestFirst --------------------------------------------------------
+
+TEST(ScheduleLongestFirst, UnknownFirstThenLongest) {
+  const std::vector<std::string> commands{"lint", "test", "new", "build",
+                                          "other"};
+  const std::unordered_map<std::string, double> estimates{
+      {"lint", 10}, {"test", 300}, {"build", 50}};
+
+  const std::vector<std::size_t> expected{2, 4, 1, 3, 0};
+  EXPECT_EQ(expected, fx::command::schedule_longest_first(commands, estimates));
+}
+
+TEST(ScheduleLongestFirst, KeepsOrderWithoutHistory) {
+  const std::vector<std::string> commands{"b", "a", "c"};
+
+  const std::vector<std::size_t> expected{0, 1, 2};
+  EXPECT_EQ(expected, fx::command::schedule_longest_first(commands, {}));
+}
+
+// Run -------------------------------------------------------------------------
+
+struct Run : fx::test::helper::Workspace {
+  Run() : Workspace("shell: /bin/sh\n") {}
+
+  void SetUp() override {
+    Workspace::SetUp();
+    command("first", "sh -c 'echo first; sleep 0.2; echo first again'");
+    command("second", "sh -c 'echo second'");
+    command("broken", "sh -c 'echo broken; exit 3'");
+  }
+};
+
+TEST_F(Run, NoCommands) {
+  const auto actual = fx::command::Run().run({});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Usage: fx run [--jobs=<n>] <command>...", actual.error());
+}
+
+TEST_F(Run, InvalidJobs) {
+  const auto actual = fx::command::Run().run({"--jobs=0", "first"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Invalid number of jobs \"0\".", actual.error());
+}
+
+TEST_F(Run, UnknownCommand) {
+  const auto actual = fx::command::Run().run({"first", "missing"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Unknown command \"missing\".", actual.error());
+}
+
+TEST_F(Run, BuffersOutputPerCommand) {
+  testing::internal::CaptureStdout();
+  const auto actual = fx::command::Run().run({"-j", "2", "first", "second"});
+  const auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_TRUE(actual.ok());
+  // The second command finishes first, and the first one's output stays
+  // together.
+  EXPECT_THAT(output, HasSubstr("exit code 0\nsecond\n"));
+  EXPECT_LT(output.find("second\n"), output.find("first\nfirst again\n"));
+  EXPECT_THAT(output, HasSubstr("first\nfirst again\n"));
+
+  const auto history = fx::history::read(fx::history::path(root / "cache"));
+  ASSERT_EQ(2u, history.size());
+  EXPECT_EQ("second", history[0].command);
+  EXPECT_TRUE(history[0].child_wall_us.has_value());
+}
+
+TEST_F(Run, ReportsFailures) {
+  testing::internal::CaptureStdout();
+  const auto actual = fx::command::Run().run({"broken", "second"});
+  const auto output = testing::internal::GetCapturedStdout();
+
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("1 of 2 commands failed: broken.", actual.error());
+  EXPECT_THAT(output, HasSubstr("exit code 3\nbroken\n"));
+}
@@ -0,0 +1,121 @@
+#include "fx/command/shims/shims.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "test/helper/workspace/workspace.hpp"
+
+using ::testing::HasSubstr;
+
+namespace {
+  std::string read(const std::filesystem::path& path) {
+    std::ifstream input(path);
+    return std::string(std::istreambuf_iterator<char>(input),
+                       std::istreambuf_iterator<char>());
+  }
+}  // namespace
+
+// ShimName --------------------------------------------------------------------
+
+TEST(ShimName, FlattensNestedCommands) {
+  EXPECT_EQ("fx-format", fx::command::shim_name("format"));
+  EXPECT_EQ("fx-tools-format", fx::command::shim_name("tools/format"));
+}
+
+// ParseShim -------------------------------------------------------------------
+
+TEST(ParseShim, RoundTrip) {
+  const auto contents = fx::command::render_shim(
+      "/usr/local/bin/fx", {"/home/user/acme/workspace.fx.yaml", "tools/lint"});
+  EXPECT_EQ(0u, contents.find("#!/usr/local/bin/fx --fx-shim\n"));
+
+  const auto actual = fx::command::parse_shim(contents);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(std::filesystem::path("/home/user/acme/workspace.fx.yaml"),
+            actual.value().workspace_descriptor_path);
+  EXPECT_EQ("tools/lint", actual.value().command_name);
+}
+
+TEST(ParseShim, Invalid) {
+  EXPECT_TRUE(fx::command::parse_shim("").failed());
+  EXPECT_TRUE(
+      fx::command::parse_shim("#!/bin/fx --fx-shim\nformat\n").failed());
+}
+
+// InstallShims ----------------------------------------------------------------
+
+struct InstallShims : fx::test::helper::Workspace {
+  std::filesystem::path bin;
+
+  InstallShims() : Workspace("ignore:\n  - bin\n  - third_party\n") {}
+
+  void SetUp() override {
+    Workspace::SetUp();
+    bin = root / "bin";
+    command("format");
+    command("tools/lint");
+    command("third_party/vendored");
+  }
+
+  void command(const std::string& name) const {
+    Workspace::command(name, "echo");
+  }
+
+  std::string install() {
+    fx::command::InstallShims install_shims;
+    const auto directory = bin.u8string();
+    const std::vector<std::string_view> arguments{directory};
+    testing::internal::CaptureStdout();
+    const auto result = install_shims.run(arguments);
+    const auto output = testing::internal::GetCapturedStdout();
+    EXPECT_TRUE(result.ok()) << result.error();
+    return output;
+  }
+};
+
+TEST_F(InstallShims, WritesListedCommands) {
+  EXPECT_THAT(install(), HasSubstr("2 added, 0 updated, 0 removed."));
+
+  EXPECT_TRUE(std::filesystem::exists(bin / "fx-format"));
+  EXPECT_FALSE(std::filesystem::exists(bin / "fx-third_party-vendored"));
+  const auto shim = fx::command::parse_shim(read(bin / "fx-tools-lint"));
+  ASSERT_TRUE(shim.ok()) << shim.error();
+  EXPECT_EQ(root / "workspace.fx.yaml", shim.value().workspace_descriptor_path);
+  EXPECT_EQ("tools/lint", shim.value().command_name);
+  EXPECT_NE(std::filesystem::perms::none,
+            std::filesystem::status(bin / "fx-format").permissions() &
+                std::filesystem::perms::owner_exec);
+}
+
+TEST_F(InstallShims, Incremental) {
+  install();
+  std::filesystem::remove_all(root / "format");
+  command("build");
+  std::ofstream(bin / "fx-custom") << "#!/bin/sh\necho custom\n";
+  std::ofstream(bin / "fx-elsewhere")
+      << fx::command::render_shim("/bin/fx", {"/elsewhere/workspace.fx.yaml",
+                                              "elsewhere"});
+
+  EXPECT_THAT(install(), HasSubstr("1 added, 0 updated, 1 removed."));
+  EXPECT_TRUE(std::filesystem::exists(bin / "fx-build"));
+  EXPECT_FALSE(std::filesystem::exists(bin / "fx-format"));
+  EXPECT_TRUE(std::filesystem::exists(bin / "fx-custom"));
+  EXPECT_TRUE(std::filesystem::exists(bin / "fx-elsewhere"));
+
+  EXPECT_THAT(install(), HasSubstr("0 added, 0 updated, 0 removed."));
+}
+
+TEST_F(InstallShims, Usage) {
+  fx::command::InstallShims install_shims;
+  EXPECT_TRUE(install_shims.run({}).failed());
+}
+
+// Shim ------------------------------------------------------------------------
+
+TEST(Shim, Unreadable) {
+  fx::command::Shim shim;
+  const auto actual = shim.run({"/nonexistent/fx-format"});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("Unable to read shim /nonexistent/fx-format.", actual.error());
+}
@@ -2,78 +2,161 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include "fx/command/base/base.hpp"
+#include "fx/command/batch/batch.hpp"
 #include "fx/command/forwarder/forwarder.hpp"
 #include "fx/command/help/help.hpp"
 #include "fx/command/list/list.hpp"
+#include "fx/command/run/run.hpp"
+#include "fx/command/shims/shims.hpp"
+#include "fx/command/stats/stats.hpp"
 #include "fx/command/version/version.hpp"
 #include "fx/result/result.hpp"
+#include "fx/util/util.hpp"
+#include "test/helper/allocations/allocations.hpp"
+#include "test/helper/workspace/workspace.hpp"
 
 // Dispatch --------------------------------------------------------------------
 
 struct Dispatch : testing::Test {
   template <typename C>
   void static expect_initialize_eq(
-      const std::vector<std::string>& input_arguments,
-      const std::vector<std::string>& expected_arguments) {
+      const std::vector<std::string_view>& input_arguments,
+      const std::vector<std::string_view>& expected_arguments) {
     const auto dispatcher =
         std::make_shared<fx::dispatcher::Dispatcher>(input_arguments);
-    EXPECT_EQ(expected_arguments, dispatcher->arguments());
+    const auto arguments = dispatcher->arguments();
+    EXPECT_EQ(expected_arguments, std::vector<std::string_view>(
+                                      arguments.begin(), arguments.end()));
     EXPECT_NE(std::dynamic_pointer_cast<C>(dispatcher->command()), nullptr);
   }
 };
 
 TEST_F(Dispatch, EmptyArguments) {
-  const std::vector<std::string> input_arguments{};
-  const std::vector<std::string> expected_arguments{};
+  const std::vector<std::string_view> input_arguments{};
+  const std::vector<std::string_view> expected_arguments{};
   expect_initialize_eq<fx::command::List>(input_arguments, expected_arguments);
 }
 
 TEST_F(Dispatch, StandardList) {
-  const std::vector<std::string> input_arguments{"list"};
-  const std::vector<std::string> expected_arguments{};
+  const std::vector<std::string_view> input_arguments{"list"};
+  const std::vector<std::string_view> expected_arguments{};
   expect_initialize_eq<fx::command::List>(input_arguments, expected_arguments);
 }
 
 TEST_F(Dispatch, StandardHelp) {
-  const std::vector<std::string> input_arguments{"help"};
-  const std::vector<std::string> expected_arguments{};
+  const std::vector<std::string_view> input_arguments{"help"};
+  const std::vector<std::string_view> expected_arguments{};
   expect_initialize_eq<fx::command::Help>(input_arguments, expected_arguments);
 }
 
 TEST_F(Dispatch, StandardHelpFlag) {
-  const std::vector<std::string> input_arguments{"--help"};
-  const std::vector<std::string> expected_arguments{};
+  const std::vector<std::string_view> input_arguments{"--help"};
+  const std::vector<std::string_view> expected_arguments{};
   expect_initialize_eq<fx::command::Help>(input_arguments, expected_arguments);
 }
 
 TEST_F(Dispatch, StandardHFlag) {
-  const std::vector<std::string> input_arguments{"-h"};
-  const std::vector<std::string> expected_arguments{};
+  const std::vector<std::string_view> input_arguments{"-h"};
+  const std::vector<std::string_view> expected_arguments{};
   expect_initialize_eq<fx::command::Help>(input_arguments, expected_arguments);
 }
 
 TEST_F(Dispatch, StandardVersion) {
-  const std::vector<std::string> input_arguments{"version"};
-  const std::vector<std::string> expected_arguments{};
+  const std::vector<std::string_view> input_arguments{"version"};
+  const std::vector<std::string_view> expected_arguments{};
   expect_initialize_eq<fx::command::Version>(input_arguments,
                                              expected_arguments);
 }
 
+TEST_F(Dispatch, StandardStats) {
+  const std::vector<std::string_view> input_arguments{"stats"};
+  const std::vector<std::string_view> expected_arguments{};
+  expect_initialize_eq<fx::command::Stats>(input_arguments, expected_arguments);
+}
+
+TEST_F(Dispatch, StandardRun) {
+  const std::vector<std::string_view> input_arguments{"run", "-j2", "build",
+                                                      "test"};
+  const std::vector<std::string_view> expected_arguments{"-j2", "build",
+                                                         "test"};
+  expect_initialize_eq<fx::command::Run>(input_arguments, expected_arguments);
+}
+
+TEST_F(Dispatch, StandardBatch) {
+  const std::vector<std::string_view> input_arguments{"batch", "-0"};
+  const std::vector<std::string_view> expected_arguments{"-0"};
+  expect_initialize_eq<fx::command::Batch>(input_arguments, expected_arguments);
+}
+
+TEST_F(Dispatch, StandardInstallShims) {
+  const std::vector<std::string_view> input_arguments{"install-shims", "bin"};
+  const std::vector<std::string_view> expected_arguments{"bin"};
+  expect_initialize_eq<fx::command::InstallShims>(input_arguments,
+                                                  expected_arguments);
+}
+
+TEST_F(Dispatch, ShimDispatch) {
+  const std::vector<std::string_view> input_arguments{
+      "--fx-shim", "/home/user/bin/fx-format", "-l", "bazel"};
+  const std::vector<std::string_view> expected_arguments{
+      "/home/user/bin/fx-format", "-l", "bazel"};
+  expect_initialize_eq<fx::command::Shim>(input_arguments, expected_arguments);
+}
+
 TEST_F(Dispatch, ForwarderDispatch) {
-  const std::vector<std::string> input_arguments{"tools/example", "--option",
-                                                 "abc", "arg1", "arg2"};
-  const std::vector<std::string> expected_arguments{"--option", "abc", "arg1",
-                                                    "arg2"};
+  const std::vector<std::string_view> input_arguments{
+      "tools/example", "--option", "abc", "arg1", "arg2"};
+  const std::vector<std::string_view> expected_arguments{"--option", "abc",
+                                                         "arg1", "arg2"};
   expect_initialize_eq<fx::command::Forwarder>(input_arguments,
                                                expected_arguments);
 }
 
+TEST_F(Dispatch, ForwarderDispatchViewsArguments) {
+  std::vector<std::string_view> input_arguments{"tools/example"};
+  const auto small = fx::test::helper::allocations();
+  { fx::dispatcher::Dispatcher dispatcher(input_arguments); }
+  const auto small_allocations = fx::test::helper::allocations() - small;
+
+  for (int index = 0; index < 10000; index++) {
+    input_arguments.emplace_back("--some-long-option-name-that-is-not-inlined");
+  }
+  const auto large = fx::test::helper::allocations();
+  fx::dispatcher::Dispatcher dispatcher(input_arguments);
+  const auto large_allocations = fx::test::helper::allocations() - large;
+
+  // The forwarded arguments are a view of the input, not a copy.
+  EXPECT_EQ(small_allocations, large_allocations);
+  EXPECT_EQ(input_arguments.data() + 1, dispatcher.arguments().begin());
+  EXPECT_EQ(10000u, dispatcher.arguments().size());
+}
+
+// DispatchInWorkspace ---------------------------------------------------------
+
+struct DispatchInWorkspace : fx::test::helper::Workspace {};
+
+TEST_F(DispatchInWorkspace, WorkspaceCommandsTakePrecedence) {
+  for (const auto* name : {"stats", "run", "batch", "install-shims"}) {
+    command(name, "echo");
+    const std::vector<std::string_view> input_arguments{name, "--port",
+                                                        "8080"};
+    const std::vector<std::string_view> expected_arguments{"--port", "8080"};
+    Dispatch::expect_initialize_eq<fx::command::Forwarder>(input_arguments,
+                                                           expected_arguments);
+  }
+}
+
+TEST_F(DispatchInWorkspace, ReservedCommandsStayWithFx) {
+  command("version", "echo");
+  Dispatch::expect_initialize_eq<fx::command::Version>({"version"}, {});
+}
+
 // DispatchCommand -------------------------------------------------------------
 
 class TestDispatcher : public fx::dispatcher::Protocol {
  public:
   TestDispatcher(const std::shared_ptr<fx::command::Base>& command,
-                 const std::vector<std::string>& arguments) {
+                 const std::vector<std::string_view>& arguments) {
     _command = command;
     _arguments = arguments;
   }
@@ -81,16 +164,16 @@ class TestDispatcher : public fx::dispatcher::Protocol {
 
 class SuccessfulCommand : public fx::command::Base {
  public:
-  fx::result::Result<void> run(
-      const std::vector<std::string>& arguments) override {
-    const std::vector<std::string> expected{"test", "ok"};
-    EXPECT_EQ(expected, arguments);
+  fx::result::Result<void> run(fx::util::arguments_t arguments) override {
+    const std::vector<std::string_view> expected{"test", "ok"};
+    EXPECT_EQ(expected, std::vector<std::string_view>(arguments.begin(),
+                                                      arguments.end()));
     return fx::result::Ok();
   }
 };
 
 TEST(DispatchCommand, SuccessfulRun) {
-  const std::vector<std::string> arguments{"test", "ok"};
+  const std::vector<std::string_view> arguments{"test", "ok"};
   const auto command = std::make_shared<SuccessfulCommand>();
   const auto dispatcher = std::make_shared<TestDispatcher>(command, arguments);
   dispatcher->dispatch();
@@ -98,14 +181,13 @@ TEST(DispatchCommand, SuccessfulRun) {
 
 class FailingCommand : public fx::command::Base {
  public:
-  fx::result::Result<void> run(
-      const std::vector<std::string>& /*arguments*/) override {
+  fx::result::Result<void> run(fx::util::arguments_t /*arguments*/) override {
     return fx::result::Error(std::string("intentional test error"));
   }
 };
 
 TEST(DispatchCommand, FailingRun) {
-  const std::vector<std::string> arguments{};
+  const std::vector<std::string_view> arguments{};
   const auto command = std::make_shared<FailingCommand>();
   const auto dispatcher = std::make_shared<TestDispatcher>(command, arguments);
   ASSERT_DEATH({ dispatcher->dispatch(); }, "");
@@ -0,0 +1,40 @@
+#include "fx/embedded/embedded.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+  std::string command_entry(const std::string& synopsis) {
+    fx::cache::v1beta::CommandCacheEntry entry;
+    entry.mutable_command_descriptor()->set_synopsis(synopsis);
+    return entry.SerializeAsString();
+  }
+}  // namespace
+
+TEST(Workspace, NoneLinked) {
+  EXPECT_EQ(nullptr, fx::embedded::workspace());
+}
+
+TEST(Find, SortedByName) {
+  const std::string build = command_entry("Build.");
+  const std::string test = command_entry("Test.");
+  const fx::embedded::command_t commands[] = {
+      {"build", "Build.", true, build},
+      {"test", "Test.", false, test},
+      {"tools/format", "Format.", true, std::string_view()},
+  };
+  const fx::embedded::workspace_t workspace{
+      std::string_view(), fx::util::Span<fx::embedded::command_t>(commands, 3)};
+
+  const auto* found = fx::embedded::find(workspace, "test");
+  ASSERT_NE(nullptr, found);
+  EXPECT_EQ("Test.",
+            fx::embedded::load(*found).command_descriptor().synopsis());
+  EXPECT_EQ(&commands[0], fx::embedded::find(workspace, "build"));
+  EXPECT_EQ(nullptr, fx::embedded::find(workspace, "tools"));
+  EXPECT_EQ(nullptr, fx::embedded::find(workspace, "zzz"));
+}
+
+TEST(Find, Empty) {
+  const fx::embedded::workspace_t workspace{};
+  EXPECT_EQ(nullptr, fx::embedded::find(workspace, "build"));
+}
@@ -0,0 +1,95 @@
+#include "fx/embedded/generator/generator.hpp"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Literal ---------------------------------------------------------------------
+
+TEST(Literal, Escapes) {
+  EXPECT_EQ("\"a\\\"b\\\\c\\000\\012\\077\"",
+            fx::embedded::generator::literal(
+                std::string_view("a\"b\\c\0\n?", 8), 80));
+}
+
+TEST(Literal, Wraps) {
+  EXPECT_EQ("\"abcd\"\n\"efgh\"\n\"i\"",
+            fx::embedded::generator::literal("abcdefghi", 6));
+}
+
+// Generate --------------------------------------------------------------------
+
+struct Generate : testing::Test {
+  std::filesystem::path root;
+
+  void SetUp() override {
+    root = std::filesystem::temp_directory_path() /
+           ("fx_generator_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(root);
+    std::ofstream(root / "workspace.fx.yaml")
+        << "descriptor_version: v1beta\nignore:\n  - third_party\n";
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(root);
+  }
+
+  std::filesystem::path write_command(const std::string& name,
+                                      const std::string& synopsis) {
+    const auto path = root / name / "command.fx.yaml";
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << "descriptor_version: v1beta\nsynopsis: "
+                        << synopsis << "\nruntime:\n  run: echo\n";
+    return path;
+  }
+};
+
+TEST_F(Generate, SortsCommands) {
+  const auto actual = fx::embedded::generator::generate(
+      root / "workspace.fx.yaml",
+      {write_command("test", "Run tests."),
+       write_command("third_party/lint", "Lint."),
+       write_command("build", "Build.")});
+  ASSERT_TRUE(actual.ok()) << actual.error();
+
+  const auto& source = actual.value();
+  const auto build = source.find("\"build\"");
+  const auto test = source.find("\"test\"");
+  const auto lint = source.find("\"third_party/lint\",");
+  ASSERT_NE(std::string::npos, build);
+  ASSERT_NE(std::string::npos, test);
+  ASSERT_NE(std::string::npos, lint);
+  EXPECT_LT(build, test);
+  EXPECT_LT(test, lint);
+  EXPECT_NE(std::string::npos, source.find("\"Lint.\", 5),\nfalse,"));
+  EXPECT_NE(std::string::npos, source.find("\"Build.\", 6),\ntrue,"));
+  EXPECT_NE(std::string::npos,
+            source.find("fx::util::Span<command_t>(commands, 3)"));
+}
+
+TEST_F(Generate, NoCommands) {
+  const auto actual =
+      fx::embedded::generator::generate(root / "workspace.fx.yaml", {});
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(std::string::npos, actual.value().find("commands[]"));
+  EXPECT_NE(std::string::npos,
+            actual.value().find("fx::util::Span<command_t>()"));
+}
+
+TEST_F(Generate, InvalidDescriptor) {
+  const auto path = root / "broken" / "command.fx.yaml";
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path) << "descriptor_version: v1beta\nruntime:\n  run: echo\n";
+
+  const auto actual =
+      fx::embedded::generator::generate(root / "workspace.fx.yaml", {path});
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(0u, actual.error().find(path.u8string() + ": "));
+}
+
+TEST_F(Generate, OutsideWorkspace) {
+  const auto actual = fx::embedded::generator::generate(
+      root / "workspace.fx.yaml", {root.parent_path() / "command.fx.yaml"});
+  ASSERT_TRUE(actual.failed());
+}
@@ -0,0 +1,141 @@
+#include "fx/history/history.hpp"
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+// History ---------------------------------------------------------------------
+
+struct History : testing::Test {
+  std::filesystem::path root;
+  std::filesystem::path history_path;
+
+  void SetUp() override {
+    root = std::filesystem::temp_directory_path() /
+           ("fx_history_test_" + std::to_string(getpid()));
+    history_path = fx::history::path(root);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(root);
+  }
+
+  static fx::history::entry_t entry(const std::string& command,
+                                    int64_t timestamp_us) {
+    fx::history::entry_t entry;
+    entry.command = command;
+    entry.timestamp_us = timestamp_us;
+    return entry;
+  }
+};
+
+TEST_F(History, Missing) {
+  EXPECT_TRUE(fx::history::read(history_path).empty());
+}
+
+TEST_F(History, AppendAndRead) {
+  auto measured = entry("format", 1);
+  measured.workspace_hash = 416;
+  measured.arguments_hash = 905;
+  measured.fx_overhead_us = 1200;
+  measured.child_wall_us = 3000000;
+  measured.max_rss_kib = 4096;
+  measured.exit_code = 2;
+  fx::history::append(history_path, measured);
+  fx::history::append(history_path, entry(std::string(100, 'x'), 2));
+
+  const auto actual = fx::history::read(history_path);
+  ASSERT_EQ(2u, actual.size());
+  EXPECT_EQ("format", actual[0].command);
+  EXPECT_EQ(416u, actual[0].workspace_hash);
+  EXPECT_EQ(905u, actual[0].arguments_hash);
+  EXPECT_EQ(1200, actual[0].fx_overhead_us);
+  EXPECT_EQ(3000000, actual[0].child_wall_us);
+  EXPECT_EQ(4096, actual[0].max_rss_kib);
+  EXPECT_EQ(2, actual[0].exit_code);
+  EXPECT_EQ(std::string(63, 'x'), actual[1].command);
+  EXPECT_FALSE(actual[1].child_wall_us.has_value());
+}
+
+TEST_F(History, KeepsNewestRecords) {
+  const int64_t total = fx::history::capacity + 10;
+  for (int64_t index = 0; index < total; index++) {
+    fx::history::append(history_path, entry("test", index));
+  }
+
+  const auto actual = fx::history::read(history_path);
+  ASSERT_EQ(fx::history::capacity, actual.size());
+  EXPECT_EQ(10, actual.front().timestamp_us);
+  EXPECT_EQ(total - 1, actual.back().timestamp_us);
+  EXPECT_EQ(fx::history::capacity * 128 + 64,
+            std::filesystem::file_size(history_path));
+}
+
+TEST_F(History, ConcurrentAppends) {
+  const int processes = 4;
+  const int appends = 100;
+  for (int process = 0; process < processes; process++) {
+    if (fork() == 0) {
+      for (int index = 0; index < appends; index++) {
+        fx::history::append(history_path,
+                            entry("test", process * appends + index));
+      }
+      _exit(0);
+    }
+  }
+  for (int process = 0; process < processes; process++) {
+    wait(nullptr);
+  }
+
+  std::set<int64_t> timestamps;
+  for (const auto& actual : fx::history::read(history_path)) {
+    timestamps.insert(actual.timestamp_us);
+  }
+  EXPECT_EQ(static_cast<std::size_t>(processes * appends), timestamps.size());
+}
+
+TEST_F(History, ReplacesForeignFile) {
+  std::filesystem::create_directories(root);
+  std::ofstream(history_path) << "not a history file";
+
+  EXPECT_TRUE(fx::history::read(history_path).empty());
+  fx::history::append(history_path, entry("test", 1));
+  EXPECT_EQ(1u, fx::history::read(history_path).size());
+}
+
+TEST_F(History, ReplacesResizedFileWithoutShrinkingIt) {
+  fx::history::append(history_path, entry("test", 1));
+  std::ofstream(history_path, std::ios::app) << "grown by another layout";
+  const auto grown_size = std::filesystem::file_size(history_path);
+  const int grown = open(history_path.c_str(), O_RDONLY);
+  ASSERT_GE(grown, 0);
+
+  fx::history::append(history_path, entry("test", 2));
+  const auto actual = fx::history::read(history_path);
+  ASSERT_EQ(1u, actual.size());
+  EXPECT_EQ(2, actual[0].timestamp_us);
+
+  // Whoever still maps the old file keeps all of it.
+  struct stat status {};
+  ASSERT_EQ(0, fstat(grown, &status));
+  EXPECT_EQ(grown_size, static_cast<std::uintmax_t>(status.st_size));
+  close(grown);
+}
+
+TEST_F(History, ReplacesForeignHeader) {
+  fx::history::append(history_path, entry("test", 1));
+  {
+    std::fstream file(history_path, std::ios::in | std::ios::out);
+    file << "FOREIGN";
+  }
+  EXPECT_TRUE(fx::history::read(history_path).empty());
+
+  fx::history::append(history_path, entry("test", 2));
+  const auto actual = fx::history::read(history_path);
+  ASSERT_EQ(1u, actual.size());
+  EXPECT_EQ(2, actual[0].timestamp_us);
+}
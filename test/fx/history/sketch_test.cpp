@@ -0,0 +1,58 @@
+#include "fx/history/sketch/sketch.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Sketch ----------------------------------------------------------------------
+
+TEST(Sketch, Empty) {
+  const fx::history::sketch::Sketch sketch;
+  EXPECT_EQ(0u, sketch.count());
+  EXPECT_EQ(0, sketch.quantile(0.5));
+}
+
+TEST(Sketch, RelativeAccuracy) {
+  std::mt19937 generator(416);
+  std::lognormal_distribution<double> distribution(10, 2);
+  std::vector<double> values(100000);
+  fx::history::sketch::Sketch sketch(0.01);
+  for (auto& value : values) {
+    value = distribution(generator);
+    sketch.add(value);
+  }
+  std::sort(values.begin(), values.end());
+
+  for (const double quantile : {0.0, 0.5, 0.95, 0.99, 1.0}) {
+    const double expected =
+        values[static_cast<std::size_t>(quantile * (values.size() - 1))];
+    EXPECT_NEAR(expected, sketch.quantile(quantile), expected * 0.01)
+        << quantile;
+  }
+}
+
+TEST(Sketch, Zeros) {
+  fx::history::sketch::Sketch sketch;
+  sketch.add(0);
+  sketch.add(0);
+  sketch.add(100);
+
+  EXPECT_EQ(3u, sketch.count());
+  EXPECT_EQ(0, sketch.quantile(0.5));
+  EXPECT_NEAR(100, sketch.quantile(1), 1);
+}
+
+TEST(Sketch, Merge) {
+  fx::history::sketch::Sketch low;
+  fx::history::sketch::Sketch high;
+  for (int value = 1; value <= 100; value++) {
+    low.add(value);
+    high.add(value * 1000);
+  }
+  low.merge(high);
+
+  EXPECT_EQ(200u, low.count());
+  EXPECT_NEAR(100, low.quantile(0.5), 1);
+  EXPECT_NEAR(1000, low.quantile(0.505), 10);
+  EXPECT_NEAR(100000, low.quantile(1), 1000);
+}
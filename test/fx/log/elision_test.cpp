@@ -0,0 +1,14 @@
+// Overrides the level release builds pass on the command line.
+#undef FX_LOG_LEVEL
+#define FX_LOG_LEVEL SPDLOG_LEVEL_CRITICAL
+#include <gtest/gtest.h>
+#include "fx/log/log.hpp"
+
+TEST(Elision, CompilesOutLevelsBelowFxLogLevel) {
+  ASSERT_TRUE(fx::log::enabled(spdlog::level::err));
+
+  int evaluations = 0;
+  FX_LOG_ERROR("{0}", ++evaluations);
+  FX_LOG_WARN("{0}", ++evaluations);
+  EXPECT_EQ(0, evaluations);
+}
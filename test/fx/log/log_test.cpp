@@ -0,0 +1,41 @@
+#include "fx/log/log.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+// ParseLevel ------------------------------------------------------------------
+
+TEST(ParseLevel, DefaultLogger) {
+  EXPECT_EQ(spdlog::level::info, fx::log::parse_level(nullptr));
+  EXPECT_EQ(spdlog::level::info, fx::log::parse_level(""));
+  EXPECT_EQ(spdlog::level::debug, fx::log::parse_level("debug"));
+  EXPECT_EQ(spdlog::level::off, fx::log::parse_level("off"));
+  EXPECT_EQ(spdlog::level::warn, fx::log::parse_level("debug,warn"));
+  EXPECT_EQ(spdlog::level::off, fx::log::parse_level("debug,off"));
+}
+
+TEST(ParseLevel, SkipsNamedLoggersAndUnknownLevels) {
+  EXPECT_EQ(spdlog::level::info, fx::log::parse_level("other=debug"));
+  EXPECT_EQ(spdlog::level::warn, fx::log::parse_level("foo=trace,warn"));
+  EXPECT_EQ(spdlog::level::err, fx::log::parse_level("err,other=trace"));
+  EXPECT_EQ(spdlog::level::debug, fx::log::parse_level("debug,loud"));
+}
+
+// Macros ----------------------------------------------------------------------
+
+static std::string evaluate(int& evaluations) {
+  evaluations++;
+  return "evaluated";
+}
+
+TEST(Macros, SkipsArgumentsOfDisabledLevels) {
+  // Tests run without $SPDLOG_LEVEL, so only info and above are enabled.
+  ASSERT_FALSE(fx::log::enabled(spdlog::level::debug));
+  ASSERT_TRUE(fx::log::enabled(spdlog::level::err));
+
+  int evaluations = 0;
+  FX_LOG_DEBUG("{0}", evaluate(evaluations));
+  EXPECT_EQ(0, evaluations);
+
+  FX_LOG_ERROR("intentional test error, {0}", evaluate(evaluations));
+  EXPECT_EQ(1, evaluations);
+}
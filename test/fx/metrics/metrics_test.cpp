@@ -0,0 +1,139 @@
+#include "fx/metrics/metrics.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+// Metrics ---------------------------------------------------------------------
+
+struct Metrics : testing::Test {
+  std::filesystem::path root;
+  std::filesystem::path table;
+  std::filesystem::path output_path;
+
+  void SetUp() override {
+    root = std::filesystem::temp_directory_path() /
+           ("fx_metrics_test_" + std::to_string(getpid()));
+    table = fx::metrics::table_path(root);
+    output_path = root / "fx.prom";
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(root);
+  }
+
+  static fx::metrics::observation_t observation(const std::string& command) {
+    fx::metrics::observation_t observation;
+    observation.workspace = "/src/app";
+    observation.command = command;
+    observation.seconds[fx::metrics::PHASE_DISCOVERY] = 0.0002;
+    observation.seconds[fx::metrics::PHASE_PARSE] = 0.003;
+    observation.seconds[fx::metrics::PHASE_ARGPARSE] = 0.0004;
+    return observation;
+  }
+
+  std::string exported() const {
+    std::ifstream input(output_path);
+    std::stringstream contents;
+    contents << input.rdbuf();
+    return contents.str();
+  }
+};
+
+TEST_F(Metrics, Missing) {
+  EXPECT_EQ("", fx::metrics::render(table));
+}
+
+TEST_F(Metrics, CountsInvocationsAndFailures) {
+  auto failed = observation("test");
+  failed.failed = true;
+  fx::metrics::record(table, output_path, observation("test"));
+  fx::metrics::record(table, output_path, failed);
+  fx::metrics::record(table, output_path, observation("build"));
+
+  const auto actual = exported();
+  EXPECT_EQ(fx::metrics::render(table), actual);
+  EXPECT_THAT(actual,
+              HasSubstr("fx_invocations_total{workspace=\"/src/app\","
+                        "command=\"test\"} 2\n"));
+  EXPECT_THAT(actual,
+              HasSubstr("fx_invocations_total{workspace=\"/src/app\","
+                        "command=\"build\"} 1\n"));
+  EXPECT_THAT(actual,
+              HasSubstr("fx_failures_total{workspace=\"/src/app\","
+                        "command=\"test\"} 1\n"));
+  EXPECT_THAT(actual, HasSubstr("# TYPE fx_phase_duration_seconds histogram"));
+}
+
+TEST_F(Metrics, SplitsPhases) {
+  auto supervised = observation("test");
+  supervised.seconds[fx::metrics::PHASE_CHILD] = 2;
+  fx::metrics::record(table, output_path, supervised);
+
+  const std::string labels = "workspace=\"/src/app\",command=\"test\"";
+  const auto actual = exported();
+  EXPECT_THAT(actual, HasSubstr("fx_phase_duration_seconds_bucket{" + labels +
+                                ",phase=\"discovery\",le=\"0.0005\"} 1\n"));
+  EXPECT_THAT(actual, HasSubstr("fx_phase_duration_seconds_bucket{" + labels +
+                                ",phase=\"parse\",le=\"0.0025\"} 0\n"));
+  EXPECT_THAT(actual, HasSubstr("fx_phase_duration_seconds_bucket{" + labels +
+                                ",phase=\"parse\",le=\"0.005\"} 1\n"));
+  EXPECT_THAT(actual, HasSubstr("fx_phase_duration_seconds_bucket{" + labels +
+                                ",phase=\"child\",le=\"1\"} 0\n"));
+  EXPECT_THAT(actual, HasSubstr("fx_phase_duration_seconds_bucket{" + labels +
+                                ",phase=\"child\",le=\"+Inf\"} 1\n"));
+  EXPECT_THAT(actual, HasSubstr("fx_phase_duration_seconds_sum{" + labels +
+                                ",phase=\"child\"} 2\n"));
+  EXPECT_THAT(actual, HasSubstr("fx_phase_duration_seconds_count{" + labels +
+                                ",phase=\"parse\"} 1\n"));
+
+  fx::metrics::record(table, output_path, observation("test"));
+  EXPECT_THAT(exported(), HasSubstr("fx_phase_duration_seconds_count{" +
+                                    labels + ",phase=\"child\"} 1\n"));
+}
+
+TEST_F(Metrics, EscapesLabels) {
+  auto quoted = observation("test");
+  quoted.workspace = "/src/\"app\"\\";
+  fx::metrics::record(table, output_path, quoted);
+
+  EXPECT_THAT(exported(),
+              HasSubstr("workspace=\"/src/\\\"app\\\"\\\\\",command=\"test\""));
+}
+
+TEST_F(Metrics, DisabledWithoutExport) {
+  fx::metrics::record(table, std::filesystem::path(), observation("test"));
+
+  EXPECT_FALSE(std::filesystem::exists(output_path));
+  EXPECT_FALSE(std::filesystem::exists(table));
+}
+
+TEST_F(Metrics, ConcurrentRecords) {
+  const int processes = 4;
+  const int records = 50;
+  for (int process = 0; process < processes; process++) {
+    if (fork() == 0) {
+      for (int index = 0; index < records; index++) {
+        fx::metrics::record(table, output_path,
+                            observation(index % 2 == 0 ? "even" : "odd"));
+      }
+      _exit(0);
+    }
+  }
+  for (int process = 0; process < processes; process++) {
+    wait(nullptr);
+  }
+
+  const auto actual = exported();
+  EXPECT_THAT(actual, HasSubstr("command=\"even\"} 100\n"));
+  EXPECT_THAT(actual, HasSubstr("command=\"odd\"} 100\n"));
+  for (const auto& entry : std::filesystem::directory_iterator(root)) {
+    EXPECT_THAT(entry.path().filename().u8string(), Not(HasSubstr(".tmp")));
+  }
+}
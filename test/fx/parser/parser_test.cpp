@@ -4,6 +4,7 @@
 #include <yaml-cpp/yaml.h>
 #include <filesystem>
 #include <nlohmann/json.hpp>
+#include <vector>
 #include "fx/result/result.hpp"
 
 // ParseWorkspaceDescriptor ----------------------------------------------------
@@ -151,6 +152,73 @@ TEST_F(ParseCommandDescriptor, ValidYaml) {
   expect_parse_eq(descriptor_path, expected);
 }
 
+// ParseCommandDescriptorOnArena -----------------------------------------------
+
+struct ParseCommandDescriptorOnArena : testing::Test {
+  std::vector<char> block = std::vector<char>(16 * 1024);
+  google::protobuf::Arena arena = google::protobuf::Arena(arena_options());
+
+  google::protobuf::ArenaOptions arena_options() {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block.data();
+    options.initial_block_size = block.size();
+    return options;
+  }
+
+  bool in_block(const void* address) const {
+    const char* pointer = static_cast<const char*>(address);
+    return pointer >= block.data() && pointer < block.data() + block.size();
+  }
+};
+
+TEST_F(ParseCommandDescriptorOnArena, ValidYaml) {
+  const std::filesystem::path descriptor_path(
+      "test/fx/parser/__data__/valid.command.fx.yaml");
+
+  fx::descriptor::v1beta::FxCommandDescriptor expected;
+  expected.set_descriptor_version("v1beta");
+  expected.set_synopsis("test");
+  expected.mutable_runtime()->set_run("test-run");
+
+  const auto result =
+      fx::parser::parse_command_descriptor(descriptor_path, &arena);
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ(&arena, result.value()->GetArena());
+  ASSERT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+      expected, *result.value()));
+}
+
+TEST_F(ParseCommandDescriptorOnArena, ValidationFail) {
+  const std::filesystem::path descriptor_path(
+      "test/fx/parser/__data__/validation_fail.command.fx.yaml");
+
+  const auto result =
+      fx::parser::parse_command_descriptor(descriptor_path, &arena);
+  ASSERT_TRUE(result.failed());
+  EXPECT_EQ(
+      "Invalid descriptor: "
+      "test/fx/parser/__data__/validation_fail.command.fx.yaml. Unsupported "
+      "descriptor "
+      "version \"fake-version\", only v1beta is supported. Command synopsis "
+      "cannot "
+      "be empty. Runtime run cannot be empty.",
+      result.error());
+}
+
+TEST_F(ParseCommandDescriptorOnArena, ResetArenaReusesMemory) {
+  const std::filesystem::path descriptor_path(
+      "test/fx/parser/__data__/valid.command.fx.yaml");
+
+  for (int index = 0; index < 8; index++) {
+    const auto result =
+        fx::parser::parse_command_descriptor(descriptor_path, &arena);
+    ASSERT_TRUE(result.ok()) << result.error();
+    EXPECT_EQ("test", result.value()->synopsis());
+    EXPECT_TRUE(in_block(result.value()));
+    arena.Reset();
+  }
+}
+
 // JsonToDescriptor ------------------------------------------------------------
 
 struct JsonToDescriptor : testing::Test {
@@ -45,6 +45,17 @@ TEST_F(ValidateDescriptor, InvalidWorkspace) {
   expect_validate_errors(descriptor, expected_errors);
 }
 
+TEST_F(ValidateDescriptor, RelativeWorkspaceShell) {
+  const auto descriptor = fx::test::helper::workspace_descriptor(R"(
+    {"descriptor_version": "v1beta", "shell": "bash"}
+  )"_json);
+
+  const std::string expected_errors =
+      "Workspace shell \"bash\" must be an absolute path.";
+
+  expect_validate_errors(descriptor, expected_errors);
+}
+
 TEST_F(ValidateDescriptor, ValidCommand) {
   const auto descriptor = fx::test::helper::command_descriptor(R"(
     {
@@ -184,6 +195,49 @@ TEST_F(ValidateCommand, EmptyRuntime) {
   expect_validate_errors(descriptor, expected_errors);
 }
 
+TEST_F(ValidateCommand, PluginRuntime) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {"descriptor_version": "v1beta", "synopsis": "test",
+     "runtime": {"plugin": "libtest.so"}}
+  )"_json);
+
+  expect_validate_ok(descriptor);
+}
+
+TEST_F(ValidateCommand, PluginAndRun) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"(
+    {"descriptor_version": "v1beta", "synopsis": "test",
+     "runtime": {"run": "run-test", "plugin": ""}}
+  )"_json);
+
+  std::vector<std::string> expected_errors{
+      "Runtime run and plugin cannot both be set.",
+      "Runtime plugin cannot be empty."};
+
+  expect_validate_errors(descriptor, expected_errors);
+}
+
+TEST_F(ValidateCommand, InvalidEnvironmentPatterns) {
+  const auto descriptor = fx::test::helper::command_descriptor(R"({
+    "descriptor_version": "v1beta",
+    "synopsis": "test",
+    "runtime": {
+      "run": "run-test",
+      "environment": {"allow": ["PATH", "LC_*", "A*B"], "deny": ["", "X=1"]}
+    }
+  })"_json);
+
+  std::vector<std::string> expected_errors{
+      "Runtime environment allow[index:2] \"A*B\" is not a valid variable "
+      "pattern.",
+      "Runtime environment deny[index:0] \"\" is not a valid variable "
+      "pattern.",
+      "Runtime environment deny[index:1] \"X=1\" is not a valid variable "
+      "pattern."};
+
+  expect_validate_errors(descriptor, expected_errors);
+}
+
 TEST_F(ValidateCommand, Empty) {
   const auto descriptor = fx::test::helper::command_descriptor(R"({})"_json);
 
@@ -398,6 +452,18 @@ TEST_F(ValidateName, OptionReservedUpperHELP) {
   expect_validate_errors(descriptor, expected_errors);
 }
 
+TEST_F(ValidateName, OptionReservedFxPrefix) {
+  const auto descriptor = fx::test::helper::option_descriptor(R"(
+    {"name": "FX-profile"}
+  )"_json);
+
+  std::vector<std::string> expected_errors{
+      "[test-prefix] \"FX-profile\" name cannot start with \"fx-\" "
+      "(reserved)."};
+
+  expect_validate_errors(descriptor, expected_errors);
+}
+
 TEST_F(ValidateName, ArgumentValidName) {
   const auto descriptor = fx::test::helper::argument_descriptor(R"(
     {"name": "hello"}
@@ -0,0 +1,208 @@
+#include "fx/parser/yaml_reader/yaml_reader.hpp"
+#include <gtest/gtest.h>
+#include <yaml-cpp/yaml.h>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "fx/parser/yaml_to_json/yaml_to_json.hpp"
+
+static const std::vector<std::string> seeds = {
+    R"(descriptor_version: v1beta
+synopsis: Benchmark command.
+options:
+  - name: verbose
+    short_name: v
+    bool_value: {}
+  - name: language
+    string_value:
+      list: true
+      choices: [all, cpp, "java", 'go']
+      default: all
+  - name: jobs
+    int_value:
+      default: 8
+  - name: ratio
+    double_value: {default: -0.25, choices: [0.5, 1.0]}
+arguments:
+  - name: targets
+    string_value:
+      list: true
+runtime:
+  run: python3 $FX_WORKSPACE_DIRECTORY/benchmark/main.py # Comment.
+)",
+    R"(---
+# A comment.
+description: |
+  First line.
+
+  Second line: with a colon.
+synopsis: >-
+  Folded
+  text.
+
+ignore:
+- one
+- "two # not a comment"
+- 'it''s'
+-
+  - nested
+  - ~
+)",
+    R"(- a: yes
+  b: No
+  c: "true"
+- - 1
+  - -7
+  - 1.5
+- {key: value, other: [1, 2]}
+)",
+};
+
+static std::vector<std::string> corpus() {
+  auto result = seeds;
+  for (const auto& entry :
+       std::filesystem::directory_iterator("test/fx/parser/__data__")) {
+    std::ifstream file(entry.path());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    result.emplace_back(contents.str());
+  }
+  return result;
+}
+
+// Whether `yaml` went through the fast path, in which case yaml-cpp must
+// produce the same JSON.
+static bool expect_agrees(const std::string& yaml) {
+  const auto actual = fx::parser::yaml_reader::read(yaml);
+  if (!actual.has_value()) {
+    return false;
+  }
+
+  nlohmann::json expected;
+  try {
+    const auto result =
+        fx::parser::yaml_to_json::convert(YAML::Load(yaml), expected);
+    EXPECT_TRUE(result.ok()) << yaml;
+  } catch (const std::exception& exception) {
+    ADD_FAILURE() << exception.what() << " in:\n" << yaml;
+  }
+  EXPECT_EQ(expected.dump(), actual->dump()) << yaml;
+  return true;
+}
+
+// Read ------------------------------------------------------------------------
+
+TEST(Read, Descriptor) {
+  const auto json = fx::parser::yaml_reader::read(seeds[0]);
+  ASSERT_TRUE(json.has_value());
+  EXPECT_EQ("v", (*json)["options"][0]["short_name"]);
+  EXPECT_EQ(nlohmann::json::object(), (*json)["options"][0]["bool_value"]);
+  EXPECT_EQ(8, (*json)["options"][2]["int_value"]["default"]);
+  EXPECT_EQ(-0.25, (*json)["options"][3]["double_value"]["default"]);
+  EXPECT_EQ("python3 $FX_WORKSPACE_DIRECTORY/benchmark/main.py",
+            (*json)["runtime"]["run"]);
+}
+
+TEST(Read, BlockScalars) {
+  const auto json = fx::parser::yaml_reader::read(seeds[1]);
+  ASSERT_TRUE(json.has_value());
+  EXPECT_EQ("First line.\n\nSecond line: with a colon.\n",
+            (*json)["description"]);
+  EXPECT_EQ("Folded text.", (*json)["synopsis"]);
+  EXPECT_EQ(R"(["one","two # not a comment","it's",["nested"]])",
+            (*json)["ignore"].dump());
+}
+
+TEST(Read, FallsBack) {
+  for (const auto* yaml : {
+           "a: 1.5e3\n",
+           "a: 0x10\n",
+           "a: &anchor b\n",
+           "a: !tag b\n",
+           "? a\n: b\n",
+           "a: b\n  c\n",
+           "a: |+\n  b\n",
+           "a: [b,\n  c]\n",
+           "a:\tb\n",
+           "a: b\r\n",
+           "\xEF\xBB\xBF" "a: b\n",
+           "%YAML 1.2\n---\na: b\n",
+           "scalar\n",
+           "",
+           "a: [b\n",
+       }) {
+    EXPECT_FALSE(fx::parser::yaml_reader::read(yaml).has_value()) << yaml;
+  }
+}
+
+TEST(Read, MatchesYamlCpp) {
+  for (const auto& yaml : corpus()) {
+    expect_agrees(yaml);
+  }
+  for (const auto& yaml : seeds) {
+    EXPECT_TRUE(expect_agrees(yaml)) << yaml;
+  }
+}
+
+// Mutates the corpus with edits around YAML's syntax and checks that whatever
+// the fast path accepts, it reads like yaml-cpp does.
+TEST(Read, MatchesYamlCppOnMutations) {
+  static const std::string alphabet = " \n:-#'\"[]{},|>~.0 1a\\&?";
+  std::mt19937 random(416);
+  const auto pick = [&](std::size_t size) {
+    return std::uniform_int_distribution<std::size_t>(0, size - 1)(random);
+  };
+
+  std::size_t accepted = 0;
+  std::size_t total = 0;
+  for (const auto& source : corpus()) {
+    if (source.empty()) {
+      continue;
+    }
+    for (int iteration = 0; iteration < 2000; iteration++) {
+      auto yaml = source;
+      const auto edits = 1 + pick(3);
+      for (std::size_t edit = 0; edit < edits && !yaml.empty(); edit++) {
+        const auto position = pick(yaml.size());
+        switch (pick(4)) {
+          case 0:
+            yaml.erase(position, 1);
+            break;
+          case 1:
+            yaml.insert(position, 1, alphabet[pick(alphabet.size())]);
+            break;
+          case 2:
+            yaml[position] = alphabet[pick(alphabet.size())];
+            break;
+          default:
+            yaml.insert(position, "  ");
+            break;
+        }
+      }
+      accepted += expect_agrees(yaml);
+      total++;
+    }
+  }
+
+  // Most edits keep valid YAML, so the fast path has to take a fair share.
+  EXPECT_GT(accepted, total / 4);
+}
+
+// HasUnsupportedBytes ---------------------------------------------------------
+
+TEST(HasUnsupportedBytes, FindsTabsAndCarriageReturns) {
+  const std::string yaml(100, 'a');
+  EXPECT_FALSE(fx::parser::yaml_reader::has_unsupported_bytes(yaml));
+  for (std::size_t position = 0; position < yaml.size(); position++) {
+    for (const char character : {'\t', '\r'}) {
+      auto mutated = yaml;
+      mutated[position] = character;
+      EXPECT_TRUE(fx::parser::yaml_reader::has_unsupported_bytes(mutated))
+          << position;
+    }
+  }
+}
@@ -0,0 +1,173 @@
+#include "fx/result/result.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+  fx::result::Result<int> parse(const std::string& value) {
+    if (value.empty()) {
+      return fx::result::Error(std::string("empty"));
+    }
+    return fx::result::Ok(std::stoi(value));
+  }
+
+  fx::result::Result<int> halve(int value) {
+    if (value % 2 != 0) {
+      return fx::result::Error(std::to_string(value) + " is odd");
+    }
+    return fx::result::Ok(value / 2);
+  }
+
+  template <typename R>
+  using take_t = decltype(std::declval<R>().take());
+
+  template <typename R, typename = void>
+  struct can_take : std::false_type {};
+
+  template <typename R>
+  struct can_take<R, std::void_t<take_t<R>>> : std::true_type {};
+}  // namespace
+
+// Map -------------------------------------------------------------------------
+
+TEST(Map, TransformsValue) {
+  auto actual = parse("21").map([](int value) { return value * 2; });
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(42, actual.value());
+}
+
+TEST(Map, ChangesValueType) {
+  auto actual = parse("7").map([](int value) { return std::to_string(value); });
+  static_assert(std::is_same<decltype(actual),
+                             fx::result::Result<std::string>>::value);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ("7", actual.value());
+}
+
+TEST(Map, PassesErrorThrough) {
+  int calls = 0;
+  auto actual = parse("").map([&](int value) {
+    calls++;
+    return value;
+  });
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("empty", actual.error());
+  EXPECT_EQ(0, calls);
+}
+
+TEST(Map, Void) {
+  int calls = 0;
+  fx::result::Result<void> ok = fx::result::Ok();
+  auto actual = std::move(ok).map([&] {
+    calls++;
+    return 1;
+  });
+  ASSERT_TRUE(actual.ok());
+  EXPECT_EQ(1, actual.value());
+
+  auto discarded = parse("3").map([&](int value) { calls += value; });
+  static_assert(
+      std::is_same<decltype(discarded), fx::result::Result<void>>::value);
+  EXPECT_TRUE(discarded.ok());
+  EXPECT_EQ(4, calls);
+}
+
+// AndThen ---------------------------------------------------------------------
+
+TEST(AndThen, Chains) {
+  auto actual = parse("8").and_then(halve).and_then(halve);
+  ASSERT_TRUE(actual.ok()) << actual.error();
+  EXPECT_EQ(2, actual.value());
+}
+
+TEST(AndThen, StopsAtFirstError) {
+  int calls = 0;
+  auto actual = parse("6").and_then(halve).and_then(halve).and_then(
+      [&](int value) {
+        calls++;
+        return halve(value);
+      });
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("3 is odd", actual.error());
+  EXPECT_EQ(0, calls);
+}
+
+// MapError --------------------------------------------------------------------
+
+TEST(MapError, TransformsError) {
+  auto actual = parse("").map_error(
+      [](std::string error) { return "[parse] " + error; });
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ("[parse] empty", actual.error());
+}
+
+TEST(MapError, ChangesErrorType) {
+  auto actual = parse("").map_error(
+      [](const std::string& error) { return error.size(); });
+  static_assert(std::is_same<decltype(actual),
+                             fx::result::Result<int, std::size_t>>::value);
+  ASSERT_TRUE(actual.failed());
+  EXPECT_EQ(5u, actual.error());
+}
+
+TEST(MapError, PassesValueThrough) {
+  auto actual = parse("5").map_error([](std::string error) { return error; });
+  ASSERT_TRUE(actual.ok());
+  EXPECT_EQ(5, actual.value());
+}
+
+// Take ------------------------------------------------------------------------
+
+TEST(Take, MovesValueOut) {
+  fx::result::Result<std::unique_ptr<int>> result =
+      fx::result::Ok(std::make_unique<int>(416));
+  const auto value = std::move(result).take();
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ(416, *value);
+  EXPECT_TRUE(result.ok());
+}
+
+TEST(Take, OnlyOnRvalues) {
+  static_assert(can_take<fx::result::Result<int>&&>::value);
+  static_assert(!can_take<fx::result::Result<int>&>::value);
+  static_assert(!can_take<const fx::result::Result<int>&>::value);
+}
+
+// Value -----------------------------------------------------------------------
+
+TEST(Value, ReferenceQualified) {
+  fx::result::Result<std::vector<int>> result =
+      fx::result::Ok(std::vector<int>{1, 2});
+  static_assert(
+      std::is_same<decltype(result.value()), std::vector<int>&>::value);
+  static_assert(std::is_same<decltype(std::as_const(result).value()),
+                             const std::vector<int>&>::value);
+  static_assert(std::is_same<decltype(std::move(result).value()),
+                             std::vector<int>>::value);
+
+  result.value().push_back(3);
+  EXPECT_EQ(3u, std::as_const(result).value().size());
+
+  const auto moved = std::move(result).value();
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), moved);
+}
+
+// Error -----------------------------------------------------------------------
+
+TEST(Error, ReferenceQualified) {
+  fx::result::Result<int> result = fx::result::Error(std::string("failed"));
+  static_assert(std::is_same<decltype(result.error()), std::string&>::value);
+  static_assert(std::is_same<decltype(std::as_const(result).error()),
+                             const std::string&>::value);
+  static_assert(
+      std::is_same<decltype(std::move(result).error()), std::string>::value);
+
+  result.error() += " twice";
+  EXPECT_EQ("failed twice", std::as_const(result).error());
+
+  const auto moved = std::move(result).error();
+  EXPECT_EQ("failed twice", moved);
+}
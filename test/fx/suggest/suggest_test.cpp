@@ -0,0 +1,90 @@
+#include "fx/suggest/suggest.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using words_t = std::vector<std::string>;
+
+// Distance --------------------------------------------------------------------
+
+TEST(Distance, Edits) {
+  EXPECT_EQ(0, fx::suggest::distance("build", "build"));
+  EXPECT_EQ(1, fx::suggest::distance("build", "buld"));
+  EXPECT_EQ(1, fx::suggest::distance("build", "builds"));
+  EXPECT_EQ(1, fx::suggest::distance("build", "bvild"));
+  EXPECT_EQ(3, fx::suggest::distance("kitten", "sitting"));
+  EXPECT_EQ(5, fx::suggest::distance("", "build"));
+}
+
+// Search ----------------------------------------------------------------------
+
+TEST(Search, ClosestFirstThenAlphabetical) {
+  const auto trie = fx::suggest::build({"test", "tests", "best", "rest", "te"});
+
+  EXPECT_EQ((words_t{"test", "best", "rest", "tests", "te"}),
+            fx::suggest::search(trie, "test", 2, 10));
+  EXPECT_EQ((words_t{"test", "best"}),
+            fx::suggest::search(trie, "test", 2, 2));
+}
+
+TEST(Search, MaxDistance) {
+  const auto trie = fx::suggest::build({"deploy/staging", "deploy/prod"});
+
+  EXPECT_EQ(words_t{"deploy/prod"},
+            fx::suggest::search(trie, "deploy/prd", 1, 3));
+  EXPECT_TRUE(fx::suggest::search(trie, "deploy", 2, 3).empty());
+}
+
+TEST(Search, DuplicatesAndEmptyTrie) {
+  EXPECT_EQ(words_t{"a"},
+            fx::suggest::search(fx::suggest::build({"a", "a"}), "a", 0, 3));
+  EXPECT_TRUE(
+      fx::suggest::search(fx::suggest::build({}), "build", 5, 3).empty());
+}
+
+TEST(Search, CorruptTrie) {
+  const auto valid = fx::suggest::build({"build", "test"});
+  ASSERT_EQ(words_t{"test"}, fx::suggest::search(valid, "test", 0, 3));
+
+  // Out of range, pointing back at the root, and decreasing offsets.
+  for (const uint32_t offset : {1000000u, 0u}) {
+    auto trie = valid;
+    trie.set_child_offsets(1, offset);
+    EXPECT_TRUE(fx::suggest::search(trie, "test", 2, 3).empty());
+  }
+  auto trie = valid;
+  trie.set_child_offsets(0, 2);
+  EXPECT_TRUE(fx::suggest::search(trie, "test", 2, 3).empty());
+  trie = valid;
+  trie.set_child_offsets(trie.child_offsets_size() - 1, 1000000u);
+  EXPECT_TRUE(fx::suggest::search(trie, "test", 2, 3).empty());
+  trie = valid;
+  trie.mutable_labels()->pop_back();
+  EXPECT_TRUE(fx::suggest::search(trie, "test", 2, 3).empty());
+}
+
+// Suggest ---------------------------------------------------------------------
+
+TEST(Suggest, ShortWordsAllowOneEdit) {
+  const auto trie = fx::suggest::build({"ab", "xy", "abcd"});
+
+  EXPECT_EQ(words_t{"ab"}, fx::suggest::suggest(trie, "a"));
+  EXPECT_EQ((words_t{"ab", "abcd"}), fx::suggest::suggest(trie, "abd"));
+}
+
+TEST(Suggest, LimitsToThree) {
+  const auto trie = fx::suggest::build({"bat", "cat", "hat", "mat", "rat"});
+
+  EXPECT_EQ((words_t{"bat", "cat", "hat"}), fx::suggest::suggest(trie, "fat"));
+}
+
+// DidYouMean ------------------------------------------------------------------
+
+TEST(DidYouMean, Formats) {
+  EXPECT_EQ("", fx::suggest::did_you_mean({}));
+  EXPECT_EQ(" Did you mean \"a\"?", fx::suggest::did_you_mean({"a"}));
+  EXPECT_EQ(" Did you mean \"a\" or \"b\"?",
+            fx::suggest::did_you_mean({"a", "b"}));
+  EXPECT_EQ(" Did you mean \"a\", \"b\" or \"c\"?",
+            fx::suggest::did_you_mean({"a", "b", "c"}));
+}
@@ -0,0 +1,52 @@
+#include "allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+  std::atomic<std::uint64_t> allocation_count{0};
+  std::atomic<std::uint64_t> allocation_bytes{0};
+
+  void* counted_allocate(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+      return pointer;
+    }
+    throw std::bad_alloc();
+  }
+}  // namespace
+
+void* operator new(std::size_t size) {
+  return counted_allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return counted_allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t /*size*/) noexcept {
+  std::free(pointer);
+}
+
+namespace fx::test::helper {
+  std::uint64_t allocations() {
+    return allocation_count.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t allocated_bytes() {
+    return allocation_bytes.load(std::memory_order_relaxed);
+  }
+}  // namespace fx::test::helper
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace fx::test::helper {
+  // Allocations made through the global operator new since the binary
+  // started. Tests compare two readings to check a code path does not copy,
+  // benchmarks report them per iteration.
+  std::uint64_t allocations();
+
+  // Bytes requested by those allocations.
+  std::uint64_t allocated_bytes();
+}  // namespace fx::test::helper
@@ -0,0 +1,45 @@
+#include "workspace.hpp"
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+
+namespace fx::test::helper {
+  Workspace::Workspace(std::string workspace)
+      : _workspace(std::move(workspace)) {}
+
+  void Workspace::SetUp() {
+    const auto* test = testing::UnitTest::GetInstance()->current_test_info();
+    root = std::filesystem::temp_directory_path() /
+           (std::string("fx_") + test->test_suite_name() + "_" +
+            std::to_string(getpid()));
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    std::ofstream(root / "workspace.fx.yaml")
+        << "descriptor_version: v1beta\n"
+        << _workspace;
+
+    _previous = std::filesystem::current_path();
+    std::filesystem::current_path(root);
+    setenv("FX_CACHE_DIR", (root / "cache").c_str(), 1);
+  }
+
+  void Workspace::TearDown() {
+    unsetenv("FX_CACHE_DIR");
+    std::filesystem::current_path(_previous);
+    std::filesystem::remove_all(root);
+  }
+
+  void Workspace::command(const std::string& name,
+                          const std::string& run,
+                          const std::string& options) const {
+    std::filesystem::create_directories(root / name);
+    std::ofstream descriptor(root / name / "command.fx.yaml");
+    descriptor << "descriptor_version: v1beta\n"
+               << "synopsis: test\n";
+    if (!options.empty()) {
+      descriptor << "options:\n" << options;
+    }
+    descriptor << "runtime:\n"
+               << "  run: \"" << run << "\"\n";
+  }
+}  // namespace fx::test::helper
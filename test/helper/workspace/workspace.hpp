@@ -0,0 +1,32 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+
+namespace fx::test::helper {
+  // Runs every test from the root of a new workspace in a temporary
+  // directory, with $FX_CACHE_DIR inside it.
+  class Workspace : public testing::Test {
+   protected:
+    // `workspace` is appended to the descriptor_version of
+    // workspace.fx.yaml.
+    explicit Workspace(std::string workspace = std::string());
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    // Writes <name>/command.fx.yaml, running `run` with the YAML list of
+    // `options`.
+    void command(const std::string& name,
+                 const std::string& run,
+                 const std::string& options = std::string()) const;
+
+    std::filesystem::path root;
+
+   private:
+    std::string _workspace;
+    std::filesystem::path _previous;
+  };
+}  // namespace fx::test::helper
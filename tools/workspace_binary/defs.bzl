@@ -0,0 +1,80 @@
+"""Build an fx binary with a workspace's command descriptors compiled in."""
+
+def _fx_workspace_tables_impl(ctx):
+    output = ctx.actions.declare_file(ctx.label.name + ".cpp")
+
+    arguments = ctx.actions.args()
+    arguments.add(output)
+    arguments.add(ctx.file.workspace)
+    arguments.add_all(ctx.files.commands)
+
+    # The generator validates every descriptor, so an invalid one fails the
+    # build.
+    ctx.actions.run(
+        executable = ctx.executable._generator,
+        arguments = [arguments],
+        inputs = [ctx.file.workspace] + ctx.files.commands,
+        outputs = [output],
+        mnemonic = "FxWorkspaceTables",
+        progress_message = "Compiling fx descriptors for {0}".format(ctx.label),
+    )
+
+    return DefaultInfo(files = depset([output]))
+
+_fx_workspace_tables = rule(
+    implementation = _fx_workspace_tables_impl,
+    attrs = {
+        "workspace": attr.label(
+            allow_single_file = [".yaml"],
+            mandatory = True,
+        ),
+        "commands": attr.label_list(
+            allow_files = [".yaml"],
+            default = [],
+        ),
+        "_generator": attr.label(
+            default = Label("//src/fx/embedded/generator"),
+            cfg = "host",
+            executable = True,
+        ),
+    },
+)
+
+def fx_workspace_binary(name, workspace, commands, **kwargs):
+    """An fx binary serving `commands` without parsing them at runtime.
+
+    Usage:
+      fx_workspace_binary(
+          name = "fx",
+          workspace = "workspace.fx.yaml",
+          commands = glob(["**/command.fx.yaml"]),
+      )
+
+    Args:
+      name: Name of the cc_binary.
+      workspace: The workspace.fx.yaml. Command names are the directories of
+        the command descriptors relative to it.
+      commands: The command.fx.yaml files of the workspace.
+      **kwargs: Passed on to the cc_binary.
+    """
+    _fx_workspace_tables(
+        name = name + "_tables",
+        workspace = workspace,
+        commands = commands,
+    )
+
+    native.cc_library(
+        name = name + "_tables_library",
+        srcs = [":" + name + "_tables"],
+        deps = [Label("//src/fx/embedded")],
+        alwayslink = True,
+    )
+
+    native.cc_binary(
+        name = name,
+        deps = [
+            Label("//src:entry"),
+            ":" + name + "_tables_library",
+        ],
+        **kwargs
+    )